@@ -0,0 +1,105 @@
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "GlyphBox.h"
+#include "AtlasGenerator.h"
+#include "DirtyRegions.h"
+
+namespace msdf_atlas {
+
+/**
+ * An implementation of AtlasGenerator that uses the specified generator function and AtlasStorage class
+ * and generates glyph bitmaps asynchronously in a pool of background threads (setThreadCount).
+ * generate only queues the glyphs and returns immediately. The finished bitmaps are written into the atlas storage
+ * by update, which should be called periodically (e.g. once per frame) from the thread that uses the storage.
+ * Glyphs are written at their position at that time, so rearrange, resize, and move may be called while work is in progress.
+ * If PLACEHOLDER_FN is specified (e.g. placeholderGenerator), generate immediately writes a cheap approximation of each glyph
+ * produced by it, which is later replaced by the output of GEN_FN (progressive refinement).
+ * Only the glyphs still in progress are tracked, so memory use does not grow with the number of glyphs generated over time.
+ */
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN = nullptr>
+class AsyncAtlasGenerator {
+
+public:
+    AsyncAtlasGenerator();
+    AsyncAtlasGenerator(int width, int height);
+    /// Creates with an existing (empty) atlas storage
+    explicit AsyncAtlasGenerator(AtlasStorage &&storage);
+    /// Moves a generator that has not generated any glyphs yet
+    AsyncAtlasGenerator(AsyncAtlasGenerator &&orig);
+    ~AsyncAtlasGenerator();
+    /// Queues copies of the glyphs for generation, and writes their placeholders if PLACEHOLDER_FN is specified
+    void generate(const GlyphGeometry *glyphs, int count);
+    void rearrange(int width, int height, const Remap *remapping, int count);
+    void resize(int width, int height);
+    void move(const Remap *remapping, int count);
+    void restore(int width, int height, AtlasStorage &&storage, const Remap *remapping, int count);
+    /// Cancels the glyph's pending work, so that the space it occupied may be reused
+    void discard(int index);
+    /// Writes the glyphs finished since the last call into the atlas storage, returns their number
+    int update();
+    /// Waits until all queued glyphs are finished and written into the atlas storage
+    void finish();
+    /// Returns the indices (in order of generation) of the glyphs written by the last call to update or finish
+    const std::vector<int> & getFinishedGlyphs() const;
+    /// Returns the number of glyphs that have been queued but not written into the atlas storage yet
+    int getPendingCount() const;
+    /// Sets attributes for the generator function
+    void setAttributes(const GeneratorAttributes &attributes);
+    /// Sets the number of background threads
+    void setThreadCount(int threadCount);
+    /// Allows access to the underlying AtlasStorage
+    const AtlasStorage & atlasStorage() const;
+    /// Returns the regions of the atlas modified since the last call to clearDirtyRegions, see ImmediateAtlasGenerator
+    const std::vector<Rectangle> & getDirtyRegions() const;
+    void clearDirtyRegions();
+
+private:
+    struct Job {
+        int index;
+        GlyphGeometry glyph;
+    };
+
+    struct Result {
+        int index;
+        int width, height;
+        std::vector<T> pixels;
+    };
+
+    AtlasStorage storage;
+    /// Index of the next generated glyph
+    int glyphCount;
+    GeneratorAttributes attributes;
+    int threadCount;
+    DirtyRegions dirtyRegions;
+    std::vector<int> finishedGlyphs;
+    // The following members are shared with the worker threads and guarded by mutex
+    mutable std::mutex mutex;
+    std::condition_variable workAvailable, resultAvailable;
+    /// Boxes of the glyphs queued but not written into the atlas storage yet, which only change on the thread that uses the storage
+    std::map<int, GlyphBox> pendingBoxes;
+    std::deque<Job> jobs;
+    std::vector<Result> results;
+    int inFlightCount;
+    bool stopping;
+    std::vector<std::thread> workers;
+
+    void startWorkers();
+    void stopWorkers();
+    void workerLoop();
+    int writeResults(std::vector<Result> &finished);
+
+    AsyncAtlasGenerator(const AsyncAtlasGenerator &);
+    AsyncAtlasGenerator & operator=(const AsyncAtlasGenerator &);
+
+};
+
+}
+
+#include "AsyncAtlasGenerator.hpp"
@@ -0,0 +1,266 @@
+
+#include "AsyncAtlasGenerator.h"
+
+#include <algorithm>
+
+namespace msdf_atlas {
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::AsyncAtlasGenerator() : glyphCount(0), threadCount(1), inFlightCount(0), stopping(false) { }
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::AsyncAtlasGenerator(int width, int height) : storage(width, height), glyphCount(0), threadCount(1), inFlightCount(0), stopping(false) { }
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::AsyncAtlasGenerator(AtlasStorage &&storage) : storage((AtlasStorage &&) storage), glyphCount(0), threadCount(1), inFlightCount(0), stopping(false) { }
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::AsyncAtlasGenerator(AsyncAtlasGenerator &&orig) : storage((AtlasStorage &&) orig.storage), glyphCount(0), attributes(orig.attributes), threadCount(orig.threadCount), inFlightCount(0), stopping(false) { }
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::~AsyncAtlasGenerator() {
+    stopWorkers();
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::generate(const GlyphGeometry *glyphs, int count) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int i = 0; i < count; ++i) {
+            int index = glyphCount++;
+            if (!glyphs[i].isWhitespace()) {
+                pendingBoxes.insert(std::make_pair(index, GlyphBox(glyphs[i])));
+                Job job = { index, glyphs[i] };
+                jobs.push_back((Job &&) job);
+                ++inFlightCount;
+            }
+        }
+    }
+    if (workers.empty())
+        startWorkers();
+    workAvailable.notify_all();
+    GeneratorFunction<T, N> placeholderFn = PLACEHOLDER_FN;
+    if (placeholderFn) {
+        // Placeholders are generated on this thread while the workers generate the final bitmaps, which will overwrite them
+        std::vector<T> buffer;
+        for (int i = 0; i < count; ++i) {
+            if (glyphs[i].isWhitespace())
+                continue;
+            int l, b, w, h;
+            glyphs[i].getBoxRect(l, b, w, h);
+            buffer.resize(N*w*h);
+            msdfgen::BitmapRef<T, N> placeholder(buffer.data(), w, h);
+            placeholderFn(placeholder, glyphs[i], attributes);
+            storage.put(l, b, msdfgen::BitmapConstRef<T, N>(placeholder));
+            dirtyRegions.add(Rectangle { l, b, w, h });
+        }
+    }
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::rearrange(int width, int height, const Remap *remapping, int count) {
+    {
+        // Glyphs left out of the remapping are dropped from the atlas, so their pending work is cancelled
+        std::map<int, GlyphBox> remappedBoxes;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int i = 0; i < count; ++i) {
+            typename std::map<int, GlyphBox>::iterator it = pendingBoxes.find(remapping[i].index);
+            if (it != pendingBoxes.end()) {
+                it->second.rect.x = remapping[i].target.x;
+                it->second.rect.y = remapping[i].target.y;
+                remappedBoxes.insert(*it);
+            }
+        }
+        pendingBoxes.swap(remappedBoxes);
+    }
+    AtlasStorage newStorage((AtlasStorage &&) storage, width, height, remapping, count);
+    storage = (AtlasStorage &&) newStorage;
+    dirtyRegions.addAll(width, height);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::resize(int width, int height) {
+    AtlasStorage newStorage((AtlasStorage &&) storage, width, height);
+    storage = (AtlasStorage &&) newStorage;
+    dirtyRegions.addAll(width, height);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::move(const Remap *remapping, int count) {
+    GeneratorFunction<T, N> placeholderFn = PLACEHOLDER_FN;
+    std::vector<Remap> finishedMoves;
+    for (int i = 0; i < count; ++i) {
+        const Remap &remap = remapping[i];
+        // A glyph still in progress will be written at its new position, but its placeholder must be moved
+        typename std::map<int, GlyphBox>::iterator it = pendingBoxes.find(remap.index);
+        if (it != pendingBoxes.end()) {
+            it->second.rect.x = remap.target.x;
+            it->second.rect.y = remap.target.y;
+            if (!placeholderFn)
+                continue;
+        }
+        finishedMoves.push_back(remap);
+        dirtyRegions.add(Rectangle { remap.target.x, remap.target.y, remap.width, remap.height });
+    }
+    storage.move(finishedMoves.data(), finishedMoves.size());
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::restore(int width, int height, AtlasStorage &&storage, const Remap *remapping, int count) {
+    // There is no work in progress, since no glyphs have been generated before, so the restored glyphs only take up their indices
+    this->storage = (AtlasStorage &&) storage;
+    glyphCount = 0;
+    for (int i = 0; i < count; ++i)
+        glyphCount = std::max(glyphCount, remapping[i].index+1);
+    dirtyRegions.addAll(width, height);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::discard(int index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingBoxes.erase(index);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+int AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::update() {
+    std::vector<Result> finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.swap(results);
+    }
+    return writeResults(finished);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::finish() {
+    std::vector<Result> finished;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        resultAvailable.wait(lock, [this]() {
+            return !inFlightCount;
+        });
+        finished.swap(results);
+    }
+    writeResults(finished);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+const std::vector<int> & AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::getFinishedGlyphs() const {
+    return finishedGlyphs;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+int AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pendingBoxes.size();
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::setAttributes(const GeneratorAttributes &attributes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->attributes = attributes;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::setThreadCount(int threadCount) {
+    stopWorkers();
+    this->threadCount = std::max(threadCount, 1);
+    if (inFlightCount)
+        startWorkers();
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+const AtlasStorage & AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::atlasStorage() const {
+    return storage;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+const std::vector<Rectangle> & AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::getDirtyRegions() const {
+    return dirtyRegions.getRegions();
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::clearDirtyRegions() {
+    dirtyRegions.clear();
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::startWorkers() {
+    stopping = false;
+    for (int i = 0; i < threadCount; ++i)
+        workers.emplace_back(&AsyncAtlasGenerator::workerLoop, this);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    // Workers complete their current glyph, the remaining jobs stay queued
+    for (std::thread &worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+void AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::workerLoop() {
+    std::vector<byte> errorCorrectionBuffer;
+    GeneratorAttributes threadAttributes;
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [this]() {
+                return stopping || !jobs.empty();
+            });
+            if (stopping)
+                return;
+            job = (Job &&) jobs.front();
+            jobs.pop_front();
+            if (!pendingBoxes.count(job.index)) {
+                if (!--inFlightCount)
+                    resultAvailable.notify_all();
+                continue;
+            }
+            threadAttributes = attributes;
+        }
+        Result result;
+        int l, b;
+        job.glyph.getBoxRect(l, b, result.width, result.height);
+        result.index = job.index;
+        result.pixels.resize(N*result.width*result.height);
+        if (result.width*result.height > (int) errorCorrectionBuffer.size())
+            errorCorrectionBuffer.resize(result.width*result.height);
+        threadAttributes.config.errorCorrection.buffer = errorCorrectionBuffer.data();
+        GEN_FN(msdfgen::BitmapRef<T, N>(result.pixels.data(), result.width, result.height), job.glyph, threadAttributes);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back((Result &&) result);
+            --inFlightCount;
+        }
+        resultAvailable.notify_all();
+    }
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage, GeneratorFunction<T, N> PLACEHOLDER_FN>
+int AsyncAtlasGenerator<T, N, GEN_FN, AtlasStorage, PLACEHOLDER_FN>::writeResults(std::vector<Result> &finished) {
+    finishedGlyphs.clear();
+    for (const Result &result : finished) {
+        // Pending boxes only change on this thread, so they can be read without locking
+        typename std::map<int, GlyphBox>::const_iterator it = pendingBoxes.find(result.index);
+        if (it == pendingBoxes.end())
+            continue;
+        const GlyphBox &box = it->second;
+        storage.put(box.rect.x, box.rect.y, msdfgen::BitmapConstRef<T, N>(result.pixels.data(), result.width, result.height));
+        dirtyRegions.add(Rectangle { box.rect.x, box.rect.y, result.width, result.height });
+        finishedGlyphs.push_back(result.index);
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int index : finishedGlyphs)
+        pendingBoxes.erase(index);
+    return finishedGlyphs.size();
+}
+
+}
@@ -0,0 +1,134 @@
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "BinaryLayout.h"
+
+/*
+ * Atlas bundle format and its reader - a single file containing the atlas texture pages and the binary layout data (see BinaryLayout.h).
+ * This header depends only on BinaryLayout.h and may be copied into other projects.
+ *
+ * Like the binary layout, the file consists of little-endian records of 32-bit fields with offsets from the start of the file.
+ * The pixel data of each page starts at a multiple of ATLAS_BUNDLE_PAGE_ALIGNMENT, so it can be uploaded straight from a memory-mapped file.
+ *
+ * Layout:
+ *   AtlasBundleHeader
+ *   AtlasBundlePage[pageCount] at pagesOffset
+ *   binary layout data at layoutOffset (16-byte aligned)
+ *   pixel data of each page at its dataOffset - rows ordered according to the layout's Y direction flag,
+ *     uncompressed pixels are tightly packed, compressed pages consist of rows of 4x4 blocks
+ */
+
+#define ATLAS_BUNDLE_MAGIC 0x4244534du // "MSDB"
+#define ATLAS_BUNDLE_VERSION 1u
+#define ATLAS_BUNDLE_PAGE_ALIGNMENT 4096u
+#define ATLAS_BUNDLE_LAYOUT_ALIGNMENT 16u
+
+/// Values of AtlasBundlePage::format
+#define ATLAS_BUNDLE_FORMAT_R8 1u
+#define ATLAS_BUNDLE_FORMAT_RGB8 2u
+#define ATLAS_BUNDLE_FORMAT_RGBA8 3u
+#define ATLAS_BUNDLE_FORMAT_R32F 4u
+#define ATLAS_BUNDLE_FORMAT_RGB32F 5u
+#define ATLAS_BUNDLE_FORMAT_RGBA32F 6u
+#define ATLAS_BUNDLE_FORMAT_BC4 7u
+#define ATLAS_BUNDLE_FORMAT_BC5 8u
+#define ATLAS_BUNDLE_FORMAT_BC7 9u
+
+namespace msdf_atlas {
+
+struct AtlasBundleHeader {
+    uint32_t magic;
+    uint32_t version;
+    /// Total size of the bundle in bytes
+    uint32_t size;
+    uint32_t pageCount, pagesOffset;
+    uint32_t layoutSize, layoutOffset;
+};
+
+struct AtlasBundlePage {
+    uint32_t format;
+    uint32_t width, height;
+    /// Size of a row of pixels, or of a row of 4x4 blocks for compressed formats, in bytes
+    uint32_t rowSize;
+    /// Number of rows of pixels or blocks
+    uint32_t rowCount;
+    uint32_t dataSize, dataOffset;
+};
+
+/**
+ * Provides access to the texture pages and layout of an atlas bundle in memory without copying or parsing.
+ * The memory must be 4-byte aligned and remain valid while in use. Only little-endian platforms are supported.
+ */
+class AtlasBundle {
+
+public:
+    AtlasBundle() : data(nullptr), dataSize(0) { }
+
+    /// Validates the bundle and starts using it, returns false if the data is invalid
+    bool open(const void *bundleData, size_t bundleSize) {
+        data = nullptr, dataSize = 0;
+        if (!bundleData || (reinterpret_cast<uintptr_t>(bundleData)&3) || bundleSize < sizeof(AtlasBundleHeader))
+            return false;
+        const AtlasBundleHeader *header = reinterpret_cast<const AtlasBundleHeader *>(bundleData);
+        if (header->magic != ATLAS_BUNDLE_MAGIC || header->version != ATLAS_BUNDLE_VERSION || header->size > bundleSize)
+            return false;
+        data = reinterpret_cast<const unsigned char *>(bundleData);
+        dataSize = header->size;
+        bool valid = (
+            contains(header->pagesOffset, header->pageCount, sizeof(AtlasBundlePage)) &&
+            !(header->layoutOffset%ATLAS_BUNDLE_LAYOUT_ALIGNMENT) && contains(header->layoutOffset, header->layoutSize, 1) &&
+            layout.open(data+header->layoutOffset, header->layoutSize)
+        );
+        for (uint32_t i = 0; valid && i < header->pageCount; ++i) {
+            const AtlasBundlePage &page = getPage(int(i));
+            valid = (
+                !(page.dataOffset%ATLAS_BUNDLE_PAGE_ALIGNMENT) && contains(page.dataOffset, page.dataSize, 1) &&
+                uint64_t(page.rowSize)*page.rowCount <= page.dataSize
+            );
+        }
+        if (!valid)
+            data = nullptr, dataSize = 0;
+        return valid;
+    }
+
+    bool isOpen() const {
+        return data != nullptr;
+    }
+
+    const AtlasBundleHeader & getHeader() const {
+        return *reinterpret_cast<const AtlasBundleHeader *>(data);
+    }
+
+    int getPageCount() const {
+        return int(getHeader().pageCount);
+    }
+
+    const AtlasBundlePage & getPage(int pageIndex) const {
+        return reinterpret_cast<const AtlasBundlePage *>(data+getHeader().pagesOffset)[pageIndex];
+    }
+
+    /// Returns the page's pixel or block data, ready to be uploaded to a texture
+    const void * getPageData(int pageIndex) const {
+        return data+getPage(pageIndex).dataOffset;
+    }
+
+    /// Returns the layout data of the atlas
+    const BinaryLayout & getLayout() const {
+        return layout;
+    }
+
+private:
+    const unsigned char *data;
+    size_t dataSize;
+    BinaryLayout layout;
+
+    /// Checks that count elements of elementSize at offset are within the data and the offset is 4-byte aligned
+    bool contains(uint32_t offset, uint32_t count, size_t elementSize) const {
+        return !(offset&3) && offset <= dataSize && uint64_t(count)*elementSize <= dataSize-offset;
+    }
+
+};
+
+}
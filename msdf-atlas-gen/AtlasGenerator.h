@@ -4,6 +4,7 @@
 #include <msdfgen.h>
 #include "Remap.h"
 #include "GlyphGeometry.h"
+#include "AtlasStorage.h"
 
 namespace msdf_atlas {
 
@@ -24,6 +25,17 @@ public:
     void rearrange(int width, int height, const Remap *remapping, int count);
     /// Resizes the atlas and keeps the generated pixels in place
     void resize(int width, int height);
+    /// Notifies the generator that a glyph has been removed from the layout and its space may be reused.
+    /// Glyphs are identified by consecutive indices in the order they were passed to generate, which are never reused,
+    /// so the generator should free any state it keeps for the glyph
+    void discard(int index);
+    /// Moves the generated pixels of some glyphs within the atlas according to the remapping array, keeping the rest in place.
+    /// The target areas must be unoccupied. Optional, only needed for DynamicAtlas::compact
+    void move(const Remap *remapping, int count);
+    /// Takes over an atlas storage that already holds the pixels of glyphs (e.g. loaded from a file) at the target positions of the remapping array,
+    /// which are registered under their indices as if they had been generated. Must be called before any glyphs are generated.
+    /// Optional, only needed for DynamicAtlas::load
+    void restore(int width, int height, AtlasStorage &&storage, const Remap *remapping, int count);
 
 };
 
@@ -1,8 +1,10 @@
 
 #pragma once
 
+#include <cstdio>
 #include <msdfgen.h>
 #include "Remap.h"
+#include "BitmapSection.h"
 
 namespace msdf_atlas {
 
@@ -11,6 +13,7 @@ namespace {
 /** Prototype of an atlas storage class.
  *  An atlas storage physically holds the pixels of the atlas
  *  and allows to read and write subsections represented as bitmaps.
+ *  The subsections may also be given as BitmapSection, i.e. parts of larger bitmaps or with rows in reverse order.
  *  Can be implemented using a simple bitmap (BitmapAtlasStorage),
  *  as texture memory, or any other way.
  */
@@ -26,9 +29,25 @@ public:
     /// Stores a subsection at x, y into the atlas storage. May be implemented for only some T, N
     template <typename T, int N>
     void put(int x, int y, const msdfgen::BitmapConstRef<T, N> &subBitmap);
+    template <typename T, int N>
+    void put(int x, int y, const BitmapConstSection<T, N> &subBitmap);
+    /// Stores a single-channel subsection at x, y into the specified channel. Optional, only needed for channel-packed atlases
+    template <typename T>
+    void put(int x, int y, int channel, const msdfgen::BitmapConstRef<T, 1> &subBitmap);
+    template <typename T>
+    void put(int x, int y, int channel, const BitmapConstSection<T, 1> &subBitmap);
     /// Retrieves a subsection at x, y from the atlas storage. May be implemented for only some T, N
     template <typename T, int N>
-    void get(int x, int y, const msdfgen::BitmapRef<T, N> &subBitmap) const;
+    void get(int x, int y, const BitmapSection<T, N> &subBitmap) const;
+    /// Moves subsections within the atlas storage in order according to the remapping array. Each target area must not overlap its source.
+    /// Optional, only needed for DynamicAtlas::compact
+    void move(const Remap *remapping, int count);
+    /// Writes the dimensions and pixels into an open binary file / reads them back. Optional, only needed for DynamicAtlas::save and load
+    bool save(FILE *file) const;
+    bool load(FILE *file);
+    /// Optional, only needed for DynamicAtlas::load
+    int getWidth() const;
+    int getHeight() const;
 
 };
 
@@ -0,0 +1,220 @@
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Binary atlas layout format and its reader. This header has no dependencies and may be copied into other projects.
+ *
+ * The file consists of little-endian records made entirely of 32-bit fields, all offsets are in bytes from the start of the file.
+ * Since every record is 4-byte aligned, the file can be used directly after it is memory-mapped or read into memory.
+ *
+ * Layout:
+ *   BinaryLayoutHeader
+ *   BinaryLayoutFont[fontCount] at fontsOffset
+ *   for each font (at the offsets specified by its BinaryLayoutFont):
+ *     name - null-terminated UTF-8 string
+ *     BinaryLayoutGlyph[glyphCount]
+ *     page directory - uint32_t[pageDirectorySize], page number for each block of 256 glyph identifiers or BINARY_LAYOUT_NONE
+ *     pages - uint32_t[256*pageCount], glyph record index for each identifier or BINARY_LAYOUT_NONE
+ *     kerning hash table - BinaryLayoutKerningPair[kerningCapacity], open addressing with linear probing
+ *     quad vertices (optional) - BinaryLayoutQuadVertex[4*glyphCount]
+ */
+
+#define BINARY_LAYOUT_MAGIC 0x4c44534du // "MSDL"
+#define BINARY_LAYOUT_VERSION 1u
+#define BINARY_LAYOUT_NONE 0xffffffffu
+#define BINARY_LAYOUT_PAGE_SIZE 256u
+
+/// Header flags
+#define BINARY_LAYOUT_FLAG_Y_TOP_DOWN 0x01u
+#define BINARY_LAYOUT_FLAG_KERNING 0x02u
+#define BINARY_LAYOUT_FLAG_QUAD_VERTICES 0x04u
+
+/// Values of BinaryLayoutHeader::imageType
+#define BINARY_LAYOUT_IMAGE_HARD_MASK 0u
+#define BINARY_LAYOUT_IMAGE_SOFT_MASK 1u
+#define BINARY_LAYOUT_IMAGE_SDF 2u
+#define BINARY_LAYOUT_IMAGE_PSDF 3u
+#define BINARY_LAYOUT_IMAGE_MSDF 4u
+#define BINARY_LAYOUT_IMAGE_MTSDF 5u
+
+/// Values of BinaryLayoutFont::identifierType
+#define BINARY_LAYOUT_GLYPH_INDEX 0u
+#define BINARY_LAYOUT_UNICODE_CODEPOINT 1u
+
+namespace msdf_atlas {
+
+struct BinaryLayoutHeader {
+    uint32_t magic;
+    uint32_t version;
+    /// Total size of the layout data in bytes
+    uint32_t size;
+    uint32_t flags;
+    uint32_t imageType;
+    float distanceRange;
+    float fontSize;
+    uint32_t atlasWidth, atlasHeight;
+    /// Number of channels the glyphs are distributed into, 0 if not channel-packed
+    uint32_t packedChannels;
+    uint32_t fontCount;
+    uint32_t fontsOffset;
+};
+
+struct BinaryLayoutFont {
+    uint32_t identifierType;
+    float emSize, lineHeight, ascender, descender, underlineY, underlineThickness;
+    uint32_t nameOffset, nameLength;
+    uint32_t glyphCount, glyphsOffset;
+    uint32_t pageDirectorySize, pageDirectoryOffset;
+    uint32_t pageCount, pagesOffset;
+    /// Number of slots of the kerning hash table, always a power of two (or zero)
+    uint32_t kerningCapacity, kerningCount, kerningOffset;
+    /// Zero if the quad vertices are not present
+    uint32_t quadsOffset;
+};
+
+/// Glyph metrics and bounds with the Y-axis oriented as specified by the header flags
+struct BinaryLayoutGlyph {
+    uint32_t codepoint;
+    uint32_t index;
+    float advance;
+    float planeLeft, planeBottom, planeRight, planeTop;
+    float atlasLeft, atlasBottom, atlasRight, atlasTop;
+    uint32_t channel;
+};
+
+/// Entry of the kerning hash table, glyph1 and glyph2 are glyph record indices, glyph1 is BINARY_LAYOUT_NONE in empty slots
+struct BinaryLayoutKerningPair {
+    uint32_t glyph1, glyph2;
+    float advance;
+};
+
+/// Vertex of a glyph's quad - position in EM's and normalized texture coordinates, ordered left-bottom, right-bottom, right-top, left-top
+struct BinaryLayoutQuadVertex {
+    float x, y;
+    float u, v;
+};
+
+/// Hash function of the kerning table, the first slot to probe is binaryLayoutKerningHash(glyph1, glyph2)&(kerningCapacity-1)
+inline uint32_t binaryLayoutKerningHash(uint32_t glyph1, uint32_t glyph2) {
+    uint32_t hash = glyph1*0x9e3779b1u^glyph2*0x85ebca77u;
+    return hash^hash>>15;
+}
+
+/**
+ * Provides access to binary layout data in memory without copying or parsing.
+ * The memory must be 4-byte aligned and remain valid while in use. Only little-endian platforms are supported.
+ */
+class BinaryLayout {
+
+public:
+    BinaryLayout() : data(nullptr), dataSize(0) { }
+
+    /// Validates the layout data and starts using it, returns false if the data is invalid
+    bool open(const void *layoutData, size_t layoutSize) {
+        const uint32_t endianTest = 1;
+        data = nullptr, dataSize = 0;
+        if (*reinterpret_cast<const unsigned char *>(&endianTest) != 1 || !layoutData || (reinterpret_cast<uintptr_t>(layoutData)&3) || layoutSize < sizeof(BinaryLayoutHeader))
+            return false;
+        const BinaryLayoutHeader *header = reinterpret_cast<const BinaryLayoutHeader *>(layoutData);
+        if (header->magic != BINARY_LAYOUT_MAGIC || header->version != BINARY_LAYOUT_VERSION || header->size > layoutSize)
+            return false;
+        data = reinterpret_cast<const unsigned char *>(layoutData);
+        dataSize = header->size;
+        bool valid = contains(header->fontsOffset, header->fontCount, sizeof(BinaryLayoutFont));
+        for (uint32_t i = 0; valid && i < header->fontCount; ++i) {
+            const BinaryLayoutFont *font = getFont(int(i));
+            valid = (
+                font->nameLength < dataSize && contains(font->nameOffset, font->nameLength+1, 1) && data[font->nameOffset+font->nameLength] == '\0' &&
+                contains(font->glyphsOffset, font->glyphCount, sizeof(BinaryLayoutGlyph)) &&
+                contains(font->pageDirectoryOffset, font->pageDirectorySize, sizeof(uint32_t)) &&
+                contains(font->pagesOffset, font->pageCount, BINARY_LAYOUT_PAGE_SIZE*sizeof(uint32_t)) &&
+                contains(font->kerningOffset, font->kerningCapacity, sizeof(BinaryLayoutKerningPair)) &&
+                !(font->kerningCapacity&(font->kerningCapacity-1)) && font->kerningCount < font->kerningCapacity+(font->kerningCapacity == 0) &&
+                (!font->quadsOffset || contains(font->quadsOffset, 4*font->glyphCount, sizeof(BinaryLayoutQuadVertex)))
+            );
+        }
+        if (!valid)
+            data = nullptr, dataSize = 0;
+        return valid;
+    }
+
+    bool isOpen() const {
+        return data != nullptr;
+    }
+
+    const BinaryLayoutHeader & getHeader() const {
+        return *reinterpret_cast<const BinaryLayoutHeader *>(data);
+    }
+
+    int getFontCount() const {
+        return int(getHeader().fontCount);
+    }
+
+    const BinaryLayoutFont * getFont(int fontIndex) const {
+        return reinterpret_cast<const BinaryLayoutFont *>(data+getHeader().fontsOffset)+fontIndex;
+    }
+
+    const char * getFontName(int fontIndex) const {
+        return reinterpret_cast<const char *>(data+getFont(fontIndex)->nameOffset);
+    }
+
+    int getGlyphCount(int fontIndex) const {
+        return int(getFont(fontIndex)->glyphCount);
+    }
+
+    /// Returns the glyph at the specified record index
+    const BinaryLayoutGlyph & getGlyph(int fontIndex, int glyph) const {
+        return reinterpret_cast<const BinaryLayoutGlyph *>(data+getFont(fontIndex)->glyphsOffset)[glyph];
+    }
+
+    /// Returns the record index of the glyph with the specified identifier (Unicode codepoint or glyph index - see BinaryLayoutFont::identifierType), or -1 if not present
+    int findGlyph(int fontIndex, uint32_t identifier) const {
+        const BinaryLayoutFont *font = getFont(fontIndex);
+        uint32_t page = identifier/BINARY_LAYOUT_PAGE_SIZE;
+        if (page >= font->pageDirectorySize)
+            return -1;
+        page = reinterpret_cast<const uint32_t *>(data+font->pageDirectoryOffset)[page];
+        if (page >= font->pageCount)
+            return -1;
+        uint32_t glyph = reinterpret_cast<const uint32_t *>(data+font->pagesOffset)[BINARY_LAYOUT_PAGE_SIZE*page+identifier%BINARY_LAYOUT_PAGE_SIZE];
+        return glyph < font->glyphCount ? int(glyph) : -1;
+    }
+
+    /// Returns the kerning advance adjustment between two glyphs (record indices)
+    float getKerning(int fontIndex, int glyph1, int glyph2) const {
+        const BinaryLayoutFont *font = getFont(fontIndex);
+        if (!font->kerningCount)
+            return 0;
+        const BinaryLayoutKerningPair *table = reinterpret_cast<const BinaryLayoutKerningPair *>(data+font->kerningOffset);
+        uint32_t mask = font->kerningCapacity-1;
+        uint32_t slot = binaryLayoutKerningHash(uint32_t(glyph1), uint32_t(glyph2))&mask;
+        for (uint32_t i = 0; i <= mask && table[slot].glyph1 != BINARY_LAYOUT_NONE; ++i, slot = (slot+1)&mask) {
+            if (table[slot].glyph1 == uint32_t(glyph1) && table[slot].glyph2 == uint32_t(glyph2))
+                return table[slot].advance;
+        }
+        return 0;
+    }
+
+    /// Returns the 4 quad vertices of the glyph (record index), or null if the layout has no quad vertices
+    const BinaryLayoutQuadVertex * getQuad(int fontIndex, int glyph) const {
+        const BinaryLayoutFont *font = getFont(fontIndex);
+        if (!font->quadsOffset)
+            return nullptr;
+        return reinterpret_cast<const BinaryLayoutQuadVertex *>(data+font->quadsOffset)+4*glyph;
+    }
+
+private:
+    const unsigned char *data;
+    size_t dataSize;
+
+    /// Checks that count elements of elementSize at offset are within the data and 4-byte aligned
+    bool contains(uint32_t offset, uint32_t count, size_t elementSize) const {
+        return !(offset&3) && offset <= dataSize && uint64_t(count)*elementSize <= dataSize-offset;
+    }
+
+};
+
+}
@@ -1,7 +1,9 @@
 
 #pragma once
 
+#include <cstdio>
 #include "AtlasStorage.h"
+#include "BitmapSection.h"
 
 namespace msdf_atlas {
 
@@ -18,10 +20,26 @@ public:
     BitmapAtlasStorage(const BitmapAtlasStorage<T, N> &orig, int width, int height, const Remap *remapping, int count);
     operator msdfgen::BitmapConstRef<T, N>() const;
     operator msdfgen::BitmapRef<T, N>();
+    operator BitmapConstSection<T, N>() const;
+    operator BitmapSection<T, N>();
     operator msdfgen::Bitmap<T, N>() &&;
     template <typename S>
     void put(int x, int y, const msdfgen::BitmapConstRef<S, N> &subBitmap);
-    void get(int x, int y, const msdfgen::BitmapRef<T, N> &subBitmap) const;
+    template <typename S>
+    void put(int x, int y, const BitmapConstSection<S, N> &subBitmap);
+    /// Stores a single-channel subsection into the specified channel (N = 3 or 4 only)
+    template <typename S>
+    void put(int x, int y, int channel, const msdfgen::BitmapConstRef<S, 1> &subBitmap);
+    template <typename S>
+    void put(int x, int y, int channel, const BitmapConstSection<S, 1> &subBitmap);
+    void get(int x, int y, const BitmapSection<T, N> &subBitmap) const;
+    void move(const Remap *remapping, int count);
+    /// Writes the dimensions followed by the raw pixels (bottom row first, native byte order) into an open binary file, padded to a multiple of 4 bytes
+    bool save(FILE *file) const;
+    /// Reads pixels written by save from an open binary file, returns false if they are invalid or of a different type
+    bool load(FILE *file);
+    int getWidth() const;
+    int getHeight() const;
 
 private:
     msdfgen::Bitmap<T, N> bitmap;
@@ -2,6 +2,7 @@
 #include "BitmapAtlasStorage.h"
 
 #include <cstring>
+#include <cstdint>
 #include <algorithm>
 #include "bitmap-blit.h"
 
@@ -46,6 +47,16 @@ BitmapAtlasStorage<T, N>::operator msdfgen::BitmapRef<T, N>() {
     return bitmap;
 }
 
+template <typename T, int N>
+BitmapAtlasStorage<T, N>::operator BitmapConstSection<T, N>() const {
+    return BitmapConstSection<T, N>(bitmap);
+}
+
+template <typename T, int N>
+BitmapAtlasStorage<T, N>::operator BitmapSection<T, N>() {
+    return BitmapSection<T, N>(bitmap);
+}
+
 template <typename T, int N>
 BitmapAtlasStorage<T, N>::operator msdfgen::Bitmap<T, N>() && {
     return (msdfgen::Bitmap<T, N> &&) bitmap;
@@ -54,12 +65,76 @@ BitmapAtlasStorage<T, N>::operator msdfgen::Bitmap<T, N>() && {
 template <typename T, int N>
 template <typename S>
 void BitmapAtlasStorage<T, N>::put(int x, int y, const msdfgen::BitmapConstRef<S, N> &subBitmap) {
+    put(x, y, BitmapConstSection<S, N>(subBitmap));
+}
+
+template <typename T, int N>
+template <typename S>
+void BitmapAtlasStorage<T, N>::put(int x, int y, const BitmapConstSection<S, N> &subBitmap) {
     blit(bitmap, subBitmap, x, y, 0, 0, subBitmap.width, subBitmap.height);
 }
 
 template <typename T, int N>
-void BitmapAtlasStorage<T, N>::get(int x, int y, const msdfgen::BitmapRef<T, N> &subBitmap) const {
+template <typename S>
+void BitmapAtlasStorage<T, N>::put(int x, int y, int channel, const msdfgen::BitmapConstRef<S, 1> &subBitmap) {
+    put(x, y, channel, BitmapConstSection<S, 1>(subBitmap));
+}
+
+template <typename T, int N>
+template <typename S>
+void BitmapAtlasStorage<T, N>::put(int x, int y, int channel, const BitmapConstSection<S, 1> &subBitmap) {
+    blit(bitmap, channel, subBitmap, x, y, 0, 0, subBitmap.width, subBitmap.height);
+}
+
+template <typename T, int N>
+void BitmapAtlasStorage<T, N>::get(int x, int y, const BitmapSection<T, N> &subBitmap) const {
     blit(subBitmap, bitmap, 0, 0, x, y, subBitmap.width, subBitmap.height);
 }
 
+template <typename T, int N>
+void BitmapAtlasStorage<T, N>::move(const Remap *remapping, int count) {
+    for (int i = 0; i < count; ++i) {
+        const Remap &remap = remapping[i];
+        blit(bitmap, bitmap, remap.target.x, remap.target.y, remap.source.x, remap.source.y, remap.width, remap.height);
+    }
+}
+
+template <typename T, int N>
+int BitmapAtlasStorage<T, N>::getWidth() const {
+    return bitmap.width();
+}
+
+template <typename T, int N>
+int BitmapAtlasStorage<T, N>::getHeight() const {
+    return bitmap.height();
+}
+
+template <typename T, int N>
+bool BitmapAtlasStorage<T, N>::save(FILE *file) const {
+    uint32_t header[4] = { uint32_t(bitmap.width()), uint32_t(bitmap.height()), uint32_t(N), uint32_t(sizeof(T)) };
+    size_t pixelCount = size_t(N)*bitmap.width()*bitmap.height();
+    size_t paddingSize = (4-sizeof(T)*pixelCount%4)%4;
+    const uint32_t padding = 0;
+    return (
+        fwrite(header, sizeof(header), 1, file) == 1 &&
+        (!pixelCount || fwrite((const T *) bitmap, sizeof(T), pixelCount, file) == pixelCount) &&
+        fwrite(&padding, 1, paddingSize, file) == paddingSize
+    );
+}
+
+template <typename T, int N>
+bool BitmapAtlasStorage<T, N>::load(FILE *file) {
+    uint32_t header[4];
+    if (!(fread(header, sizeof(header), 1, file) == 1 && header[0] <= 0xffffu && header[1] <= 0xffffu && header[2] == uint32_t(N) && header[3] == uint32_t(sizeof(T))))
+        return false;
+    msdfgen::Bitmap<T, N> newBitmap((int) header[0], (int) header[1]);
+    size_t pixelCount = size_t(N)*header[0]*header[1];
+    size_t paddingSize = (4-sizeof(T)*pixelCount%4)%4;
+    uint32_t padding;
+    if (!((!pixelCount || fread((T *) newBitmap, sizeof(T), pixelCount, file) == pixelCount) && fread(&padding, 1, paddingSize, file) == paddingSize))
+        return false;
+    bitmap = (msdfgen::Bitmap<T, N> &&) newBitmap;
+    return true;
+}
+
 }
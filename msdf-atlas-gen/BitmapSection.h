@@ -0,0 +1,61 @@
+
+#pragma once
+
+#include <msdfgen.h>
+
+namespace msdf_atlas {
+
+/**
+ * Reference to a rectangular section of a bitmap, whose consecutive rows are rowStride values of T apart.
+ * The stride may be larger than N*width (a part of a larger bitmap or padded rows) or negative (rows in reverse order).
+ */
+template <typename T, int N = 1>
+struct BitmapSection {
+
+    T *pixels;
+    int width, height;
+    int rowStride;
+
+    BitmapSection();
+    BitmapSection(T *pixels, int width, int height);
+    BitmapSection(T *pixels, int width, int height, int rowStride);
+    BitmapSection(const msdfgen::BitmapRef<T, N> &bitmap);
+    BitmapSection(msdfgen::Bitmap<T, N> &bitmap);
+    T * operator()(int x, int y) const;
+    /// Returns the section between columns l, r and rows b, t (l and b inclusive)
+    BitmapSection<T, N> getSection(int l, int b, int r, int t) const;
+    /// Returns a view of the same pixels with the order of rows reversed
+    BitmapSection<T, N> flipped() const;
+    /// Returns true if the rows are tightly packed in ascending order, i.e. the section can be used as msdfgen::BitmapRef
+    bool isContiguous() const;
+
+};
+
+/// Constant reference to a rectangular section of a bitmap, see BitmapSection
+template <typename T, int N = 1>
+struct BitmapConstSection {
+
+    const T *pixels;
+    int width, height;
+    int rowStride;
+
+    BitmapConstSection();
+    BitmapConstSection(const T *pixels, int width, int height);
+    BitmapConstSection(const T *pixels, int width, int height, int rowStride);
+    BitmapConstSection(const msdfgen::BitmapConstRef<T, N> &bitmap);
+    BitmapConstSection(const msdfgen::BitmapRef<T, N> &bitmap);
+    BitmapConstSection(const BitmapSection<T, N> &section);
+    BitmapConstSection(const msdfgen::Bitmap<T, N> &bitmap);
+    const T * operator()(int x, int y) const;
+    /// Returns the section between columns l, r and rows b, t (l and b inclusive)
+    BitmapConstSection<T, N> getSection(int l, int b, int r, int t) const;
+    /// Returns a view of the same pixels with the order of rows reversed
+    BitmapConstSection<T, N> flipped() const;
+    /// Returns true if the rows are tightly packed in ascending order, i.e. the section can be used as msdfgen::BitmapConstRef
+    bool isContiguous() const;
+
+};
+
+}
+
+#include "BitmapSection.hpp"
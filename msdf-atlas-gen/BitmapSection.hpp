@@ -0,0 +1,82 @@
+
+#include "BitmapSection.h"
+
+namespace msdf_atlas {
+
+template <typename T, int N>
+BitmapSection<T, N>::BitmapSection() : pixels(nullptr), width(0), height(0), rowStride(0) { }
+
+template <typename T, int N>
+BitmapSection<T, N>::BitmapSection(T *pixels, int width, int height) : pixels(pixels), width(width), height(height), rowStride(N*width) { }
+
+template <typename T, int N>
+BitmapSection<T, N>::BitmapSection(T *pixels, int width, int height, int rowStride) : pixels(pixels), width(width), height(height), rowStride(rowStride) { }
+
+template <typename T, int N>
+BitmapSection<T, N>::BitmapSection(const msdfgen::BitmapRef<T, N> &bitmap) : pixels(bitmap.pixels), width(bitmap.width), height(bitmap.height), rowStride(N*bitmap.width) { }
+
+template <typename T, int N>
+BitmapSection<T, N>::BitmapSection(msdfgen::Bitmap<T, N> &bitmap) : pixels((T *) bitmap), width(bitmap.width()), height(bitmap.height()), rowStride(N*bitmap.width()) { }
+
+template <typename T, int N>
+T * BitmapSection<T, N>::operator()(int x, int y) const {
+    return pixels+(ptrdiff_t) rowStride*y+N*x;
+}
+
+template <typename T, int N>
+BitmapSection<T, N> BitmapSection<T, N>::getSection(int l, int b, int r, int t) const {
+    return BitmapSection<T, N>((*this)(l, b), r-l, t-b, rowStride);
+}
+
+template <typename T, int N>
+BitmapSection<T, N> BitmapSection<T, N>::flipped() const {
+    return BitmapSection<T, N>(height ? (*this)(0, height-1) : pixels, width, height, -rowStride);
+}
+
+template <typename T, int N>
+bool BitmapSection<T, N>::isContiguous() const {
+    return rowStride == N*width || height <= 1;
+}
+
+template <typename T, int N>
+BitmapConstSection<T, N>::BitmapConstSection() : pixels(nullptr), width(0), height(0), rowStride(0) { }
+
+template <typename T, int N>
+BitmapConstSection<T, N>::BitmapConstSection(const T *pixels, int width, int height) : pixels(pixels), width(width), height(height), rowStride(N*width) { }
+
+template <typename T, int N>
+BitmapConstSection<T, N>::BitmapConstSection(const T *pixels, int width, int height, int rowStride) : pixels(pixels), width(width), height(height), rowStride(rowStride) { }
+
+template <typename T, int N>
+BitmapConstSection<T, N>::BitmapConstSection(const msdfgen::BitmapConstRef<T, N> &bitmap) : pixels(bitmap.pixels), width(bitmap.width), height(bitmap.height), rowStride(N*bitmap.width) { }
+
+template <typename T, int N>
+BitmapConstSection<T, N>::BitmapConstSection(const msdfgen::BitmapRef<T, N> &bitmap) : pixels(bitmap.pixels), width(bitmap.width), height(bitmap.height), rowStride(N*bitmap.width) { }
+
+template <typename T, int N>
+BitmapConstSection<T, N>::BitmapConstSection(const BitmapSection<T, N> &section) : pixels(section.pixels), width(section.width), height(section.height), rowStride(section.rowStride) { }
+
+template <typename T, int N>
+BitmapConstSection<T, N>::BitmapConstSection(const msdfgen::Bitmap<T, N> &bitmap) : pixels((const T *) bitmap), width(bitmap.width()), height(bitmap.height()), rowStride(N*bitmap.width()) { }
+
+template <typename T, int N>
+const T * BitmapConstSection<T, N>::operator()(int x, int y) const {
+    return pixels+(ptrdiff_t) rowStride*y+N*x;
+}
+
+template <typename T, int N>
+BitmapConstSection<T, N> BitmapConstSection<T, N>::getSection(int l, int b, int r, int t) const {
+    return BitmapConstSection<T, N>((*this)(l, b), r-l, t-b, rowStride);
+}
+
+template <typename T, int N>
+BitmapConstSection<T, N> BitmapConstSection<T, N>::flipped() const {
+    return BitmapConstSection<T, N>(height ? (*this)(0, height-1) : pixels, width, height, -rowStride);
+}
+
+template <typename T, int N>
+bool BitmapConstSection<T, N>::isContiguous() const {
+    return rowStride == N*width || height <= 1;
+}
+
+}
@@ -0,0 +1,365 @@
+
+#include "BufferedWriter.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace msdf_atlas {
+
+/// Number of significant digits that always suffices to identify a double
+#define ROUND_TRIP_MAX_PRECISION 17
+/// Integers below this magnitude are written directly, which matches %.15g
+#define MAX_DIRECT_INTEGER 1e15
+
+/*
+ * Shortest round-trip formatting of doubles by the Grisu2 algorithm (F. Loitsch, Printing Floating-Point Numbers Quickly and Accurately with Integers, 2010).
+ * The output always parses back to the same value and has the fewest possible digits in all but rare cases, where it has one more.
+ */
+
+/// Normalized significands of the cached powers of ten 10^-348, 10^-340, ..., 10^340
+static const uint64_t cachedPowerSignificands[] = {
+    0xfa8fd5a0081c0288ull, 0xbaaee17fa23ebf76ull, 0x8b16fb203055ac76ull, 0xcf42894a5dce35eaull,
+    0x9a6bb0aa55653b2dull, 0xe61acf033d1a45dfull, 0xab70fe17c79ac6caull, 0xff77b1fcbebcdc4full,
+    0xbe5691ef416bd60cull, 0x8dd01fad907ffc3cull, 0xd3515c2831559a83ull, 0x9d71ac8fada6c9b5ull,
+    0xea9c227723ee8bcbull, 0xaecc49914078536dull, 0x823c12795db6ce57ull, 0xc21094364dfb5637ull,
+    0x9096ea6f3848984full, 0xd77485cb25823ac7ull, 0xa086cfcd97bf97f4ull, 0xef340a98172aace5ull,
+    0xb23867fb2a35b28eull, 0x84c8d4dfd2c63f3bull, 0xc5dd44271ad3cdbaull, 0x936b9fcebb25c996ull,
+    0xdbac6c247d62a584ull, 0xa3ab66580d5fdaf6ull, 0xf3e2f893dec3f126ull, 0xb5b5ada8aaff80b8ull,
+    0x87625f056c7c4a8bull, 0xc9bcff6034c13053ull, 0x964e858c91ba2655ull, 0xdff9772470297ebdull,
+    0xa6dfbd9fb8e5b88full, 0xf8a95fcf88747d94ull, 0xb94470938fa89bcfull, 0x8a08f0f8bf0f156bull,
+    0xcdb02555653131b6ull, 0x993fe2c6d07b7facull, 0xe45c10c42a2b3b06ull, 0xaa242499697392d3ull,
+    0xfd87b5f28300ca0eull, 0xbce5086492111aebull, 0x8cbccc096f5088ccull, 0xd1b71758e219652cull,
+    0x9c40000000000000ull, 0xe8d4a51000000000ull, 0xad78ebc5ac620000ull, 0x813f3978f8940984ull,
+    0xc097ce7bc90715b3ull, 0x8f7e32ce7bea5c70ull, 0xd5d238a4abe98068ull, 0x9f4f2726179a2245ull,
+    0xed63a231d4c4fb27ull, 0xb0de65388cc8ada8ull, 0x83c7088e1aab65dbull, 0xc45d1df942711d9aull,
+    0x924d692ca61be758ull, 0xda01ee641a708deaull, 0xa26da3999aef774aull, 0xf209787bb47d6b85ull,
+    0xb454e4a179dd1877ull, 0x865b86925b9bc5c2ull, 0xc83553c5c8965d3dull, 0x952ab45cfa97a0b3ull,
+    0xde469fbd99a05fe3ull, 0xa59bc234db398c25ull, 0xf6c69a72a3989f5cull, 0xb7dcbf5354e9beceull,
+    0x88fcf317f22241e2ull, 0xcc20ce9bd35c78a5ull, 0x98165af37b2153dfull, 0xe2a0b5dc971f303aull,
+    0xa8d9d1535ce3b396ull, 0xfb9b7cd9a4a7443cull, 0xbb764c4ca7a44410ull, 0x8bab8eefb6409c1aull,
+    0xd01fef10a657842cull, 0x9b10a4e5e9913129ull, 0xe7109bfba19c0c9dull, 0xac2820d9623bf429ull,
+    0x80444b5e7aa7cf85ull, 0xbf21e44003acdd2dull, 0x8e679c2f5e44ff8full, 0xd433179d9c8cb841ull,
+    0x9e19db92b4e31ba9ull, 0xeb96bf6ebadf77d9ull, 0xaf87023b9bf0ee6bull
+};
+
+/// Binary exponents of the cached powers of ten
+static const int16_t cachedPowerExponents[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+    -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+    -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+    -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+    694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+    1013, 1039, 1066
+};
+
+static const uint64_t powersOfTen[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+    10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull, 1000000000000000ull,
+    10000000000000000ull, 100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull
+};
+
+#define DOUBLE_SIGNIFICAND_BITS 52
+#define DOUBLE_HIDDEN_BIT 0x0010000000000000ull
+#define DOUBLE_SIGNIFICAND_MASK 0x000fffffffffffffull
+#define DOUBLE_EXPONENT_BIAS (0x3ff+DOUBLE_SIGNIFICAND_BITS)
+
+/// Floating-point value with a 64-bit significand, f * 2^e
+struct DiyFp {
+    uint64_t f;
+    int e;
+};
+
+static DiyFp diyFpMultiply(DiyFp a, DiyFp b) {
+    // Upper 64 bits of the 128-bit product, rounded
+    uint64_t ah = a.f>>32, al = a.f&0xffffffffu, bh = b.f>>32, bl = b.f&0xffffffffu;
+    uint64_t hh = ah*bh, hl = ah*bl, lh = al*bh, ll = al*bl;
+    uint64_t middle = (ll>>32)+(hl&0xffffffffu)+(lh&0xffffffffu)+(1ull<<31);
+    DiyFp result = { hh+(hl>>32)+(lh>>32)+(middle>>32), a.e+b.e+64 };
+    return result;
+}
+
+static DiyFp diyFpNormalize(DiyFp x) {
+    while (!(x.f&0x8000000000000000ull))
+        x.f <<= 1, --x.e;
+    return x;
+}
+
+static void grisuRound(char *digits, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance) {
+    // Moves the last digit towards the exact value while the result stays within the rounding interval
+    while (rest < distance && delta-rest >= tenKappa && (rest+tenKappa < distance || distance-rest > rest+tenKappa-distance)) {
+        --digits[length-1];
+        rest += tenKappa;
+    }
+}
+
+/// Generates the decimal digits of a positive finite value, which equals digits * 10^exponent
+static int grisu2(double value, char *digits, int &exponent) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int biasedExponent = int(bits>>DOUBLE_SIGNIFICAND_BITS&0x7ff);
+    DiyFp v = { bits&DOUBLE_SIGNIFICAND_MASK, 1-DOUBLE_EXPONENT_BIAS };
+    if (biasedExponent) {
+        v.f += DOUBLE_HIDDEN_BIT;
+        v.e = biasedExponent-DOUBLE_EXPONENT_BIAS;
+    }
+
+    // Boundaries of the rounding interval - halfway to the neighboring values
+    DiyFp plus = { (v.f<<1)+1, v.e-1 };
+    while (!(plus.f&(DOUBLE_HIDDEN_BIT<<1)))
+        plus.f <<= 1, --plus.e;
+    plus.f <<= 64-DOUBLE_SIGNIFICAND_BITS-2;
+    plus.e -= 64-DOUBLE_SIGNIFICAND_BITS-2;
+    DiyFp minus = v.f == DOUBLE_HIDDEN_BIT ? DiyFp { (v.f<<2)-1, v.e-2 } : DiyFp { (v.f<<1)-1, v.e-1 };
+    minus.f <<= minus.e-plus.e;
+    minus.e = plus.e;
+
+    // Cached power of ten that brings the binary exponent of the scaled boundaries into [-60, -32]
+    double dk = (-61-plus.e)*0.30102999566398114+347;
+    int k = int(dk);
+    if (dk-k > 0)
+        ++k;
+    int index = (k>>3)+1;
+    exponent = -(-348+8*index);
+    DiyFp cachedPower = { cachedPowerSignificands[index], cachedPowerExponents[index] };
+
+    DiyFp w = diyFpMultiply(diyFpNormalize(v), cachedPower);
+    DiyFp high = diyFpMultiply(plus, cachedPower);
+    DiyFp low = diyFpMultiply(minus, cachedPower);
+    ++low.f, --high.f;
+    uint64_t delta = high.f-low.f;
+
+    // Digit generation - the integral part of high first, then its fractional part
+    int shift = -high.e;
+    uint64_t one = 1ull<<shift;
+    uint64_t distance = high.f-w.f;
+    uint32_t integral = uint32_t(high.f>>shift);
+    uint64_t fractional = high.f&(one-1);
+    int kappa = 1;
+    while (kappa < 10 && integral >= powersOfTen[kappa])
+        ++kappa;
+    int length = 0;
+    while (kappa > 0) {
+        uint32_t divisor = uint32_t(powersOfTen[--kappa]);
+        uint32_t digit = integral/divisor;
+        integral %= divisor;
+        if (digit || length)
+            digits[length++] = char('0'+digit);
+        uint64_t rest = ((uint64_t) integral<<shift)+fractional;
+        if (rest <= delta) {
+            exponent += kappa;
+            grisuRound(digits, length, delta, rest, powersOfTen[kappa]<<shift, distance);
+            return length;
+        }
+    }
+    for (;;) {
+        fractional *= 10;
+        delta *= 10;
+        char digit = char(fractional>>shift);
+        if (digit || length)
+            digits[length++] = char('0'+digit);
+        fractional &= one-1;
+        --kappa;
+        if (fractional < delta) {
+            exponent += kappa;
+            grisuRound(digits, length, delta, fractional, one, -kappa < 20 ? distance*powersOfTen[-kappa] : 0);
+            return length;
+        }
+    }
+}
+
+/// Formats a finite non-zero value like %g (plain notation for decimal exponents from -4 up to ROUND_TRIP_MAX_PRECISION) with the shortest round-trip digits
+static int formatShortest(char *output, double value) {
+    char *cur = output;
+    if (value < 0)
+        *cur++ = '-', value = -value;
+    char digits[ROUND_TRIP_MAX_PRECISION+1];
+    int exponent;
+    int length = grisu2(value, digits, exponent);
+    // Decimal exponent of the first digit
+    int x = length+exponent-1;
+    if (x >= -4 && x < ROUND_TRIP_MAX_PRECISION) {
+        if (exponent >= 0) {
+            memcpy(cur, digits, length);
+            cur += length;
+            memset(cur, '0', exponent);
+            cur += exponent;
+        } else if (x >= 0) {
+            memcpy(cur, digits, x+1);
+            cur += x+1;
+            *cur++ = '.';
+            memcpy(cur, digits+x+1, length-x-1);
+            cur += length-x-1;
+        } else {
+            *cur++ = '0', *cur++ = '.';
+            memset(cur, '0', -x-1);
+            cur += -x-1;
+            memcpy(cur, digits, length);
+            cur += length;
+        }
+    } else {
+        *cur++ = digits[0];
+        if (length > 1) {
+            *cur++ = '.';
+            memcpy(cur, digits+1, length-1);
+            cur += length-1;
+        }
+        *cur++ = 'e';
+        *cur++ = x < 0 ? '-' : '+';
+        if (x < 0)
+            x = -x;
+        if (x >= 100)
+            *cur++ = char('0'+x/100);
+        *cur++ = char('0'+x/10%10);
+        *cur++ = char('0'+x%10);
+    }
+    return int(cur-output);
+}
+
+static int formatDouble(char *output, size_t size, double value, int precision) {
+    if (precision > 0 || !std::isfinite(value) || value == 0)
+        return snprintf(output, size, "%.*g", precision > 0 ? precision : ROUND_TRIP_MAX_PRECISION, value);
+    return formatShortest(output, value);
+}
+
+BufferedWriter::BufferedWriter(FILE *file, size_t bufferSize) : file(file), bufferSize(bufferSize), floatPrecision(0), failed(!file) {
+    buffer.reserve(bufferSize);
+}
+
+BufferedWriter::BufferedWriter() : file(nullptr), bufferSize(0), floatPrecision(0), failed(false) { }
+
+BufferedWriter::~BufferedWriter() {
+    flush();
+}
+
+void BufferedWriter::write(char c) {
+    if (file && buffer.size() >= bufferSize)
+        flush();
+    buffer.push_back(c);
+}
+
+void BufferedWriter::write(const char *str) {
+    write(str, strlen(str));
+}
+
+void BufferedWriter::write(const char *str, size_t length) {
+    if (file && buffer.size()+length > bufferSize) {
+        flush();
+        if (length > bufferSize) {
+            failed |= fwrite(str, 1, length, file) != length;
+            return;
+        }
+    }
+    buffer.insert(buffer.end(), str, str+length);
+}
+
+void BufferedWriter::writeInt(int value) {
+    if (value < 0) {
+        write('-');
+        writeUnsigned(0u-(unsigned) value);
+    } else
+        writeUnsigned((unsigned) value);
+}
+
+void BufferedWriter::writeUnsigned(unsigned value) {
+    char digits[16];
+    char *end = digits+sizeof(digits), *cur = end;
+    do {
+        *--cur = char('0'+value%10);
+        value /= 10;
+    } while (value);
+    write(cur, end-cur);
+}
+
+void BufferedWriter::writeHexByte(unsigned value) {
+    static const char hexDigits[] = "0123456789ABCDEF";
+    char digits[2] = { hexDigits[value>>4&0x0f], hexDigits[value&0x0f] };
+    write(digits, 2);
+}
+
+void BufferedWriter::writeDouble(double value) {
+    if (!floatPrecision && value == floor(value) && fabs(value) < MAX_DIRECT_INTEGER) {
+        if (value == 0 && std::signbit(value))
+            write("-0", 2);
+        else {
+            if (value < 0)
+                write('-');
+            unsigned long long integer = (unsigned long long) fabs(value);
+            char digits[24];
+            char *end = digits+sizeof(digits), *cur = end;
+            do {
+                *--cur = char('0'+integer%10);
+                integer /= 10;
+            } while (integer);
+            write(cur, end-cur);
+        }
+        return;
+    }
+    char str[32];
+    int length = formatDouble(str, sizeof(str), value, floatPrecision);
+    if (length > 0)
+        write(str, std::min((size_t) length, sizeof(str)-1));
+}
+
+void BufferedWriter::writeEscapedJson(const char *str) {
+    char uval[7] = "\\u0000";
+    const char *span = str;
+    for (; *str; ++str) {
+        const char *escape = nullptr;
+        switch (*str) {
+            case '\\':
+                escape = "\\\\";
+                break;
+            case '"':
+                escape = "\\\"";
+                break;
+            case '\n':
+                escape = "\\n";
+                break;
+            case '\r':
+                escape = "\\r";
+                break;
+            case '\t':
+                escape = "\\t";
+                break;
+            default:
+                if ((unsigned char) *str < 0x20) {
+                    uval[4] = '0'+(*str >= 0x10);
+                    uval[5] = "0123456789abcdef"[*str&0x0f];
+                    escape = uval;
+                }
+        }
+        if (escape) {
+            // Unescaped characters are written as a whole span
+            write(span, str-span);
+            write(escape);
+            span = str+1;
+        }
+    }
+    write(span, str-span);
+}
+
+void BufferedWriter::setFloatPrecision(int precision) {
+    floatPrecision = precision;
+}
+
+int BufferedWriter::getFloatPrecision() const {
+    return floatPrecision;
+}
+
+bool BufferedWriter::flush() {
+    if (file && !buffer.empty()) {
+        failed |= fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size();
+        buffer.clear();
+    }
+    return !failed;
+}
+
+const std::vector<char> & BufferedWriter::data() const {
+    return buffer;
+}
+
+}
@@ -0,0 +1,50 @@
+
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+namespace msdf_atlas {
+
+/**
+ * Writes formatted text into a file, or into memory if no file is given, through a large buffer.
+ * Floating-point values are by default written with the shortest digits that still parse back to the same value (Grisu2),
+ * which are the fewest possible except in rare cases where one digit more is written.
+ */
+class BufferedWriter {
+
+public:
+    /// Buffered writes into an open file, which is flushed when the buffer is full and on destruction
+    explicit BufferedWriter(FILE *file, size_t bufferSize = 1<<16);
+    /// Collects the output in memory (see data)
+    BufferedWriter();
+    ~BufferedWriter();
+    void write(char c);
+    void write(const char *str);
+    void write(const char *str, size_t length);
+    void writeInt(int value);
+    void writeUnsigned(unsigned value);
+    /// Writes an 8-bit value as two hexadecimal digits
+    void writeHexByte(unsigned value);
+    /// Writes a floating-point value in the %g style with the current precision
+    void writeDouble(double value);
+    /// Writes the string with JSON escape sequences (without quotes)
+    void writeEscapedJson(const char *str);
+    /// Sets the number of significant digits of floating-point values, 0 = shortest round-trip representation
+    void setFloatPrecision(int precision);
+    int getFloatPrecision() const;
+    /// Writes the buffered data into the file, returns false if any write has failed
+    bool flush();
+    /// Returns the output collected in memory
+    const std::vector<char> & data() const;
+
+private:
+    FILE *file;
+    std::vector<char> buffer;
+    size_t bufferSize;
+    int floatPrecision;
+    bool failed;
+
+};
+
+}
@@ -0,0 +1,46 @@
+
+#pragma once
+
+#include <vector>
+#include "GlyphBox.h"
+#include "Workload.h"
+#include "AtlasGenerator.h"
+
+namespace msdf_atlas {
+
+/**
+ * An implementation of AtlasGenerator for single-channel generator functions,
+ * which stores each glyph into the channel of a multi-channel AtlasStorage given by its box channel
+ * (see TightAtlasPacker::setChannelCount), so that several single-channel atlases share one texture.
+ * Like ImmediateAtlasGenerator, it does not return until all submitted work is finished.
+ */
+template <typename T, GeneratorFunction<T, 1> GEN_FN, class AtlasStorage>
+class ChannelPackedAtlasGenerator {
+
+public:
+    ChannelPackedAtlasGenerator();
+    ChannelPackedAtlasGenerator(int width, int height);
+    void generate(const GlyphGeometry *glyphs, int count);
+    void rearrange(int width, int height, const Remap *remapping, int count);
+    void resize(int width, int height);
+    void discard(int index);
+    /// Sets attributes for the generator function
+    void setAttributes(const GeneratorAttributes &attributes);
+    /// Sets the number of threads to be run by generate
+    void setThreadCount(int threadCount);
+    /// Allows access to the underlying AtlasStorage
+    const AtlasStorage & atlasStorage() const;
+
+private:
+    AtlasStorage storage;
+    std::vector<GlyphBox> layout;
+    std::vector<T> glyphBuffer;
+    std::vector<byte> errorCorrectionBuffer;
+    GeneratorAttributes attributes;
+    int threadCount;
+
+};
+
+}
+
+#include "ChannelPackedAtlasGenerator.hpp"
@@ -0,0 +1,83 @@
+
+#include "ChannelPackedAtlasGenerator.h"
+
+#include <algorithm>
+
+namespace msdf_atlas {
+
+template <typename T, GeneratorFunction<T, 1> GEN_FN, class AtlasStorage>
+ChannelPackedAtlasGenerator<T, GEN_FN, AtlasStorage>::ChannelPackedAtlasGenerator() : threadCount(1) { }
+
+template <typename T, GeneratorFunction<T, 1> GEN_FN, class AtlasStorage>
+ChannelPackedAtlasGenerator<T, GEN_FN, AtlasStorage>::ChannelPackedAtlasGenerator(int width, int height) : storage(width, height), threadCount(1) { }
+
+template <typename T, GeneratorFunction<T, 1> GEN_FN, class AtlasStorage>
+void ChannelPackedAtlasGenerator<T, GEN_FN, AtlasStorage>::generate(const GlyphGeometry *glyphs, int count) {
+    int maxBoxArea = 0;
+    for (int i = 0; i < count; ++i) {
+        GlyphBox box = glyphs[i];
+        maxBoxArea = std::max(maxBoxArea, box.rect.w*box.rect.h);
+        layout.push_back((GlyphBox &&) box);
+    }
+    int threadBufferSize = maxBoxArea;
+    if (threadCount*threadBufferSize > (int) glyphBuffer.size())
+        glyphBuffer.resize(threadCount*threadBufferSize);
+    if (threadCount*maxBoxArea > (int) errorCorrectionBuffer.size())
+        errorCorrectionBuffer.resize(threadCount*maxBoxArea);
+    std::vector<GeneratorAttributes> threadAttributes(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        threadAttributes[i] = attributes;
+        threadAttributes[i].config.errorCorrection.buffer = errorCorrectionBuffer.data()+i*maxBoxArea;
+    }
+
+    // Glyphs in different channels may overlap, but each thread only writes the components of its glyph's channel
+    Workload([this, glyphs, &threadAttributes, threadBufferSize](int i, int threadNo) -> bool {
+        const GlyphGeometry &glyph = glyphs[i];
+        if (!glyph.isWhitespace()) {
+            int l, b, w, h;
+            glyph.getBoxRect(l, b, w, h);
+            msdfgen::BitmapRef<T, 1> glyphBitmap(glyphBuffer.data()+threadNo*threadBufferSize, w, h);
+            GEN_FN(glyphBitmap, glyph, threadAttributes[threadNo]);
+            storage.put(l, b, glyph.getBoxChannel(), msdfgen::BitmapConstRef<T, 1>(glyphBitmap));
+        }
+        return true;
+    }, count).finish(threadCount);
+}
+
+template <typename T, GeneratorFunction<T, 1> GEN_FN, class AtlasStorage>
+void ChannelPackedAtlasGenerator<T, GEN_FN, AtlasStorage>::rearrange(int width, int height, const Remap *remapping, int count) {
+    for (int i = 0; i < count; ++i) {
+        layout[remapping[i].index].rect.x = remapping[i].target.x;
+        layout[remapping[i].index].rect.y = remapping[i].target.y;
+    }
+    AtlasStorage newStorage((AtlasStorage &&) storage, width, height, remapping, count);
+    storage = (AtlasStorage &&) newStorage;
+}
+
+template <typename T, GeneratorFunction<T, 1> GEN_FN, class AtlasStorage>
+void ChannelPackedAtlasGenerator<T, GEN_FN, AtlasStorage>::resize(int width, int height) {
+    AtlasStorage newStorage((AtlasStorage &&) storage, width, height);
+    storage = (AtlasStorage &&) newStorage;
+}
+
+template <typename T, GeneratorFunction<T, 1> GEN_FN, class AtlasStorage>
+void ChannelPackedAtlasGenerator<T, GEN_FN, AtlasStorage>::discard(int) {
+    // All work is finished by the time generate returns, so there is nothing to cancel
+}
+
+template <typename T, GeneratorFunction<T, 1> GEN_FN, class AtlasStorage>
+void ChannelPackedAtlasGenerator<T, GEN_FN, AtlasStorage>::setAttributes(const GeneratorAttributes &attributes) {
+    this->attributes = attributes;
+}
+
+template <typename T, GeneratorFunction<T, 1> GEN_FN, class AtlasStorage>
+void ChannelPackedAtlasGenerator<T, GEN_FN, AtlasStorage>::setThreadCount(int threadCount) {
+    this->threadCount = threadCount;
+}
+
+template <typename T, GeneratorFunction<T, 1> GEN_FN, class AtlasStorage>
+const AtlasStorage & ChannelPackedAtlasGenerator<T, GEN_FN, AtlasStorage>::atlasStorage() const {
+    return storage;
+}
+
+}
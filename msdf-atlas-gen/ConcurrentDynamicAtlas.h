@@ -0,0 +1,122 @@
+
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include "DynamicAtlas.h"
+
+namespace msdf_atlas {
+
+/**
+ * A thread-safe front end of DynamicAtlas. Any thread may request glyphs and look up their placements without locking,
+ * while a single owner thread (e.g. the one that uploads the atlas texture) periodically calls update,
+ * which adds all glyphs requested since the last call to the DynamicAtlas in a single batch and publishes their placements.
+ * Glyphs are identified by caller-defined 64-bit keys (e.g. a font identifier combined with the glyph index),
+ * and requests with the same key are merged. The table of keys has a fixed capacity. Keys stay in it after their glyphs are evicted or removed,
+ * so that they may be requested again, until rehash drops them.
+ */
+template <class AtlasGenerator>
+class ConcurrentDynamicAtlas {
+
+public:
+    /// This key value is reserved and cannot be used
+    static const unsigned long long INVALID_KEY = ~0ull;
+    /// Published positions are stored as 16-bit coordinates, so the atlas side is limited to this value
+    static const int MAX_SIDE = 0xffff;
+
+    /// Outcome of request
+    enum class RequestResult {
+        /// The glyph has been queued by this call
+        QUEUED,
+        /// A glyph with the same key is already queued or in the atlas
+        ALREADY_REQUESTED,
+        /// Whitespace glyphs are not accepted
+        WHITESPACE,
+        /// The table of keys is full (see rehash), the glyph has been dropped
+        TABLE_FULL
+    };
+
+    /// Creates with space for keyCapacity distinct keys
+    explicit ConcurrentDynamicAtlas(int keyCapacity);
+    /// Creates with a configured generator. The generator must not contain any prior glyphs!
+    ConcurrentDynamicAtlas(int keyCapacity, AtlasGenerator &&generator);
+    ~ConcurrentDynamicAtlas();
+
+    // The following may be called from any thread
+
+    /// Queues a copy of the glyph to be added by the next update, unless a glyph with the same key is already queued or in the atlas
+    RequestResult request(unsigned long long key, const GlyphGeometry &glyph);
+    /// Outputs the position of the glyph's box published by the last update and marks the glyph as used, which postpones its eviction.
+    /// Returns false if the glyph is not in the atlas
+    bool find(unsigned long long key, int &x, int &y);
+
+    // The following must only be called from the owner thread
+
+    /// Adds the queued glyphs to the atlas and publishes their placements, returns their number
+    int update();
+    /// Removes the glyph from the atlas, so that it may be requested again
+    bool remove(unsigned long long key);
+    /// Performs DynamicAtlas::compact and publishes the new placements
+    int compact(int maxMoves);
+    /// Performs DynamicAtlas::repack and publishes the new placements
+    bool repack();
+    /// Returns the number of keys in the table
+    int getKeyCount() const;
+    /// Rebuilds the table of keys with only the glyphs that are queued or in the atlas, and returns the number of keys dropped.
+    /// Unlike the other operations of the owner thread, this must not overlap any calls from other threads
+    int rehash();
+    /// Allows access to the underlying DynamicAtlas. Do not add or remove glyphs through it, and do not raise its maximum side above MAX_SIDE!
+    DynamicAtlas<AtlasGenerator> & dynamicAtlas();
+    const DynamicAtlas<AtlasGenerator> & dynamicAtlas() const;
+
+private:
+    enum SlotState {
+        SLOT_ABSENT,
+        SLOT_QUEUED,
+        SLOT_PLACED
+    };
+
+    struct Slot {
+        std::atomic<unsigned long long> key;
+        /// Encoded placement of the glyph's box or 0 if it is not in the atlas
+        std::atomic<unsigned long long> placement;
+        std::atomic<int> state;
+        std::atomic<bool> used;
+        /// The glyph's index in the DynamicAtlas, only accessed by the owner thread
+        int glyph;
+    };
+
+    struct Request {
+        Slot *slot;
+        GlyphGeometry glyph;
+        Request *next;
+    };
+
+    DynamicAtlas<AtlasGenerator> atlas;
+    std::vector<Slot> slots;
+    /// Lock-free stack of pending requests, most recent first
+    std::atomic<Request *> requests;
+    std::atomic<int> keyCount;
+    // Owner thread only
+    std::vector<Slot *> glyphSlots;
+    std::vector<int> liveGlyphs;
+
+    static unsigned long long hashKey(unsigned long long key);
+    static unsigned long long encodePlacement(int index, int x, int y);
+
+    static void clearSlots(std::vector<Slot> &slots);
+
+    void initialize(int keyCapacity);
+    Slot * claimSlot(unsigned long long key);
+    Slot * findSlot(unsigned long long key);
+    void publish(int index);
+    void unpublish(int index);
+
+    ConcurrentDynamicAtlas(const ConcurrentDynamicAtlas &);
+    ConcurrentDynamicAtlas & operator=(const ConcurrentDynamicAtlas &);
+
+};
+
+}
+
+#include "ConcurrentDynamicAtlas.hpp"
@@ -0,0 +1,279 @@
+
+#include "ConcurrentDynamicAtlas.h"
+
+namespace msdf_atlas {
+
+template <class AtlasGenerator>
+const unsigned long long ConcurrentDynamicAtlas<AtlasGenerator>::INVALID_KEY;
+
+template <class AtlasGenerator>
+const int ConcurrentDynamicAtlas<AtlasGenerator>::MAX_SIDE;
+
+template <class AtlasGenerator>
+ConcurrentDynamicAtlas<AtlasGenerator>::ConcurrentDynamicAtlas(int keyCapacity) : requests(nullptr), keyCount(0) {
+    initialize(keyCapacity);
+}
+
+template <class AtlasGenerator>
+ConcurrentDynamicAtlas<AtlasGenerator>::ConcurrentDynamicAtlas(int keyCapacity, AtlasGenerator &&generator) : atlas((AtlasGenerator &&) generator), requests(nullptr), keyCount(0) {
+    initialize(keyCapacity);
+}
+
+template <class AtlasGenerator>
+ConcurrentDynamicAtlas<AtlasGenerator>::~ConcurrentDynamicAtlas() {
+    for (Request *request = requests.load(), *next; request; request = next) {
+        next = request->next;
+        delete request;
+    }
+}
+
+template <class AtlasGenerator>
+typename ConcurrentDynamicAtlas<AtlasGenerator>::RequestResult ConcurrentDynamicAtlas<AtlasGenerator>::request(unsigned long long key, const GlyphGeometry &glyph) {
+    if (glyph.isWhitespace())
+        return RequestResult::WHITESPACE;
+    Slot *slot = claimSlot(key);
+    if (!slot)
+        return RequestResult::TABLE_FULL;
+    // Only the thread that changes the state from absent queues the glyph
+    int expected = SLOT_ABSENT;
+    if (!slot->state.compare_exchange_strong(expected, SLOT_QUEUED, std::memory_order_acq_rel))
+        return RequestResult::ALREADY_REQUESTED;
+    Request *request = new Request { slot, glyph, requests.load(std::memory_order_relaxed) };
+    while (!requests.compare_exchange_weak(request->next, request, std::memory_order_release, std::memory_order_relaxed));
+    return RequestResult::QUEUED;
+}
+
+template <class AtlasGenerator>
+bool ConcurrentDynamicAtlas<AtlasGenerator>::find(unsigned long long key, int &x, int &y) {
+    Slot *slot = findSlot(key);
+    if (!slot)
+        return false;
+    unsigned long long placement = slot->placement.load(std::memory_order_acquire);
+    if (!placement)
+        return false;
+    if (!slot->used.load(std::memory_order_relaxed))
+        slot->used.store(true, std::memory_order_relaxed);
+    x = int(placement>>16&0xffff);
+    y = int(placement&0xffff);
+    return true;
+}
+
+template <class AtlasGenerator>
+int ConcurrentDynamicAtlas<AtlasGenerator>::update() {
+    // Glyphs used since the last update are touched before any may be evicted
+    for (int i = 0; i < (int) liveGlyphs.size();) {
+        int index = liveGlyphs[i];
+        if (!glyphSlots[index]) {
+            liveGlyphs[i] = liveGlyphs.back();
+            liveGlyphs.pop_back();
+            continue;
+        }
+        if (glyphSlots[index]->used.exchange(false, std::memory_order_relaxed))
+            atlas.touch(index);
+        ++i;
+    }
+
+    std::vector<Request *> batch;
+    for (Request *request = requests.exchange(nullptr, std::memory_order_acquire); request; request = request->next)
+        batch.push_back(request);
+    if (batch.empty())
+        return 0;
+    std::vector<GlyphGeometry> glyphs;
+    glyphs.reserve(batch.size());
+    for (int i = (int) batch.size()-1; i >= 0; --i)
+        glyphs.push_back((GlyphGeometry &&) batch[i]->glyph);
+
+    int start = glyphSlots.size();
+    atlas.add(glyphs.data(), glyphs.size());
+    for (int index : atlas.getEvictedGlyphs())
+        unpublish(index);
+    glyphSlots.resize(start+batch.size(), nullptr);
+    for (int i = 0; i < (int) batch.size(); ++i) {
+        Slot *slot = batch[batch.size()-i-1]->slot;
+        if (atlas.contains(start+i)) {
+            slot->glyph = start+i;
+            glyphSlots[start+i] = slot;
+            liveGlyphs.push_back(start+i);
+            publish(start+i);
+            slot->state.store(SLOT_PLACED, std::memory_order_release);
+        } else
+            slot->state.store(SLOT_ABSENT, std::memory_order_release);
+    }
+    for (Request *request : batch)
+        delete request;
+    return batch.size();
+}
+
+template <class AtlasGenerator>
+bool ConcurrentDynamicAtlas<AtlasGenerator>::remove(unsigned long long key) {
+    Slot *slot = findSlot(key);
+    if (!(slot && slot->state.load(std::memory_order_acquire) == SLOT_PLACED))
+        return false;
+    int index = slot->glyph;
+    atlas.remove(index);
+    unpublish(index);
+    return true;
+}
+
+template <class AtlasGenerator>
+int ConcurrentDynamicAtlas<AtlasGenerator>::compact(int maxMoves) {
+    int moved = atlas.compact(maxMoves);
+    for (int index : atlas.getMovedGlyphs())
+        publish(index);
+    return moved;
+}
+
+template <class AtlasGenerator>
+bool ConcurrentDynamicAtlas<AtlasGenerator>::repack() {
+    if (!atlas.repack())
+        return false;
+    for (int index : liveGlyphs) {
+        if (glyphSlots[index])
+            publish(index);
+    }
+    return true;
+}
+
+template <class AtlasGenerator>
+int ConcurrentDynamicAtlas<AtlasGenerator>::getKeyCount() const {
+    return keyCount.load(std::memory_order_relaxed);
+}
+
+template <class AtlasGenerator>
+int ConcurrentDynamicAtlas<AtlasGenerator>::rehash() {
+    // No other thread is accessing the table, so the slots are moved with relaxed operations
+    std::vector<Slot> newSlots(slots.size());
+    clearSlots(newSlots);
+    std::vector<Slot *> relocated(slots.size(), nullptr);
+    size_t mask = newSlots.size()-1;
+    int newKeyCount = 0;
+    for (size_t i = 0; i < slots.size(); ++i) {
+        const Slot &slot = slots[i];
+        unsigned long long key = slot.key.load(std::memory_order_relaxed);
+        int state = slot.state.load(std::memory_order_relaxed);
+        if (key == INVALID_KEY || state == SLOT_ABSENT)
+            continue;
+        size_t j = hashKey(key)&mask;
+        while (newSlots[j].key.load(std::memory_order_relaxed) != INVALID_KEY)
+            j = (j+1)&mask;
+        Slot &newSlot = newSlots[j];
+        newSlot.key.store(key, std::memory_order_relaxed);
+        newSlot.placement.store(slot.placement.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        newSlot.state.store(state, std::memory_order_relaxed);
+        newSlot.used.store(slot.used.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        newSlot.glyph = slot.glyph;
+        relocated[i] = &newSlot;
+        ++newKeyCount;
+    }
+    // Queued requests and placed glyphs refer to their slots directly
+    for (Request *request = requests.load(std::memory_order_relaxed); request; request = request->next)
+        request->slot = relocated[request->slot-slots.data()];
+    for (int index : liveGlyphs) {
+        if (glyphSlots[index])
+            glyphSlots[index] = relocated[glyphSlots[index]-slots.data()];
+    }
+    slots.swap(newSlots);
+    return keyCount.exchange(newKeyCount, std::memory_order_relaxed)-newKeyCount;
+}
+
+template <class AtlasGenerator>
+DynamicAtlas<AtlasGenerator> & ConcurrentDynamicAtlas<AtlasGenerator>::dynamicAtlas() {
+    return atlas;
+}
+
+template <class AtlasGenerator>
+const DynamicAtlas<AtlasGenerator> & ConcurrentDynamicAtlas<AtlasGenerator>::dynamicAtlas() const {
+    return atlas;
+}
+
+template <class AtlasGenerator>
+void ConcurrentDynamicAtlas<AtlasGenerator>::clearSlots(std::vector<Slot> &slots) {
+    for (Slot &slot : slots) {
+        slot.key.store(INVALID_KEY, std::memory_order_relaxed);
+        slot.placement.store(0, std::memory_order_relaxed);
+        slot.state.store(SLOT_ABSENT, std::memory_order_relaxed);
+        slot.used.store(false, std::memory_order_relaxed);
+        slot.glyph = -1;
+    }
+}
+
+template <class AtlasGenerator>
+void ConcurrentDynamicAtlas<AtlasGenerator>::initialize(int keyCapacity) {
+    atlas.setMaxSide(MAX_SIDE);
+    // Keep the table at most half full to limit probing
+    int size = 1;
+    while (size < 2*keyCapacity)
+        size <<= 1;
+    std::vector<Slot> newSlots(size);
+    clearSlots(newSlots);
+    slots.swap(newSlots);
+}
+
+template <class AtlasGenerator>
+typename ConcurrentDynamicAtlas<AtlasGenerator>::Slot * ConcurrentDynamicAtlas<AtlasGenerator>::claimSlot(unsigned long long key) {
+    if (key == INVALID_KEY)
+        return nullptr;
+    size_t mask = slots.size()-1;
+    for (size_t i = hashKey(key)&mask, n = 0; n < slots.size(); i = (i+1)&mask, ++n) {
+        unsigned long long current = slots[i].key.load(std::memory_order_acquire);
+        if (current == INVALID_KEY && slots[i].key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+            keyCount.fetch_add(1, std::memory_order_relaxed);
+            return &slots[i];
+        }
+        // If another thread has claimed the slot in the meantime, current now holds its key
+        if (current == key)
+            return &slots[i];
+    }
+    return nullptr;
+}
+
+template <class AtlasGenerator>
+typename ConcurrentDynamicAtlas<AtlasGenerator>::Slot * ConcurrentDynamicAtlas<AtlasGenerator>::findSlot(unsigned long long key) {
+    if (key == INVALID_KEY)
+        return nullptr;
+    size_t mask = slots.size()-1;
+    for (size_t i = hashKey(key)&mask, n = 0; n < slots.size(); i = (i+1)&mask, ++n) {
+        unsigned long long current = slots[i].key.load(std::memory_order_acquire);
+        if (current == key)
+            return &slots[i];
+        if (current == INVALID_KEY)
+            break;
+    }
+    return nullptr;
+}
+
+template <class AtlasGenerator>
+void ConcurrentDynamicAtlas<AtlasGenerator>::publish(int index) {
+    int x, y;
+    if (atlas.getBoxPosition(index, x, y))
+        glyphSlots[index]->placement.store(encodePlacement(index, x, y), std::memory_order_release);
+}
+
+template <class AtlasGenerator>
+void ConcurrentDynamicAtlas<AtlasGenerator>::unpublish(int index) {
+    Slot *slot = glyphSlots[index];
+    if (!slot)
+        return;
+    slot->placement.store(0, std::memory_order_release);
+    slot->used.store(false, std::memory_order_relaxed);
+    slot->glyph = -1;
+    slot->state.store(SLOT_ABSENT, std::memory_order_release);
+    glyphSlots[index] = nullptr;
+}
+
+template <class AtlasGenerator>
+unsigned long long ConcurrentDynamicAtlas<AtlasGenerator>::hashKey(unsigned long long key) {
+    key ^= key>>30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key>>27;
+    key *= 0x94d049bb133111ebull;
+    return key^key>>31;
+}
+
+template <class AtlasGenerator>
+unsigned long long ConcurrentDynamicAtlas<AtlasGenerator>::encodePlacement(int index, int x, int y) {
+    // The box position is stored in the lower 32 bits and the glyph index + 1 in the upper 32 bits, so that 0 means no placement
+    return (unsigned long long) (index+1)<<32|(unsigned long long) x<<16|(unsigned long long) y;
+}
+
+}
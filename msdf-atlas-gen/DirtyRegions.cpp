@@ -0,0 +1,78 @@
+
+#include "DirtyRegions.h"
+
+#include <algorithm>
+
+namespace msdf_atlas {
+
+static Rectangle boundingRect(const Rectangle &a, const Rectangle &b) {
+    int l = std::min(a.x, b.x), bottom = std::min(a.y, b.y);
+    int r = std::max(a.x+a.w, b.x+b.w), t = std::max(a.y+a.h, b.y+b.h);
+    return Rectangle { l, bottom, r-l, t-bottom };
+}
+
+static bool touching(const Rectangle &a, const Rectangle &b) {
+    return a.x <= b.x+b.w && b.x <= a.x+a.w && a.y <= b.y+b.h && b.y <= a.y+a.h;
+}
+
+DirtyRegions::DirtyRegions() : maxRegions(MSDF_ATLAS_DEFAULT_MAX_DIRTY_REGIONS) { }
+
+DirtyRegions::DirtyRegions(int maxRegions) : maxRegions(std::max(maxRegions, 1)) { }
+
+void DirtyRegions::add(const Rectangle &rect) {
+    if (rect.w <= 0 || rect.h <= 0)
+        return;
+    Rectangle region = rect;
+    // Absorb touching regions until none is left, the result may touch further ones
+    for (size_t i = 0; i < regions.size();) {
+        if (touching(region, regions[i])) {
+            region = boundingRect(region, regions[i]);
+            regions[i] = regions.back();
+            regions.pop_back();
+            i = 0;
+        } else
+            ++i;
+    }
+    regions.push_back(region);
+    if ((int) regions.size() > maxRegions) {
+        size_t bestA = 0, bestB = 1;
+        long long bestWaste = -1;
+        for (size_t a = 0; a < regions.size(); ++a) {
+            for (size_t b = a+1; b < regions.size(); ++b) {
+                Rectangle merged = boundingRect(regions[a], regions[b]);
+                long long waste = (long long) merged.w*merged.h-(long long) regions[a].w*regions[a].h-(long long) regions[b].w*regions[b].h;
+                if (bestWaste < 0 || waste < bestWaste) {
+                    bestA = a, bestB = b;
+                    bestWaste = waste;
+                }
+            }
+        }
+        // The merged region may touch other ones, so it is added again
+        Rectangle merged = boundingRect(regions[bestA], regions[bestB]);
+        regions[bestB] = regions.back();
+        regions.pop_back();
+        regions[bestA] = regions.back();
+        regions.pop_back();
+        add(merged);
+    }
+}
+
+void DirtyRegions::addAll(int width, int height) {
+    regions.clear();
+    if (width > 0 && height > 0)
+        regions.push_back(Rectangle { 0, 0, width, height });
+}
+
+const std::vector<Rectangle> & DirtyRegions::getRegions() const {
+    return regions;
+}
+
+bool DirtyRegions::empty() const {
+    return regions.empty();
+}
+
+void DirtyRegions::clear() {
+    regions.clear();
+}
+
+}
@@ -0,0 +1,37 @@
+
+#pragma once
+
+#include <vector>
+#include "Rectangle.h"
+
+#define MSDF_ATLAS_DEFAULT_MAX_DIRTY_REGIONS 8
+
+namespace msdf_atlas {
+
+/**
+ * Accumulates the regions of an atlas modified since they were last cleared, e.g. to upload only those parts of a texture.
+ * Overlapping and adjacent regions are joined, and if there are more than the maximum number,
+ * the two whose bounding rectangle adds the least unmodified area are merged.
+ */
+class DirtyRegions {
+
+public:
+    DirtyRegions();
+    explicit DirtyRegions(int maxRegions);
+    /// Marks a rectangle as modified
+    void add(const Rectangle &rect);
+    /// Marks the entire atlas of the given dimensions as modified
+    void addAll(int width, int height);
+    /// Returns the modified regions
+    const std::vector<Rectangle> & getRegions() const;
+    /// Returns true if nothing has been modified
+    bool empty() const;
+    void clear();
+
+private:
+    std::vector<Rectangle> regions;
+    int maxRegions;
+
+};
+
+}
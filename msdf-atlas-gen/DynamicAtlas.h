@@ -1,16 +1,27 @@
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include "RectanglePacker.h"
 #include "AtlasGenerator.h"
 
+#define DYNAMIC_ATLAS_FILE_MAGIC 0x5944534du // "MSDY"
+#define DYNAMIC_ATLAS_FILE_VERSION 2u
+/// Marks whitespace glyphs, which take no space in the atlas, in place of a slot
+#define DYNAMIC_ATLAS_WHITESPACE_SLOT (-2)
+
 namespace msdf_atlas {
 
 /**
  * This class can be used to produce a dynamic atlas to which more glyphs are added over time.
- * It takes care of laying out and enlarging the atlas as necessary and delegates the actual work
+ * It takes care of laying out and enlarging the atlas as necessary (existing glyphs stay in place) and delegates the actual work
  * to the specified AtlasGenerator, which may e.g. do the work asynchronously.
+ * Glyphs are identified by indices assigned in the order in which they are added, starting with 0.
+ * If the maximum side length is set, least recently used glyphs are evicted to make space for new ones.
+ * Glyphs added with a priority are only placed, and their generation is deferred to generatePending,
+ * which processes them in order of priority within a given work budget (e.g. once per frame).
+ * The atlas may be saved into a file and loaded in a later session, so that its glyphs need not be generated again.
  */
 template <class AtlasGenerator>
 class DynamicAtlas {
@@ -20,21 +31,105 @@ public:
     /// Creates with a configured generator. The generator must not contain any prior glyphs!
     explicit DynamicAtlas(AtlasGenerator &&generator);
     /// Adds a batch of glyphs. Adding more than one glyph at a time may improve packing efficiency
-    void add(GlyphGeometry *glyphs, int count);
+    /// Returns the number of glyphs that could not be placed even after evicting all other glyphs (0 on success)
+    int add(GlyphGeometry *glyphs, int count);
+    /// Adds a batch of glyphs like the above, but only places them and queues them for generation by generatePending.
+    /// Glyphs with higher priority are generated first, equal priorities in the order in which they were added
+    int add(GlyphGeometry *glyphs, int count, int priority);
+    /// Passes queued glyphs to the generator in order of priority until the work budget (total box area in pixels) is spent.
+    /// At least one glyph is generated if the budget is positive, and any overspending is deducted from the next call's budget.
+    /// Returns the number of glyphs generated, the remaining ones stay queued
+    int generatePending(int workBudget);
+    /// Changes the priority of a queued glyph, e.g. when a prefetched glyph becomes visible
+    void setPriority(int index, int priority);
+    /// Returns true if the glyph is placed in the atlas and has been passed to the generator (it may still be in progress if it works asynchronously).
+    /// Whitespace glyphs have nothing to generate and are ready as soon as they are added
+    bool isReady(int index) const;
+    /// Returns the indices of glyphs generated by the last call to generatePending, including whitespace glyphs queued before it
+    const std::vector<int> & getReadyGlyphs() const;
+    /// Removes a glyph from the atlas and frees its space, returns false if it is not in the atlas
+    bool remove(int index);
+    /// Marks a glyph as used, which postpones its eviction
+    void touch(int index);
+    /// Returns true if the glyph is currently placed in the atlas
+    bool contains(int index) const;
+    /// Outputs the current position of the glyph's box, which changes when the atlas is rearranged. Returns false if the glyph is not in the atlas
+    bool getBoxPosition(int index, int &x, int &y) const;
+    /// Limits the side length of the atlas, 0 means unlimited
+    void setMaxSide(int maxSide);
+    /// Returns the indices of glyphs evicted by the last call to add - their pixels may have been overwritten
+    const std::vector<int> & getEvictedGlyphs() const;
+    /// Packs all glyphs again from scratch, which may use the space better than the incremental layout, but moves every glyph
+    /// and rearranges the whole atlas. Returns false and keeps the current layout if the glyphs do not fit this way
+    bool repack();
+    /// Defragments the atlas gradually by moving at most maxMoves glyphs from the top of the atlas into free gaps below them,
+    /// so that the free space at the top becomes contiguous. Intended to be called repeatedly, e.g. once per frame.
+    /// Requires the generator's move operation. Returns the number of glyphs moved
+    int compact(int maxMoves);
+    /// Returns the indices of glyphs moved by the last call to compact
+    const std::vector<int> & getMovedGlyphs() const;
+    /// Saves the layout and the pixels of the atlas into a binary file. Requires the atlas storage's save operation.
+    /// Glyphs queued by add with priority have no pixels yet and are not saved
+    bool save(const char *filename) const;
+    /// Restores an atlas saved by save, with the glyphs under the same indices. Must be called before any glyphs are added.
+    /// Requires the generator's restore and the atlas storage's load, getWidth and getHeight. Returns false and keeps the atlas unchanged if the file is invalid
+    bool load(const char *filename);
     /// Allows access to generator. Do not add glyphs to the generator directly!
     AtlasGenerator & atlasGenerator();
     const AtlasGenerator & atlasGenerator() const;
 
 private:
+    struct PendingGlyph {
+        int index;
+        int priority;
+        GlyphGeometry glyph;
+    };
+
+    // Layout of the file written by save, in native byte order: FileHeader, FileSlot[slotCount],
+    // the packer's free spaces - Rectangle[spaceCount], the indices of whitespace glyphs - int32_t[whitespaceCount],
+    // and the atlas storage's data. All records are 4-byte aligned
+    struct FileHeader {
+        uint32_t magic, version;
+        int32_t side;
+        int32_t glyphCount, slotCount, spaceCount, whitespaceCount;
+        uint32_t useCounterLow, useCounterHigh;
+    };
+
+    struct FileSlot {
+        int32_t x, y, w, h;
+        int32_t boxWidth, boxHeight;
+        int32_t glyph;
+        uint32_t lastUseLow, lastUseHigh;
+    };
+
     AtlasGenerator generator;
     RectanglePacker packer;
     int glyphCount;
+    int generatedCount;
     int side;
+    int maxSide;
+    // Slots of glyphs placed in the atlas - remapBuffer[slot].index is the glyph's index in the generator, or -1 if it is still queued
     std::vector<Rectangle> rectangles;
     std::vector<Remap> remapBuffer;
+    std::vector<int> slotGlyphs;
+    std::vector<unsigned long long> slotLastUse;
+    // Slot of each glyph, -1 if it is not in the atlas, or DYNAMIC_ATLAS_WHITESPACE_SLOT
+    std::vector<int> glyphSlots;
+    std::vector<int> evictedGlyphs;
+    std::vector<int> movedGlyphs;
+    std::vector<PendingGlyph> pendingGlyphs;
+    std::vector<int> readyGlyphs;
+    // Whitespace glyphs added with a priority, reported by the next call to generatePending
+    std::vector<int> queuedWhitespace;
+    unsigned long long useCounter;
     int totalArea;
-    GeneratorAttributes genAttribs;
     int padding;
+    int workBalance;
+
+    int place(GlyphGeometry *glyphs, int count);
+    int evict(int requiredArea, int protectedStart);
+    int packPending(int start);
+    void eraseSlots(const std::vector<bool> &erased);
 
 };
 
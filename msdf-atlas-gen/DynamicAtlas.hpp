@@ -1,69 +1,520 @@
 
 #include "DynamicAtlas.h"
 
+#include <cstdio>
+#include <algorithm>
+#include <type_traits>
+
 namespace msdf_atlas {
 
 template <class AtlasGenerator>
-DynamicAtlas<AtlasGenerator>::DynamicAtlas() : glyphCount(0), side(0), totalArea(0), padding(0) { }
+DynamicAtlas<AtlasGenerator>::DynamicAtlas() : glyphCount(0), generatedCount(0), side(0), maxSide(0), useCounter(0), totalArea(0), padding(0), workBalance(0) { }
+
+template <class AtlasGenerator>
+DynamicAtlas<AtlasGenerator>::DynamicAtlas(AtlasGenerator &&generator) : generator((AtlasGenerator &&) generator), glyphCount(0), generatedCount(0), side(0), maxSide(0), useCounter(0), totalArea(0), padding(0), workBalance(0) { }
+
+template <class AtlasGenerator>
+int DynamicAtlas<AtlasGenerator>::add(GlyphGeometry *glyphs, int count) {
+    int unplaced = place(glyphs, count);
+    // Glyphs are passed to the generator in contiguous runs of placed glyphs so that unplaced ones are skipped
+    int runStart = 0;
+    for (int i = 0; i <= count; ++i) {
+        int slot = i < count ? glyphSlots[glyphCount+i] : -1;
+        if (i < count && (slot >= 0 || glyphs[i].isWhitespace())) {
+            if (slot >= 0) {
+                remapBuffer[slot].index = generatedCount+i-runStart;
+                glyphs[i].placeBox(rectangles[slot].x, rectangles[slot].y);
+            }
+            continue;
+        }
+        if (i > runStart) {
+            generator.generate(glyphs+runStart, i-runStart);
+            generatedCount += i-runStart;
+        }
+        runStart = i+1;
+    }
+    glyphCount += count;
+    return unplaced;
+}
+
+template <class AtlasGenerator>
+int DynamicAtlas<AtlasGenerator>::add(GlyphGeometry *glyphs, int count, int priority) {
+    int unplaced = place(glyphs, count);
+    for (int i = 0; i < count; ++i) {
+        int slot = glyphSlots[glyphCount+i];
+        if (slot >= 0) {
+            remapBuffer[slot].index = -1;
+            glyphs[i].placeBox(rectangles[slot].x, rectangles[slot].y);
+            PendingGlyph pending = { glyphCount+i, priority, glyphs[i] };
+            pendingGlyphs.push_back((PendingGlyph &&) pending);
+        } else if (slot == DYNAMIC_ATLAS_WHITESPACE_SLOT)
+            queuedWhitespace.push_back(glyphCount+i);
+    }
+    glyphCount += count;
+    return unplaced;
+}
+
+template <class AtlasGenerator>
+int DynamicAtlas<AtlasGenerator>::generatePending(int workBudget) {
+    readyGlyphs.swap(queuedWhitespace);
+    queuedWhitespace.clear();
+    // Drop glyphs that have been removed or evicted in the meantime
+    pendingGlyphs.erase(std::remove_if(pendingGlyphs.begin(), pendingGlyphs.end(), [this](const PendingGlyph &pending) {
+        return !contains(pending.index);
+    }), pendingGlyphs.end());
+    if (pendingGlyphs.empty()) {
+        workBalance = 0;
+        return 0;
+    }
+    std::stable_sort(pendingGlyphs.begin(), pendingGlyphs.end(), [](const PendingGlyph &a, const PendingGlyph &b) {
+        return a.priority > b.priority;
+    });
+    workBalance = std::min(workBalance, 0)+workBudget;
+    std::vector<GlyphGeometry> batch;
+    int taken = 0;
+    for (; taken < (int) pendingGlyphs.size() && workBalance > 0; ++taken) {
+        PendingGlyph &pending = pendingGlyphs[taken];
+        int slot = glyphSlots[pending.index];
+        Remap &remap = remapBuffer[slot];
+        // The glyph may have been moved since it was added
+        pending.glyph.placeBox(rectangles[slot].x, rectangles[slot].y);
+        remap.index = generatedCount+taken;
+        workBalance -= remap.width*remap.height;
+        batch.push_back((GlyphGeometry &&) pending.glyph);
+        readyGlyphs.push_back(pending.index);
+    }
+    pendingGlyphs.erase(pendingGlyphs.begin(), pendingGlyphs.begin()+taken);
+    if (pendingGlyphs.empty())
+        workBalance = std::min(workBalance, 0);
+    if (taken) {
+        generator.generate(batch.data(), taken);
+        generatedCount += taken;
+    }
+    return taken;
+}
+
+template <class AtlasGenerator>
+void DynamicAtlas<AtlasGenerator>::setPriority(int index, int priority) {
+    for (PendingGlyph &pending : pendingGlyphs) {
+        if (pending.index == index)
+            pending.priority = priority;
+    }
+}
+
+template <class AtlasGenerator>
+bool DynamicAtlas<AtlasGenerator>::isReady(int index) const {
+    if (!(index >= 0 && index < (int) glyphSlots.size()))
+        return false;
+    int slot = glyphSlots[index];
+    return slot == DYNAMIC_ATLAS_WHITESPACE_SLOT || (slot >= 0 && remapBuffer[slot].index >= 0);
+}
+
+template <class AtlasGenerator>
+const std::vector<int> & DynamicAtlas<AtlasGenerator>::getReadyGlyphs() const {
+    return readyGlyphs;
+}
+
+template <class AtlasGenerator>
+bool DynamicAtlas<AtlasGenerator>::remove(int index) {
+    if (!contains(index))
+        return false;
+    int slot = glyphSlots[index], last = rectangles.size()-1;
+    packer.release(rectangles[slot]);
+    totalArea -= rectangles[slot].w*rectangles[slot].h;
+    glyphSlots[index] = -1;
+    if (remapBuffer[slot].index >= 0)
+        generator.discard(remapBuffer[slot].index);
+    if (slot != last) {
+        rectangles[slot] = rectangles[last];
+        remapBuffer[slot] = remapBuffer[last];
+        slotGlyphs[slot] = slotGlyphs[last];
+        slotLastUse[slot] = slotLastUse[last];
+        glyphSlots[slotGlyphs[slot]] = slot;
+    }
+    rectangles.pop_back();
+    remapBuffer.pop_back();
+    slotGlyphs.pop_back();
+    slotLastUse.pop_back();
+    return true;
+}
+
+template <class AtlasGenerator>
+void DynamicAtlas<AtlasGenerator>::touch(int index) {
+    if (contains(index))
+        slotLastUse[glyphSlots[index]] = ++useCounter;
+}
+
+template <class AtlasGenerator>
+bool DynamicAtlas<AtlasGenerator>::contains(int index) const {
+    return index >= 0 && index < (int) glyphSlots.size() && glyphSlots[index] >= 0;
+}
+
+template <class AtlasGenerator>
+bool DynamicAtlas<AtlasGenerator>::getBoxPosition(int index, int &x, int &y) const {
+    if (!contains(index))
+        return false;
+    x = rectangles[glyphSlots[index]].x;
+    y = rectangles[glyphSlots[index]].y;
+    return true;
+}
+
+template <class AtlasGenerator>
+void DynamicAtlas<AtlasGenerator>::setMaxSide(int maxSide) {
+    this->maxSide = maxSide;
+}
+
+template <class AtlasGenerator>
+const std::vector<int> & DynamicAtlas<AtlasGenerator>::getEvictedGlyphs() const {
+    return evictedGlyphs;
+}
+
+template <class AtlasGenerator>
+bool DynamicAtlas<AtlasGenerator>::repack() {
+    std::vector<Rectangle> layout(rectangles);
+    RectanglePacker newPacker(side+padding, side+padding);
+    if (newPacker.pack(layout.data(), layout.size()) > 0)
+        return false;
+    // Queued glyphs have no pixels yet, so they are left out of the remapping
+    std::vector<Remap> remapping;
+    remapping.reserve(remapBuffer.size());
+    for (int i = 0; i < (int) rectangles.size(); ++i) {
+        Remap &remap = remapBuffer[i];
+        remap.source = remap.target;
+        remap.target.x = layout[i].x;
+        remap.target.y = layout[i].y;
+        rectangles[i] = layout[i];
+        if (remap.index >= 0)
+            remapping.push_back(remap);
+    }
+    packer = (RectanglePacker &&) newPacker;
+    generator.rearrange(side, side, remapping.data(), remapping.size());
+    return true;
+}
+
+template <class AtlasGenerator>
+int DynamicAtlas<AtlasGenerator>::compact(int maxMoves) {
+    movedGlyphs.clear();
+    if (maxMoves <= 0 || rectangles.empty())
+        return 0;
+    // Start from an unfragmented free space, and try the glyphs from the top of the atlas downwards
+    packer = RectanglePacker(side+padding, side+padding, rectangles.data(), rectangles.size());
+    std::vector<int> candidates(rectangles.size());
+    for (int i = 0; i < (int) candidates.size(); ++i)
+        candidates[i] = i;
+    std::sort(candidates.begin(), candidates.end(), [this](int a, int b) {
+        return rectangles[a].y+rectangles[a].h > rectangles[b].y+rectangles[b].h;
+    });
+    std::vector<Remap> moves;
+    for (int slot : candidates) {
+        if ((int) movedGlyphs.size() >= maxMoves)
+            break;
+        Rectangle rect = rectangles[slot];
+        if (!packer.packBelow(rectangles[slot], rect.y))
+            continue;
+        packer.release(rect);
+        Remap &remap = remapBuffer[slot];
+        remap.source = remap.target;
+        remap.target.x = rectangles[slot].x;
+        remap.target.y = rectangles[slot].y;
+        if (remap.index >= 0)
+            moves.push_back(remap);
+        movedGlyphs.push_back(slotGlyphs[slot]);
+    }
+    if (!moves.empty())
+        generator.move(moves.data(), moves.size());
+    return movedGlyphs.size();
+}
+
+template <class AtlasGenerator>
+const std::vector<int> & DynamicAtlas<AtlasGenerator>::getMovedGlyphs() const {
+    return movedGlyphs;
+}
+
+template <class AtlasGenerator>
+bool DynamicAtlas<AtlasGenerator>::save(const char *filename) const {
+    std::vector<FileSlot> fileSlots;
+    std::vector<Rectangle> occupied;
+    for (int i = 0; i < (int) rectangles.size(); ++i) {
+        if (remapBuffer[i].index < 0)
+            continue;
+        const Rectangle &rect = rectangles[i];
+        FileSlot fileSlot = { rect.x, rect.y, rect.w, rect.h, remapBuffer[i].width, remapBuffer[i].height, slotGlyphs[i], uint32_t(slotLastUse[i]), uint32_t(slotLastUse[i]>>32) };
+        fileSlots.push_back(fileSlot);
+        occupied.push_back(rect);
+    }
+    // The space of queued glyphs, which are left out, is saved as free
+    RectanglePacker freeSpace;
+    if (occupied.size() < rectangles.size())
+        freeSpace = RectanglePacker(side+padding, side+padding, occupied.data(), occupied.size());
+    const std::vector<Rectangle> &spaces = occupied.size() < rectangles.size() ? freeSpace.getFreeSpaces() : packer.getFreeSpaces();
+    std::vector<int32_t> whitespace;
+    for (int i = 0; i < glyphCount; ++i) {
+        if (glyphSlots[i] == DYNAMIC_ATLAS_WHITESPACE_SLOT)
+            whitespace.push_back(i);
+    }
+    FileHeader header = { DYNAMIC_ATLAS_FILE_MAGIC, DYNAMIC_ATLAS_FILE_VERSION, side, glyphCount, int32_t(fileSlots.size()), int32_t(spaces.size()), int32_t(whitespace.size()), uint32_t(useCounter), uint32_t(useCounter>>32) };
+
+    FILE *file = fopen(filename, "wb");
+    if (!file)
+        return false;
+    bool success = (
+        fwrite(&header, sizeof(header), 1, file) == 1 &&
+        (fileSlots.empty() || fwrite(fileSlots.data(), sizeof(FileSlot), fileSlots.size(), file) == fileSlots.size()) &&
+        (spaces.empty() || fwrite(spaces.data(), sizeof(Rectangle), spaces.size(), file) == spaces.size()) &&
+        (whitespace.empty() || fwrite(whitespace.data(), sizeof(int32_t), whitespace.size(), file) == whitespace.size()) &&
+        generator.atlasStorage().save(file)
+    );
+    if (fclose(file))
+        success = false;
+    return success;
+}
 
 template <class AtlasGenerator>
-DynamicAtlas<AtlasGenerator>::DynamicAtlas(AtlasGenerator &&generator) : generator((AtlasGenerator &&) generator), glyphCount(0), side(0), totalArea(0), padding(0) { }
+bool DynamicAtlas<AtlasGenerator>::load(const char *filename) {
+    typedef typename std::decay<decltype(generator.atlasStorage())>::type AtlasStorage;
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+        return false;
+    FileHeader header;
+    std::vector<FileSlot> fileSlots;
+    std::vector<Rectangle> spaces;
+    std::vector<int32_t> whitespace;
+    AtlasStorage storage;
+    bool success = (
+        fread(&header, sizeof(header), 1, file) == 1 &&
+        header.magic == DYNAMIC_ATLAS_FILE_MAGIC && header.version == DYNAMIC_ATLAS_FILE_VERSION &&
+        header.side >= 0 && header.glyphCount >= 0 && header.slotCount >= 0 && header.slotCount <= header.glyphCount && header.spaceCount >= 0 &&
+        header.whitespaceCount >= 0 && header.whitespaceCount <= header.glyphCount-header.slotCount
+    );
+    if (success) {
+        fileSlots.resize(header.slotCount);
+        spaces.resize(header.spaceCount);
+        whitespace.resize(header.whitespaceCount);
+        success = (
+            (fileSlots.empty() || fread(fileSlots.data(), sizeof(FileSlot), fileSlots.size(), file) == fileSlots.size()) &&
+            (spaces.empty() || fread(spaces.data(), sizeof(Rectangle), spaces.size(), file) == spaces.size()) &&
+            (whitespace.empty() || fread(whitespace.data(), sizeof(int32_t), whitespace.size(), file) == whitespace.size()) &&
+            storage.load(file)
+        );
+    }
+    fclose(file);
+    // The file is fully validated before any state is changed, so that glyphs are never placed outside the atlas or over each other
+    success = success && storage.getWidth() == header.side && storage.getHeight() == header.side;
+    int limit = header.side+padding;
+    std::vector<int> newGlyphSlots(success ? header.glyphCount : 0, -1);
+    std::vector<Rectangle> occupied;
+    for (int i = 0; success && i < (int) fileSlots.size(); ++i) {
+        const FileSlot &fileSlot = fileSlots[i];
+        success = (
+            fileSlot.glyph >= 0 && fileSlot.glyph < header.glyphCount && newGlyphSlots[fileSlot.glyph] < 0 &&
+            fileSlot.boxWidth >= 0 && fileSlot.boxHeight >= 0 && fileSlot.w >= fileSlot.boxWidth && fileSlot.h >= fileSlot.boxHeight &&
+            fileSlot.x >= 0 && fileSlot.y >= 0 && fileSlot.w <= limit && fileSlot.h <= limit && fileSlot.x <= limit-fileSlot.w && fileSlot.y <= limit-fileSlot.h
+        );
+        if (success) {
+            newGlyphSlots[fileSlot.glyph] = i;
+            occupied.push_back(Rectangle { fileSlot.x, fileSlot.y, fileSlot.w, fileSlot.h });
+        }
+    }
+    for (int i = 0; success && i < (int) whitespace.size(); ++i) {
+        success = whitespace[i] >= 0 && whitespace[i] < header.glyphCount && newGlyphSlots[whitespace[i]] == -1;
+        if (success)
+            newGlyphSlots[whitespace[i]] = DYNAMIC_ATLAS_WHITESPACE_SLOT;
+    }
+    for (int i = 0; success && i < (int) spaces.size(); ++i) {
+        const Rectangle &space = spaces[i];
+        success = space.x >= 0 && space.y >= 0 && space.w > 0 && space.h > 0 && space.w <= limit && space.h <= limit && space.x <= limit-space.w && space.y <= limit-space.h;
+        occupied.push_back(space);
+    }
+    if (!(success && !RectanglePacker::anyOverlap(occupied.data(), occupied.size())))
+        return false;
+
+    // Glyphs are registered with the generator under the indices of their slots
+    side = header.side;
+    glyphCount = header.glyphCount;
+    generatedCount = header.slotCount;
+    useCounter = (unsigned long long) header.useCounterHigh<<32|header.useCounterLow;
+    totalArea = 0;
+    rectangles.resize(fileSlots.size());
+    remapBuffer.resize(fileSlots.size());
+    slotGlyphs.resize(fileSlots.size());
+    slotLastUse.resize(fileSlots.size());
+    for (int i = 0; i < (int) fileSlots.size(); ++i) {
+        const FileSlot &fileSlot = fileSlots[i];
+        Rectangle rect = { fileSlot.x, fileSlot.y, fileSlot.w, fileSlot.h };
+        rectangles[i] = rect;
+        Remap remap = { };
+        remap.index = i;
+        remap.source.x = remap.target.x = fileSlot.x;
+        remap.source.y = remap.target.y = fileSlot.y;
+        remap.width = fileSlot.boxWidth;
+        remap.height = fileSlot.boxHeight;
+        remapBuffer[i] = remap;
+        slotGlyphs[i] = fileSlot.glyph;
+        slotLastUse[i] = (unsigned long long) fileSlot.lastUseHigh<<32|fileSlot.lastUseLow;
+        totalArea += rect.w*rect.h;
+    }
+    glyphSlots.swap(newGlyphSlots);
+    evictedGlyphs.clear();
+    movedGlyphs.clear();
+    pendingGlyphs.clear();
+    readyGlyphs.clear();
+    queuedWhitespace.clear();
+    workBalance = 0;
+    packer = RectanglePacker(side+padding, side+padding);
+    packer.setFreeSpaces(spaces.data(), spaces.size());
+    generator.restore(side, side, (AtlasStorage &&) storage, remapBuffer.data(), remapBuffer.size());
+    return true;
+}
 
 template <class AtlasGenerator>
-void DynamicAtlas<AtlasGenerator>::add(GlyphGeometry *glyphs, int count) {
+AtlasGenerator & DynamicAtlas<AtlasGenerator>::atlasGenerator() {
+    return generator;
+}
+
+template <class AtlasGenerator>
+const AtlasGenerator & DynamicAtlas<AtlasGenerator>::atlasGenerator() const {
+    return generator;
+}
+
+template <class AtlasGenerator>
+int DynamicAtlas<AtlasGenerator>::place(GlyphGeometry *glyphs, int count) {
+    evictedGlyphs.clear();
+    ++useCounter;
     int start = rectangles.size();
+    glyphSlots.resize(glyphCount+count, -1);
     for (int i = 0; i < count; ++i) {
-        if (!glyphs[i].isWhitespace()) {
+        if (glyphs[i].isWhitespace())
+            glyphSlots[glyphCount+i] = DYNAMIC_ATLAS_WHITESPACE_SLOT;
+        else {
             int w, h;
             glyphs[i].getBoxSize(w, h);
-            Rectangle rect = { 0, 0, w+padding, h+padding };
+            Rectangle rect = { -1, -1, w+padding, h+padding };
+            glyphSlots[glyphCount+i] = rectangles.size();
             rectangles.push_back(rect);
             Remap remapEntry = { };
-            remapEntry.index = glyphCount+i;
             remapEntry.width = w;
             remapEntry.height = h;
             remapBuffer.push_back(remapEntry);
+            slotGlyphs.push_back(glyphCount+i);
+            slotLastUse.push_back(useCounter);
             totalArea += (w+padding)*(h+padding);
         }
     }
+    int unplaced = 0;
     if ((int) rectangles.size() > start) {
         int oldSide = side;
-        int packerStart = start;
-        while (packer.pack(rectangles.data()+packerStart, rectangles.size()-packerStart) > 0) {
-            side = side+!side<<1;
-            while (side*side < totalArea)
-                side <<= 1;
-            packer = RectanglePacker(side+padding, side+padding);
-            packerStart = 0;
+        bool full = false;
+        unplaced = packer.pack(rectangles.data()+start, rectangles.size()-start);
+        while (unplaced > 0) {
+            if (!maxSide || side < maxSide) {
+                // Enlarge the atlas, keeping the existing glyphs in place
+                side = side+!side<<1;
+                while (side*side < totalArea)
+                    side <<= 1;
+                if (maxSide)
+                    side = std::min(side, maxSide);
+                packer.expand(side+padding, side+padding);
+            } else {
+                // The atlas is full - evict least recently used glyphs until the new ones may fit.
+                // These have not been generated yet, so all of them can be packed again together
+                int requiredArea = 0;
+                for (int i = start; i < (int) rectangles.size(); ++i) {
+                    rectangles[i].x = -1, rectangles[i].y = -1;
+                    requiredArea += rectangles[i].w*rectangles[i].h;
+                }
+                // The first attempt only reclaims fragmented free space, without evicting any glyphs
+                if (full) {
+                    int evicted = evict(requiredArea, start);
+                    if (!evicted)
+                        break;
+                    start -= evicted;
+                }
+                full = true;
+                packer = RectanglePacker(side+padding, side+padding, rectangles.data(), start);
+            }
+            unplaced = packPending(start);
         }
-        if (packerStart < start) {
-            for (int i = 0; i < start; ++i) {
-                Remap &remap = remapBuffer[i];
-                remap.source = remap.target;
-                remap.target.x = rectangles[i].x;
-                remap.target.y = rectangles[i].y;
+        if (unplaced > 0) {
+            // Glyphs that could not fit even into an otherwise empty atlas are not added
+            std::vector<bool> erased(rectangles.size(), false);
+            for (int i = start; i < (int) rectangles.size(); ++i) {
+                if (rectangles[i].x < 0) {
+                    erased[i] = true;
+                    totalArea -= rectangles[i].w*rectangles[i].h;
+                    glyphSlots[slotGlyphs[i]] = -1;
+                }
             }
-            generator.rearrange(side, side, remapBuffer.data(), start);
-        } else if (side != oldSide)
+            eraseSlots(erased);
+        }
+        if (side != oldSide)
             generator.resize(side, side);
         for (int i = start; i < (int) rectangles.size(); ++i) {
             remapBuffer[i].target.x = rectangles[i].x;
             remapBuffer[i].target.y = rectangles[i].y;
-            glyphs[remapBuffer[i].index-glyphCount].placeBox(rectangles[i].x, rectangles[i].y);
         }
     }
-    generator.generate(glyphs, count, genAttribs);
-    glyphCount += count;
+    return unplaced;
 }
 
 template <class AtlasGenerator>
-AtlasGenerator & DynamicAtlas<AtlasGenerator>::atlasGenerator() {
-    return generator;
+int DynamicAtlas<AtlasGenerator>::evict(int requiredArea, int protectedStart) {
+    std::vector<int> candidates(protectedStart);
+    for (int i = 0; i < protectedStart; ++i)
+        candidates[i] = i;
+    std::sort(candidates.begin(), candidates.end(), [this](int a, int b) {
+        return slotLastUse[a] < slotLastUse[b];
+    });
+    std::vector<bool> erased(rectangles.size(), false);
+    int evicted = 0, freedArea = 0;
+    for (int slot : candidates) {
+        if (freedArea >= requiredArea)
+            break;
+        freedArea += rectangles[slot].w*rectangles[slot].h;
+        totalArea -= rectangles[slot].w*rectangles[slot].h;
+        glyphSlots[slotGlyphs[slot]] = -1;
+        evictedGlyphs.push_back(slotGlyphs[slot]);
+        if (remapBuffer[slot].index >= 0)
+            generator.discard(remapBuffer[slot].index);
+        erased[slot] = true, ++evicted;
+    }
+    eraseSlots(erased);
+    return evicted;
 }
 
 template <class AtlasGenerator>
-const AtlasGenerator & DynamicAtlas<AtlasGenerator>::atlasGenerator() const {
-    return generator;
+int DynamicAtlas<AtlasGenerator>::packPending(int start) {
+    std::vector<Rectangle> pending;
+    std::vector<int> pendingSlots;
+    for (int i = start; i < (int) rectangles.size(); ++i) {
+        if (rectangles[i].x < 0) {
+            pending.push_back(rectangles[i]);
+            pendingSlots.push_back(i);
+        }
+    }
+    int unplaced = packer.pack(pending.data(), pending.size());
+    for (size_t i = 0; i < pending.size(); ++i)
+        rectangles[pendingSlots[i]] = pending[i];
+    return unplaced;
+}
+
+template <class AtlasGenerator>
+void DynamicAtlas<AtlasGenerator>::eraseSlots(const std::vector<bool> &erased) {
+    // Remaining slots keep their order
+    int j = 0;
+    for (int i = 0; i < (int) rectangles.size(); ++i) {
+        if (!erased[i]) {
+            rectangles[j] = rectangles[i];
+            remapBuffer[j] = remapBuffer[i];
+            slotGlyphs[j] = slotGlyphs[i];
+            slotLastUse[j] = slotLastUse[i];
+            glyphSlots[slotGlyphs[j]] = j;
+            ++j;
+        }
+    }
+    rectangles.resize(j);
+    remapBuffer.resize(j);
+    slotGlyphs.resize(j);
+    slotLastUse.resize(j);
 }
 
 }
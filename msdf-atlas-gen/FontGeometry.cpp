@@ -113,6 +113,20 @@ int FontGeometry::loadKerning(msdfgen::FontHandle *font) {
     return loaded;
 }
 
+int FontGeometry::loadCopy(const FontGeometry &font) {
+    if (!(glyphs->size() == rangeEnd && font.glyphs != glyphs))
+        return -1;
+    geometryScale = font.geometryScale;
+    metrics = font.metrics;
+    preferredIdentifierType = font.preferredIdentifierType;
+    GlyphRange fontGlyphs = font.getGlyphs();
+    glyphs->reserve(glyphs->size()+fontGlyphs.size());
+    for (const GlyphGeometry &glyph : fontGlyphs)
+        addGlyph(glyph);
+    kerning.insert(font.kerning.begin(), font.kerning.end());
+    return (int) fontGlyphs.size();
+}
+
 void FontGeometry::setName(const char *name) {
     if (name)
         this->name = name;
@@ -47,6 +47,8 @@ public:
     bool addGlyph(GlyphGeometry &&glyph);
     /// Loads kerning pairs for all glyphs that are currently present, returns the number of loaded kerning pairs
     int loadKerning(msdfgen::FontHandle *font);
+    /// Copies the metrics, glyphs and kerning pairs of a previously loaded font, returns the number of copied glyphs
+    int loadCopy(const FontGeometry &font);
     /// Sets a name to be associated with the font
     void setName(const char *name);
 
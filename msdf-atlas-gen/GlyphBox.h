@@ -13,6 +13,7 @@ struct GlyphBox {
     struct {
         int x, y, w, h;
     } rect;
+    int channel;
 
 };
 
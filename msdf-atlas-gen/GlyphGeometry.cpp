@@ -47,6 +47,18 @@ bool GlyphGeometry::load(msdfgen::FontHandle *font, double geometryScale, unicod
     return false;
 }
 
+bool GlyphGeometry::reloadShape(msdfgen::FontHandle *font, bool preprocessGeometry) {
+    unicode_t codepoint = this->codepoint;
+    if (!load(font, geometryScale, msdfgen::GlyphIndex(index), preprocessGeometry))
+        return false;
+    this->codepoint = codepoint;
+    return true;
+}
+
+void GlyphGeometry::unloadShape() {
+    std::vector<msdfgen::Contour>().swap(shape.contours);
+}
+
 void GlyphGeometry::edgeColoring(void (*fn)(msdfgen::Shape &, double, unsigned long long), double angleThreshold, unsigned long long seed) {
     fn(shape, angleThreshold, seed);
 }
@@ -78,6 +90,10 @@ void GlyphGeometry::placeBox(int x, int y) {
     box.rect.x = x, box.rect.y = y;
 }
 
+void GlyphGeometry::setBoxChannel(int channel) {
+    box.channel = channel;
+}
+
 int GlyphGeometry::getIndex() const {
     return index;
 }
@@ -117,6 +133,10 @@ void GlyphGeometry::getBoxSize(int &w, int &h) const {
     w = box.rect.w, h = box.rect.h;
 }
 
+int GlyphGeometry::getBoxChannel() const {
+    return box.channel;
+}
+
 double GlyphGeometry::getBoxRange() const {
     return box.range;
 }
@@ -155,7 +175,8 @@ void GlyphGeometry::getQuadAtlasBounds(double &l, double &b, double &r, double &
 }
 
 bool GlyphGeometry::isWhitespace() const {
-    return shape.contours.empty();
+    // An unloaded shape still has its bounds
+    return shape.contours.empty() && !(bounds.l < bounds.r && bounds.b < bounds.t);
 }
 
 GlyphGeometry::operator GlyphBox() const {
@@ -164,6 +185,7 @@ GlyphGeometry::operator GlyphBox() const {
     box.advance = advance;
     getQuadPlaneBounds(box.bounds.l, box.bounds.b, box.bounds.r, box.bounds.t);
     box.rect.x = this->box.rect.x, box.rect.y = this->box.rect.y, box.rect.w = this->box.rect.w, box.rect.h = this->box.rect.h;
+    box.channel = this->box.channel;
     return box;
 }
 
@@ -16,12 +16,18 @@ public:
     /// Loads glyph geometry from font
     bool load(msdfgen::FontHandle *font, double geometryScale, msdfgen::GlyphIndex index, bool preprocessGeometry = true);
     bool load(msdfgen::FontHandle *font, double geometryScale, unicode_t codepoint, bool preprocessGeometry = true);
+    /// Loads the glyph's shape again after it has been unloaded
+    bool reloadShape(msdfgen::FontHandle *font, bool preprocessGeometry = true);
+    /// Frees the glyph's shape, keeping only its bounds, metrics, and box
+    void unloadShape();
     /// Applies edge coloring to glyph shape
     void edgeColoring(void (*fn)(msdfgen::Shape &, double, unsigned long long), double angleThreshold, unsigned long long seed);
     /// Computes the dimensions of the glyph's box as well as the transformation for the generator function
     void wrapBox(double scale, double range, double miterLimit);
     /// Sets the glyph's box's position in the atlas
     void placeBox(int x, int y);
+    /// Sets the atlas channel that holds the glyph's box if single-channel atlases are packed into separate channels of a single texture
+    void setBoxChannel(int channel);
     /// Returns the glyph's index within the font
     int getIndex() const;
     /// Returns the glyph's index as a msdfgen::GlyphIndex
@@ -38,6 +44,8 @@ public:
     void getBoxRect(int &x, int &y, int &w, int &h) const;
     /// Outputs the dimensions of the glyph's box in the atlas
     void getBoxSize(int &w, int &h) const;
+    /// Returns the atlas channel of the glyph's box (0 unless channel-packed)
+    int getBoxChannel() const;
     /// Returns the range needed to generate the glyph's SDF
     double getBoxRange() const;
     /// Returns the projection needed to generate the glyph's bitmap
@@ -66,6 +74,7 @@ private:
         struct {
             int x, y, w, h;
         } rect;
+        int channel;
         double range;
         double scale;
         msdfgen::Vector2 translate;
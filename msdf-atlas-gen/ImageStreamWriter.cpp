@@ -0,0 +1,327 @@
+
+#include "ImageStreamWriter.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#define ADLER32_MODULO 65521u
+#define DEFLATE_WINDOW_SIZE 32768
+#define DEFLATE_MIN_MATCH 3
+#define DEFLATE_MAX_MATCH 258
+#define DEFLATE_HASH_BITS 15
+/// Maximum number of earlier occurrences examined for each match
+#define DEFLATE_MAX_CHAIN 32
+/// Code of the end of block symbol
+#define DEFLATE_END_OF_BLOCK 256
+
+namespace msdf_atlas {
+
+struct Crc32Table {
+    uint32_t values[256];
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = c&1 ? 0xedb88320u^c>>1 : c>>1;
+            values[i] = c;
+        }
+    }
+};
+
+static uint32_t crc32Update(uint32_t crc, const byte *data, size_t length) {
+    // Initialization of a local static is thread-safe, so concurrent jobs (-batch, -serve) may share the table
+    static const Crc32Table table;
+    for (size_t i = 0; i < length; ++i)
+        crc = table.values[(crc^data[i])&0xff]^crc>>8;
+    return crc;
+}
+
+static const uint16_t deflateLengthBases[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const byte deflateLengthExtraBits[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t deflateDistanceBases[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const byte deflateDistanceExtraBits[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+/// Huffman codes are stored starting from their most significant bit
+static uint32_t reverseBits(uint32_t code, int length) {
+    uint32_t result = 0;
+    for (int i = 0; i < length; ++i, code >>= 1)
+        result = result<<1|(code&1);
+    return result;
+}
+
+static uint32_t hashSequence(const byte *data) {
+    return (uint32_t(data[0])|uint32_t(data[1])<<8|uint32_t(data[2])<<16)*2654435761u>>(32-DEFLATE_HASH_BITS);
+}
+
+static int paethPredictor(int a, int b, int c) {
+    int p = a+b-c;
+    int pa = abs(p-a), pb = abs(p-b), pc = abs(p-c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    return pb <= pc ? b : c;
+}
+
+/// Applies a PNG filter type (0 - 4) to a row with bpp bytes per pixel
+static void filterRow(byte *output, const byte *row, const byte *previousRow, size_t rowSize, int bpp, int filterType) {
+    for (size_t i = 0; i < rowSize; ++i) {
+        int a = i >= size_t(bpp) ? row[i-bpp] : 0, b = previousRow[i], c = i >= size_t(bpp) ? previousRow[i-bpp] : 0;
+        int prediction = 0;
+        switch (filterType) {
+            case 1: prediction = a; break;
+            case 2: prediction = b; break;
+            case 3: prediction = (a+b)>>1; break;
+            case 4: prediction = paethPredictor(a, b, c); break;
+        }
+        output[i] = byte(row[i]-prediction);
+    }
+}
+
+static void writeU32BE(byte *output, uint32_t value) {
+    output[0] = byte(value>>24);
+    output[1] = byte(value>>16);
+    output[2] = byte(value>>8);
+    output[3] = byte(value);
+}
+
+bool ImageStreamWriter::supportsFormat(ImageFormat format) {
+    return format == ImageFormat::PNG || format == ImageFormat::BINARY || format == ImageFormat::BINARY_FLOAT || format == ImageFormat::BINARY_FLOAT_BE;
+}
+
+ImageStreamWriter::ImageStreamWriter() : file(nullptr), format(ImageFormat::UNSPECIFIED), width(0), height(0), channels(0), rowsWritten(0), topDown(false), failed(false), adler32A(1), adler32B(0), historyStart(0), historyCursor(0), bitBuffer(0), bitCount(0) { }
+
+ImageStreamWriter::~ImageStreamWriter() {
+    if (file)
+        fclose(file);
+}
+
+bool ImageStreamWriter::open(const char *filename, ImageFormat format, int width, int height, int channels, YDirection outputYDirection) {
+    if (file || !supportsFormat(format) || !(channels == 1 || channels == 3 || channels == 4) || width <= 0 || height <= 0)
+        return false;
+    if (!(file = fopen(filename, "wb")))
+        return false;
+    this->format = format;
+    this->width = width, this->height = height;
+    this->channels = channels;
+    rowsWritten = 0;
+    failed = false;
+    topDown = format == ImageFormat::PNG || outputYDirection == YDirection::TOP_DOWN;
+    if (format == ImageFormat::PNG) {
+        static const byte signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+        byte header[13] = { };
+        writeU32BE(header, uint32_t(width));
+        writeU32BE(header+4, uint32_t(height));
+        header[8] = 8; // bit depth
+        header[9] = channels == 1 ? 0 : channels == 3 ? 2 : 6; // grayscale, RGB, or RGBA
+        failed = fwrite(signature, 1, sizeof(signature), file) != sizeof(signature);
+        writePngChunk("IHDR", header, sizeof(header));
+        // zlib stream header - deflate with a 32 KiB window
+        static const byte zlibHeader[2] = { 0x78, 0x01 };
+        writePngChunk("IDAT", zlibHeader, sizeof(zlibHeader));
+        adler32A = 1, adler32B = 0;
+        previousRow.assign(size_t(channels)*width, byte(0));
+        history.clear();
+        historyStart = 0, historyCursor = 0;
+        hashHeads.assign(size_t(1)<<DEFLATE_HASH_BITS, 0);
+        hashChain.assign(DEFLATE_WINDOW_SIZE, 0);
+        bitBuffer = 0, bitCount = 0;
+        // The whole image is a single non-final block with fixed Huffman codes
+        writeBits(0x02, 3);
+    }
+    return !failed;
+}
+
+bool ImageStreamWriter::isTopDown() const {
+    return topDown;
+}
+
+bool ImageStreamWriter::writeRows(const byte *pixels, int rowCount) {
+    if (!file || rowCount < 0 || rowCount > height-rowsWritten || !(format == ImageFormat::PNG || format == ImageFormat::BINARY))
+        return false;
+    size_t rowSize = size_t(channels)*width;
+    if (format == ImageFormat::PNG) {
+        // Each row is preceded by its filter type, which is selected by the minimum sum of absolute differences heuristic
+        buffer.resize((rowSize+1)*rowCount);
+        std::vector<byte> filtered(rowSize);
+        for (int y = 0; y < rowCount; ++y) {
+            byte *output = &buffer[(rowSize+1)*y];
+            const byte *row = pixels+rowSize*y;
+            unsigned long long bestSum = ~0ull;
+            for (int filterType = 0; filterType < 5; ++filterType) {
+                filterRow(filtered.data(), row, previousRow.data(), rowSize, channels, filterType);
+                unsigned long long sum = 0;
+                for (size_t i = 0; i < rowSize; ++i)
+                    sum += (unsigned long long) abs((int) (signed char) filtered[i]);
+                if (sum < bestSum) {
+                    bestSum = sum;
+                    output[0] = byte(filterType);
+                    memcpy(output+1, filtered.data(), rowSize);
+                }
+            }
+            memcpy(previousRow.data(), row, rowSize);
+        }
+        writePngData(buffer.data(), buffer.size());
+    } else
+        failed |= fwrite(pixels, 1, rowSize*rowCount, file) != rowSize*rowCount;
+    rowsWritten += rowCount;
+    return !failed;
+}
+
+bool ImageStreamWriter::writeRows(const float *pixels, int rowCount) {
+    if (!file || rowCount < 0 || rowCount > height-rowsWritten || !(format == ImageFormat::BINARY_FLOAT || format == ImageFormat::BINARY_FLOAT_BE))
+        return false;
+    size_t valueCount = size_t(channels)*width*rowCount;
+    buffer.resize(sizeof(float)*valueCount);
+    for (size_t i = 0; i < valueCount; ++i) {
+        uint32_t value;
+        memcpy(&value, pixels+i, sizeof(float));
+        if (format == ImageFormat::BINARY_FLOAT_BE)
+            writeU32BE(&buffer[4*i], value);
+        else {
+            buffer[4*i] = byte(value);
+            buffer[4*i+1] = byte(value>>8);
+            buffer[4*i+2] = byte(value>>16);
+            buffer[4*i+3] = byte(value>>24);
+        }
+    }
+    failed |= fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size();
+    rowsWritten += rowCount;
+    return !failed;
+}
+
+bool ImageStreamWriter::close() {
+    if (!file)
+        return false;
+    if (format == ImageFormat::PNG) {
+        // End of the block, final empty block, and Adler-32 checksum
+        writeFixedCode(DEFLATE_END_OF_BLOCK);
+        writeBits(0x03, 3);
+        writeFixedCode(DEFLATE_END_OF_BLOCK);
+        writeBits(0, (8-bitCount)&7);
+        byte checksum[4];
+        writeU32BE(checksum, adler32B<<16|adler32A);
+        compressed.insert(compressed.end(), checksum, checksum+4);
+        writePngChunk("IDAT", compressed.data(), compressed.size());
+        compressed.clear();
+        writePngChunk("IEND", nullptr, 0);
+    }
+    bool success = !failed && rowsWritten == height;
+    success &= !fclose(file);
+    file = nullptr;
+    buffer = std::vector<byte>();
+    previousRow = std::vector<byte>();
+    history = std::vector<byte>();
+    hashHeads = std::vector<uint64_t>();
+    hashChain = std::vector<uint64_t>();
+    return success;
+}
+
+void ImageStreamWriter::writePngChunk(const char *type, const byte *data, size_t length) {
+    byte header[8];
+    writeU32BE(header, uint32_t(length));
+    memcpy(header+4, type, 4);
+    byte crc[4];
+    writeU32BE(crc, crc32Update(crc32Update(0xffffffffu, header+4, 4), data, length)^0xffffffffu);
+    failed |= fwrite(header, 1, sizeof(header), file) != sizeof(header);
+    if (length)
+        failed |= fwrite(data, 1, length, file) != length;
+    failed |= fwrite(crc, 1, sizeof(crc), file) != sizeof(crc);
+}
+
+void ImageStreamWriter::writePngData(const byte *data, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        adler32A = (adler32A+data[i])%ADLER32_MODULO;
+        adler32B = (adler32B+adler32A)%ADLER32_MODULO;
+    }
+    // LZ77 with matches up to DEFLATE_WINDOW_SIZE bytes back, which may reach into the previously written rows
+    history.insert(history.end(), data, data+length);
+    size_t end = history.size();
+    while (historyCursor < end) {
+        uint64_t position = historyStart+historyCursor;
+        int bestLength = 0, bestDistance = 0;
+        if (end-historyCursor >= DEFLATE_MIN_MATCH) {
+            uint32_t hash = hashSequence(&history[historyCursor]);
+            int maxLength = (int) std::min(end-historyCursor, size_t(DEFLATE_MAX_MATCH));
+            uint64_t candidate = hashHeads[hash];
+            for (int chain = 0; candidate && chain < DEFLATE_MAX_CHAIN; ++chain) {
+                uint64_t candidatePosition = candidate-1;
+                if (candidatePosition < historyStart || position-candidatePosition > DEFLATE_WINDOW_SIZE)
+                    break;
+                const byte *a = &history[size_t(candidatePosition-historyStart)], *b = &history[historyCursor];
+                int matchLength = 0;
+                while (matchLength < maxLength && a[matchLength] == b[matchLength])
+                    ++matchLength;
+                if (matchLength > bestLength) {
+                    bestLength = matchLength, bestDistance = int(position-candidatePosition);
+                    if (matchLength == maxLength)
+                        break;
+                }
+                uint64_t next = hashChain[candidatePosition%DEFLATE_WINDOW_SIZE];
+                if (next >= candidate)
+                    break;
+                candidate = next;
+            }
+        }
+        if (bestLength < DEFLATE_MIN_MATCH) {
+            writeFixedCode(history[historyCursor]);
+            bestLength = 1;
+        } else
+            writeMatch(bestLength, bestDistance);
+        // Sequences that extend past the available data are not indexed
+        for (int i = 0; i < bestLength; ++i, ++position) {
+            size_t index = size_t(position-historyStart);
+            if (end-index >= DEFLATE_MIN_MATCH) {
+                uint32_t hash = hashSequence(&history[index]);
+                hashChain[position%DEFLATE_WINDOW_SIZE] = hashHeads[hash];
+                hashHeads[hash] = position+1;
+            }
+        }
+        historyCursor += bestLength;
+    }
+    if (history.size() > 2*DEFLATE_WINDOW_SIZE) {
+        size_t discarded = history.size()-DEFLATE_WINDOW_SIZE;
+        history.erase(history.begin(), history.begin()+discarded);
+        historyStart += discarded;
+        historyCursor -= discarded;
+    }
+    // Complete bytes are written in an IDAT chunk, the remaining bits are kept for the next rows
+    if (!compressed.empty()) {
+        writePngChunk("IDAT", compressed.data(), compressed.size());
+        compressed.clear();
+    }
+}
+
+void ImageStreamWriter::writeBits(uint32_t bits, int count) {
+    bitBuffer |= uint64_t(bits)<<bitCount;
+    bitCount += count;
+    for (; bitCount >= 8; bitCount -= 8) {
+        compressed.push_back(byte(bitBuffer));
+        bitBuffer >>= 8;
+    }
+}
+
+void ImageStreamWriter::writeFixedCode(int symbol) {
+    if (symbol < 144)
+        writeBits(reverseBits(0x30+symbol, 8), 8);
+    else if (symbol < 256)
+        writeBits(reverseBits(0x190+symbol-144, 9), 9);
+    else if (symbol < 280)
+        writeBits(reverseBits(symbol-256, 7), 7);
+    else
+        writeBits(reverseBits(0xc0+symbol-280, 8), 8);
+}
+
+void ImageStreamWriter::writeMatch(int length, int distance) {
+    int lengthCode = 28;
+    while (deflateLengthBases[lengthCode] > length)
+        --lengthCode;
+    writeFixedCode(257+lengthCode);
+    writeBits(length-deflateLengthBases[lengthCode], deflateLengthExtraBits[lengthCode]);
+    int distanceCode = 29;
+    while (deflateDistanceBases[distanceCode] > distance)
+        --distanceCode;
+    writeBits(reverseBits(distanceCode, 5), 5);
+    writeBits(distance-deflateDistanceBases[distanceCode], deflateDistanceExtraBits[distanceCode]);
+}
+
+}
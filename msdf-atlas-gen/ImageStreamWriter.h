@@ -0,0 +1,66 @@
+
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+#include "types.h"
+
+namespace msdf_atlas {
+
+/**
+ * Writes an image file progressively, a few rows at a time, so that the complete image never has to be held in memory.
+ * Supported formats are PNG (8-bit, rows compressed as they arrive), BINARY, BINARY_FLOAT, and BINARY_FLOAT_BE.
+ */
+class ImageStreamWriter {
+
+public:
+    /// Returns true if the image format can be written progressively
+    static bool supportsFormat(ImageFormat format);
+
+    ImageStreamWriter();
+    ~ImageStreamWriter();
+    /// Creates the image file. Binary formats are written in the order of outputYDirection, PNG always from the top
+    bool open(const char *filename, ImageFormat format, int width, int height, int channels, YDirection outputYDirection);
+    /// Returns true if the rows are expected from the top of the image to the bottom
+    bool isTopDown() const;
+    /// Writes consecutive rows of pixels in the expected order. 8-bit formats require byte pixels, floating-point formats float pixels
+    bool writeRows(const byte *pixels, int rowCount);
+    bool writeRows(const float *pixels, int rowCount);
+    /// Completes and closes the file, returns false if any write has failed or not all rows have been written
+    bool close();
+
+private:
+    FILE *file;
+    ImageFormat format;
+    int width, height, channels;
+    int rowsWritten;
+    bool topDown;
+    bool failed;
+    uint32_t adler32A, adler32B;
+    std::vector<byte> buffer;
+    // PNG row filtering and deflate compression state
+    std::vector<byte> previousRow;
+    /// Recent uncompressed data, which matches may refer to, starting at stream position historyStart
+    std::vector<byte> history;
+    uint64_t historyStart;
+    /// Position in history of the first byte not yet compressed
+    size_t historyCursor;
+    /// Hash chains of three-byte sequences, stream positions + 1 (0 = none)
+    std::vector<uint64_t> hashHeads, hashChain;
+    uint64_t bitBuffer;
+    int bitCount;
+    std::vector<byte> compressed;
+
+    void writePngChunk(const char *type, const byte *data, size_t length);
+    void writePngData(const byte *data, size_t length);
+    void writeBits(uint32_t bits, int count);
+    void writeFixedCode(int symbol);
+    void writeMatch(int length, int distance);
+
+    ImageStreamWriter(const ImageStreamWriter &);
+    ImageStreamWriter & operator=(const ImageStreamWriter &);
+
+};
+
+}
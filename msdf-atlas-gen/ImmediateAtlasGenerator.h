@@ -5,6 +5,7 @@
 #include "GlyphBox.h"
 #include "Workload.h"
 #include "AtlasGenerator.h"
+#include "DirtyRegions.h"
 
 namespace msdf_atlas {
 
@@ -13,6 +14,7 @@ namespace msdf_atlas {
  * and AtlasStorage class and generates glyph bitmaps immediately
  * (does not return until all submitted work is finished),
  * but may use multiple threads (setThreadCount).
+ * Finished glyphs exist only as pixels in the atlas storage, so no memory is kept per glyph.
  */
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 class ImmediateAtlasGenerator {
@@ -20,23 +22,32 @@ class ImmediateAtlasGenerator {
 public:
     ImmediateAtlasGenerator();
     ImmediateAtlasGenerator(int width, int height);
+    /// Creates with an existing (empty) atlas storage
+    explicit ImmediateAtlasGenerator(AtlasStorage &&storage);
     void generate(const GlyphGeometry *glyphs, int count);
     void rearrange(int width, int height, const Remap *remapping, int count);
     void resize(int width, int height);
+    void discard(int index);
+    void move(const Remap *remapping, int count);
+    void restore(int width, int height, AtlasStorage &&storage, const Remap *remapping, int count);
     /// Sets attributes for the generator function
     void setAttributes(const GeneratorAttributes &attributes);
     /// Sets the number of threads to be run by generate
     void setThreadCount(int threadCount);
     /// Allows access to the underlying AtlasStorage
     const AtlasStorage & atlasStorage() const;
+    /// Returns the regions of the atlas modified since the last call to clearDirtyRegions - the boxes of generated and moved glyphs,
+    /// or the entire atlas after it has been resized or rearranged
+    const std::vector<Rectangle> & getDirtyRegions() const;
+    void clearDirtyRegions();
 
 private:
     AtlasStorage storage;
-    std::vector<GlyphBox> layout;
     std::vector<T> glyphBuffer;
     std::vector<byte> errorCorrectionBuffer;
     GeneratorAttributes attributes;
     int threadCount;
+    DirtyRegions dirtyRegions;
 
 };
 
@@ -11,13 +11,15 @@ ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator() :
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height) : storage(width, height), threadCount(1) { }
 
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(AtlasStorage &&storage) : storage((AtlasStorage &&) storage), threadCount(1) { }
+
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::generate(const GlyphGeometry *glyphs, int count) {
     int maxBoxArea = 0;
     for (int i = 0; i < count; ++i) {
         GlyphBox box = glyphs[i];
         maxBoxArea = std::max(maxBoxArea, box.rect.w*box.rect.h);
-        layout.push_back((GlyphBox &&) box);
     }
     int threadBufferSize = N*maxBoxArea;
     if (threadCount*threadBufferSize > (int) glyphBuffer.size())
@@ -41,22 +43,49 @@ void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::generate(const GlyphGe
         }
         return true;
     }, count).finish(threadCount);
+    for (int i = 0; i < count; ++i) {
+        if (!glyphs[i].isWhitespace()) {
+            Rectangle box;
+            glyphs[i].getBoxRect(box.x, box.y, box.w, box.h);
+            dirtyRegions.add(box);
+        }
+    }
 }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::rearrange(int width, int height, const Remap *remapping, int count) {
-    for (int i = 0; i < count; ++i) {
-        layout[remapping[i].index].rect.x = remapping[i].target.x;
-        layout[remapping[i].index].rect.y = remapping[i].target.y;
-    }
     AtlasStorage newStorage((AtlasStorage &&) storage, width, height, remapping, count);
     storage = (AtlasStorage &&) newStorage;
+    dirtyRegions.addAll(width, height);
 }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::resize(int width, int height) {
     AtlasStorage newStorage((AtlasStorage &&) storage, width, height);
     storage = (AtlasStorage &&) newStorage;
+    dirtyRegions.addAll(width, height);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::move(const Remap *remapping, int count) {
+    // Moves are applied in order, so a glyph may take the place that a preceding one has left
+    storage.move(remapping, count);
+    for (int i = 0; i < count; ++i) {
+        const Remap &remap = remapping[i];
+        dirtyRegions.add(Rectangle { remap.target.x, remap.target.y, remap.width, remap.height });
+    }
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::restore(int width, int height, AtlasStorage &&storage, const Remap *, int) {
+    // The restored pixels are already in place, and glyphs are not tracked after generation
+    this->storage = (AtlasStorage &&) storage;
+    dirtyRegions.addAll(width, height);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::discard(int) {
+    // All work is finished by the time generate returns, and no per-glyph state is kept, so there is nothing to cancel or free
 }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
@@ -74,4 +103,14 @@ const AtlasStorage & ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::atlasS
     return storage;
 }
 
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+const std::vector<Rectangle> & ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::getDirtyRegions() const {
+    return dirtyRegions.getRegions();
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::clearDirtyRegions() {
+    dirtyRegions.clear();
+}
+
 }
@@ -0,0 +1,263 @@
+
+#include "MappedFile.h"
+
+#include <cstdio>
+#include <cstdlib>
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+    #include <winioctl.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+#endif
+
+namespace msdf_atlas {
+
+#ifdef _WIN32
+
+static bool setFileSize(HANDLE file, size_t size) {
+    LARGE_INTEGER position;
+    position.QuadPart = (LONGLONG) size;
+    return SetFilePointerEx(file, position, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+}
+
+MappedFile::MappedFile() : file(INVALID_HANDLE_VALUE), mapping(nullptr), memory(nullptr), length(0) { }
+
+MappedFile::MappedFile(MappedFile &&orig) : file(orig.file), mapping(orig.mapping), memory(orig.memory), length(orig.length), path((std::string &&) orig.path) {
+    orig.file = INVALID_HANDLE_VALUE;
+    orig.mapping = nullptr;
+    orig.memory = nullptr;
+    orig.length = 0;
+}
+
+MappedFile & MappedFile::operator=(MappedFile &&orig) {
+    if (this != &orig) {
+        close();
+        file = orig.file, mapping = orig.mapping;
+        memory = orig.memory, length = orig.length;
+        path = (std::string &&) orig.path;
+        orig.file = INVALID_HANDLE_VALUE;
+        orig.mapping = nullptr;
+        orig.memory = nullptr;
+        orig.length = 0;
+    }
+    return *this;
+}
+
+bool MappedFile::create(const char *filename, size_t size) {
+    close();
+    DWORD flags = FILE_ATTRIBUTE_NORMAL;
+    if (filename)
+        path = filename;
+    else {
+        char dir[MAX_PATH+1], tempFilename[MAX_PATH+1];
+        if (!(GetTempPathA(sizeof(dir), dir) && GetTempFileNameA(dir, "msd", 0, tempFilename)))
+            return false;
+        filename = tempFilename;
+        flags = FILE_ATTRIBUTE_TEMPORARY|FILE_FLAG_DELETE_ON_CLOSE;
+        path.clear();
+    }
+    file = CreateFileA(filename, GENERIC_READ|GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    DWORD bytesReturned;
+    DeviceIoControl(file, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &bytesReturned, nullptr);
+    length = size;
+    if (!(setFileSize(file, size) && map())) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::resize(size_t size) {
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    unmap();
+    length = size;
+    return setFileSize(file, size) && map();
+}
+
+bool MappedFile::rename(const char *filename) {
+    if (file == INVALID_HANDLE_VALUE || path.empty())
+        return false;
+    // An open file cannot be moved
+    unmap();
+    CloseHandle(file);
+    bool moved = MoveFileExA(path.c_str(), filename, MOVEFILE_REPLACE_EXISTING) != 0;
+    if (moved)
+        path = filename;
+    file = CreateFileA(path.c_str(), GENERIC_READ|GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE || !map()) {
+        close();
+        return false;
+    }
+    return moved;
+}
+
+bool MappedFile::flush() const {
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    return (!memory || FlushViewOfFile(memory, 0)) && FlushFileBuffers(file);
+}
+
+void MappedFile::close() {
+    unmap();
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+        file = INVALID_HANDLE_VALUE;
+    }
+    length = 0;
+    path.clear();
+}
+
+bool MappedFile::isOpen() const {
+    return file != INVALID_HANDLE_VALUE;
+}
+
+bool MappedFile::map() {
+    if (!length)
+        return true;
+    if (!(mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, DWORD((unsigned long long) length>>32), DWORD(length), nullptr)))
+        return false;
+    if (!(memory = (byte *) MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, length))) {
+        CloseHandle(mapping);
+        mapping = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (memory) {
+        UnmapViewOfFile(memory);
+        memory = nullptr;
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+        mapping = nullptr;
+    }
+}
+
+#else
+
+MappedFile::MappedFile() : fd(-1), memory(nullptr), length(0) { }
+
+MappedFile::MappedFile(MappedFile &&orig) : fd(orig.fd), memory(orig.memory), length(orig.length), path((std::string &&) orig.path) {
+    orig.fd = -1;
+    orig.memory = nullptr;
+    orig.length = 0;
+}
+
+MappedFile & MappedFile::operator=(MappedFile &&orig) {
+    if (this != &orig) {
+        close();
+        fd = orig.fd;
+        memory = orig.memory, length = orig.length;
+        path = (std::string &&) orig.path;
+        orig.fd = -1;
+        orig.memory = nullptr;
+        orig.length = 0;
+    }
+    return *this;
+}
+
+bool MappedFile::create(const char *filename, size_t size) {
+    close();
+    if (filename) {
+        fd = open(filename, O_RDWR|O_CREAT|O_TRUNC, 0666);
+        path = filename;
+    } else {
+        const char *dir = getenv("TMPDIR");
+        std::string tempFilename = std::string(dir && *dir ? dir : "/tmp")+"/msdf-atlas-XXXXXX";
+        // The anonymous file is unlinked right away and deleted once closed
+        if ((fd = mkstemp(&tempFilename[0])) >= 0)
+            unlink(tempFilename.c_str());
+    }
+    if (fd < 0) {
+        path.clear();
+        return false;
+    }
+    length = size;
+    if (!(ftruncate(fd, (off_t) size) == 0 && map())) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::resize(size_t size) {
+    if (fd < 0)
+        return false;
+    unmap();
+    length = size;
+    return ftruncate(fd, (off_t) size) == 0 && map();
+}
+
+bool MappedFile::rename(const char *filename) {
+    if (fd < 0 || path.empty() || ::rename(path.c_str(), filename))
+        return false;
+    path = filename;
+    return true;
+}
+
+bool MappedFile::flush() const {
+    if (fd < 0)
+        return false;
+    return !memory || msync(memory, length, MS_SYNC) == 0;
+}
+
+void MappedFile::close() {
+    unmap();
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    length = 0;
+    path.clear();
+}
+
+bool MappedFile::isOpen() const {
+    return fd >= 0;
+}
+
+bool MappedFile::map() {
+    if (!length)
+        return true;
+    void *address = mmap(nullptr, length, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED)
+        return false;
+    memory = (byte *) address;
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (memory) {
+        munmap(memory, length);
+        memory = nullptr;
+    }
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+byte * MappedFile::data() const {
+    return memory;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
+
+const std::string & MappedFile::filename() const {
+    return path;
+}
+
+}
@@ -0,0 +1,57 @@
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "types.h"
+
+namespace msdf_atlas {
+
+/**
+ * A file mapped into memory for reading and writing, which can be resized.
+ * Space added to the file reads as zeros and is not allocated on disk until written, where the file system supports sparse files.
+ */
+class MappedFile {
+
+public:
+    MappedFile();
+    MappedFile(MappedFile &&orig);
+    ~MappedFile();
+    MappedFile & operator=(MappedFile &&orig);
+    /// Creates or overwrites the file and maps size bytes of it. If filename is null, an anonymous temporary file is used
+    bool create(const char *filename, size_t size);
+    /// Changes the size of the file and maps it again, which may change the address of its data
+    bool resize(size_t size);
+    /// Moves the file to a different filename, replacing any existing file there
+    bool rename(const char *filename);
+    /// Writes the modified contents back to the file
+    bool flush() const;
+    /// Unmaps and closes the file, an anonymous file is deleted
+    void close();
+    /// Returns true if the file is open
+    bool isOpen() const;
+    /// Returns the mapped contents of the file (null if its size is zero)
+    byte * data() const;
+    size_t size() const;
+    /// Returns the filename, which is empty for an anonymous file
+    const std::string & filename() const;
+
+private:
+#ifdef _WIN32
+    void *file, *mapping;
+#else
+    int fd;
+#endif
+    byte *memory;
+    size_t length;
+    std::string path;
+
+    bool map();
+    void unmap();
+
+    MappedFile(const MappedFile &);
+    MappedFile & operator=(const MappedFile &);
+
+};
+
+}
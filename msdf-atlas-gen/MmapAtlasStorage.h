@@ -0,0 +1,71 @@
+
+#pragma once
+
+#include <string>
+#include "AtlasStorage.h"
+#include "BitmapSection.h"
+#include "MappedFile.h"
+
+namespace msdf_atlas {
+
+/**
+ * An implementation of AtlasStorage backed by a memory-mapped file, so that the atlas may be larger than the available memory.
+ * The file holds the raw pixels starting with the bottom row in native byte order,
+ * which is the layout of the bin image format (and binfloat on little-endian machines).
+ * Pixels that have never been written take no space on file systems with sparse files.
+ */
+template <typename T, int N>
+class MmapAtlasStorage {
+
+public:
+    MmapAtlasStorage();
+    /// Creates the storage in an anonymous temporary file
+    MmapAtlasStorage(int width, int height);
+    /// Creates the storage in the specified file, which is overwritten
+    MmapAtlasStorage(const char *filename, int width, int height);
+    MmapAtlasStorage(MmapAtlasStorage<T, N> &&orig);
+    /// Creates a copy with different dimensions in an anonymous temporary file
+    MmapAtlasStorage(const MmapAtlasStorage<T, N> &orig, int width, int height);
+    /// Takes over the file of orig and changes its dimensions in place
+    MmapAtlasStorage(MmapAtlasStorage<T, N> &&orig, int width, int height);
+    /// Creates a rearranged copy with different dimensions in an anonymous temporary file
+    MmapAtlasStorage(const MmapAtlasStorage<T, N> &orig, int width, int height, const Remap *remapping, int count);
+    /// Rearranges the pixels of orig into a new file, which then replaces the file of orig
+    MmapAtlasStorage(MmapAtlasStorage<T, N> &&orig, int width, int height, const Remap *remapping, int count);
+    MmapAtlasStorage<T, N> & operator=(MmapAtlasStorage<T, N> &&orig);
+    operator msdfgen::BitmapConstRef<T, N>() const;
+    operator msdfgen::BitmapRef<T, N>();
+    operator BitmapConstSection<T, N>() const;
+    operator BitmapSection<T, N>();
+    template <typename S>
+    void put(int x, int y, const msdfgen::BitmapConstRef<S, N> &subBitmap);
+    template <typename S>
+    void put(int x, int y, const BitmapConstSection<S, N> &subBitmap);
+    /// Stores a single-channel subsection into the specified channel (N = 3 or 4 only)
+    template <typename S>
+    void put(int x, int y, int channel, const msdfgen::BitmapConstRef<S, 1> &subBitmap);
+    template <typename S>
+    void put(int x, int y, int channel, const BitmapConstSection<S, 1> &subBitmap);
+    void get(int x, int y, const BitmapSection<T, N> &subBitmap) const;
+    void move(const Remap *remapping, int count);
+    int getWidth() const;
+    int getHeight() const;
+    /// Returns false if the file could not be created, resized, or replaced
+    bool isValid() const;
+    /// Writes the pixels back to the file
+    bool flush() const;
+    /// Returns the filename, which is empty for an anonymous temporary file
+    const std::string & getFilename() const;
+
+private:
+    MappedFile file;
+    int width, height;
+    bool valid;
+
+    void create(const char *filename, int width, int height);
+
+};
+
+}
+
+#include "MmapAtlasStorage.hpp"
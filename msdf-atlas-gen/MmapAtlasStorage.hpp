@@ -0,0 +1,197 @@
+
+#include "MmapAtlasStorage.h"
+
+#include <cstring>
+#include <algorithm>
+#include "bitmap-blit.h"
+
+namespace msdf_atlas {
+
+template <typename T, int N>
+MmapAtlasStorage<T, N>::MmapAtlasStorage() : width(0), height(0), valid(true) { }
+
+template <typename T, int N>
+MmapAtlasStorage<T, N>::MmapAtlasStorage(int width, int height) {
+    create(nullptr, width, height);
+}
+
+template <typename T, int N>
+MmapAtlasStorage<T, N>::MmapAtlasStorage(const char *filename, int width, int height) {
+    create(filename, width, height);
+}
+
+template <typename T, int N>
+MmapAtlasStorage<T, N>::MmapAtlasStorage(MmapAtlasStorage<T, N> &&orig) : file((MappedFile &&) orig.file), width(orig.width), height(orig.height), valid(orig.valid) {
+    orig.width = 0, orig.height = 0;
+}
+
+template <typename T, int N>
+MmapAtlasStorage<T, N>::MmapAtlasStorage(const MmapAtlasStorage<T, N> &orig, int width, int height) {
+    create(nullptr, width, height);
+    if (valid)
+        blit(*this, orig, 0, 0, 0, 0, std::min(width, orig.width), std::min(height, orig.height));
+}
+
+template <typename T, int N>
+MmapAtlasStorage<T, N>::MmapAtlasStorage(MmapAtlasStorage<T, N> &&orig, int width, int height) : file((MappedFile &&) orig.file), width(width), height(height), valid(orig.valid) {
+    size_t oldRowSize = size_t(N)*orig.width, rowSize = size_t(N)*width;
+    size_t oldSize = sizeof(T)*oldRowSize*orig.height, newSize = sizeof(T)*rowSize*height;
+    int rows = std::min(height, orig.height);
+    orig.width = 0, orig.height = 0;
+    if (!file.isOpen()) {
+        valid = false;
+        return;
+    }
+    // Rows move towards the end of the file if they get longer and towards its beginning if they get shorter
+    if (rowSize > oldRowSize) {
+        valid &= file.resize(std::max(oldSize, newSize));
+        if (T *pixels = (T *) file.data()) {
+            for (int y = rows-1; y > 0; --y)
+                memmove(pixels+rowSize*y, pixels+oldRowSize*y, sizeof(T)*oldRowSize);
+            for (int y = 0; y < rows; ++y)
+                memset(pixels+rowSize*y+oldRowSize, 0, sizeof(T)*(rowSize-oldRowSize));
+        }
+    } else if (rowSize < oldRowSize) {
+        if (T *pixels = (T *) file.data()) {
+            for (int y = 1; y < rows; ++y)
+                memmove(pixels+rowSize*y, pixels+oldRowSize*y, sizeof(T)*rowSize);
+        }
+    }
+    // Former contents beyond the copied rows must not show through
+    if (T *pixels = (T *) file.data()) {
+        size_t end = std::min(oldSize, newSize)/sizeof(T);
+        if (rowSize*rows < end)
+            memset(pixels+rowSize*rows, 0, sizeof(T)*(end-rowSize*rows));
+    }
+    valid &= file.resize(newSize);
+}
+
+template <typename T, int N>
+MmapAtlasStorage<T, N>::MmapAtlasStorage(const MmapAtlasStorage<T, N> &orig, int width, int height, const Remap *remapping, int count) {
+    create(nullptr, width, height);
+    if (valid) {
+        for (int i = 0; i < count; ++i) {
+            const Remap &remap = remapping[i];
+            blit(*this, orig, remap.target.x, remap.target.y, remap.source.x, remap.source.y, remap.width, remap.height);
+        }
+    }
+}
+
+template <typename T, int N>
+MmapAtlasStorage<T, N>::MmapAtlasStorage(MmapAtlasStorage<T, N> &&orig, int width, int height, const Remap *remapping, int count) {
+    // Boxes may overlap their former positions, so the pixels are rearranged into a new file next to the original
+    std::string filename = orig.file.filename();
+    create(filename.empty() ? nullptr : (filename+".remap").c_str(), width, height);
+    if (valid) {
+        for (int i = 0; i < count; ++i) {
+            const Remap &remap = remapping[i];
+            blit(*this, orig, remap.target.x, remap.target.y, remap.source.x, remap.source.y, remap.width, remap.height);
+        }
+    }
+    orig.file.close();
+    orig.width = 0, orig.height = 0;
+    if (valid && !filename.empty())
+        valid = file.rename(filename.c_str());
+}
+
+template <typename T, int N>
+MmapAtlasStorage<T, N> & MmapAtlasStorage<T, N>::operator=(MmapAtlasStorage<T, N> &&orig) {
+    if (this != &orig) {
+        file = (MappedFile &&) orig.file;
+        width = orig.width, height = orig.height;
+        valid = orig.valid;
+        orig.width = 0, orig.height = 0;
+    }
+    return *this;
+}
+
+template <typename T, int N>
+MmapAtlasStorage<T, N>::operator msdfgen::BitmapConstRef<T, N>() const {
+    return msdfgen::BitmapConstRef<T, N>((const T *) file.data(), width, height);
+}
+
+template <typename T, int N>
+MmapAtlasStorage<T, N>::operator msdfgen::BitmapRef<T, N>() {
+    return msdfgen::BitmapRef<T, N>((T *) file.data(), width, height);
+}
+
+template <typename T, int N>
+MmapAtlasStorage<T, N>::operator BitmapConstSection<T, N>() const {
+    return BitmapConstSection<T, N>((const T *) file.data(), width, height);
+}
+
+template <typename T, int N>
+MmapAtlasStorage<T, N>::operator BitmapSection<T, N>() {
+    return BitmapSection<T, N>((T *) file.data(), width, height);
+}
+
+template <typename T, int N>
+template <typename S>
+void MmapAtlasStorage<T, N>::put(int x, int y, const msdfgen::BitmapConstRef<S, N> &subBitmap) {
+    put(x, y, BitmapConstSection<S, N>(subBitmap));
+}
+
+template <typename T, int N>
+template <typename S>
+void MmapAtlasStorage<T, N>::put(int x, int y, const BitmapConstSection<S, N> &subBitmap) {
+    blit(*this, subBitmap, x, y, 0, 0, subBitmap.width, subBitmap.height);
+}
+
+template <typename T, int N>
+template <typename S>
+void MmapAtlasStorage<T, N>::put(int x, int y, int channel, const msdfgen::BitmapConstRef<S, 1> &subBitmap) {
+    put(x, y, channel, BitmapConstSection<S, 1>(subBitmap));
+}
+
+template <typename T, int N>
+template <typename S>
+void MmapAtlasStorage<T, N>::put(int x, int y, int channel, const BitmapConstSection<S, 1> &subBitmap) {
+    blit(*this, channel, subBitmap, x, y, 0, 0, subBitmap.width, subBitmap.height);
+}
+
+template <typename T, int N>
+void MmapAtlasStorage<T, N>::get(int x, int y, const BitmapSection<T, N> &subBitmap) const {
+    blit(subBitmap, *this, 0, 0, x, y, subBitmap.width, subBitmap.height);
+}
+
+template <typename T, int N>
+void MmapAtlasStorage<T, N>::move(const Remap *remapping, int count) {
+    for (int i = 0; i < count; ++i) {
+        const Remap &remap = remapping[i];
+        blit(*this, *this, remap.target.x, remap.target.y, remap.source.x, remap.source.y, remap.width, remap.height);
+    }
+}
+
+template <typename T, int N>
+int MmapAtlasStorage<T, N>::getWidth() const {
+    return width;
+}
+
+template <typename T, int N>
+int MmapAtlasStorage<T, N>::getHeight() const {
+    return height;
+}
+
+template <typename T, int N>
+bool MmapAtlasStorage<T, N>::isValid() const {
+    return valid;
+}
+
+template <typename T, int N>
+bool MmapAtlasStorage<T, N>::flush() const {
+    return valid && file.flush();
+}
+
+template <typename T, int N>
+const std::string & MmapAtlasStorage<T, N>::getFilename() const {
+    return file.filename();
+}
+
+template <typename T, int N>
+void MmapAtlasStorage<T, N>::create(const char *filename, int width, int height) {
+    this->width = width, this->height = height;
+    // A new file is already filled with zeros
+    valid = file.create(filename, sizeof(T)*N*width*height);
+}
+
+}
@@ -0,0 +1,89 @@
+
+#pragma once
+
+#include <vector>
+#include <functional>
+#include "Rectangle.h"
+#include "RectanglePacker.h"
+#include "AtlasGenerator.h"
+
+namespace msdf_atlas {
+
+/**
+ * A variant of DynamicAtlas that distributes glyphs over multiple square pages of a fixed size (e.g. layers of a texture array).
+ * Pages are never resized or rearranged - when the glyphs do not fit into the existing pages, a new page is opened,
+ * each with its own instance of the specified AtlasGenerator. Pages left without glyphs may be released,
+ * and the indices of released pages are reused for new ones, so the index of a page never changes while it is open.
+ * Glyphs are identified by indices assigned in the order in which they are added, starting with 0.
+ */
+template <class AtlasGenerator>
+class PagedDynamicAtlas {
+
+public:
+    /// Configures the generator of a newly opened page (e.g. its attributes and thread count) before any glyphs are added to it
+    typedef std::function<void(AtlasGenerator &generator, int page)> PageInitializer;
+
+    explicit PagedDynamicAtlas(int pageSize);
+    ~PagedDynamicAtlas();
+    /// Sets the function called for every newly opened page
+    void setPageInitializer(const PageInitializer &initializer);
+    /// Limits the number of open pages, 0 means unlimited
+    void setMaxPages(int maxPages);
+    /// Adds a batch of glyphs, which are placed into the existing pages if possible, otherwise into new pages.
+    /// Returns the number of glyphs that could not be placed because they exceed the page size or the page limit (0 on success)
+    int add(GlyphGeometry *glyphs, int count);
+    /// Removes a glyph from its page and frees its space, returns false if it is not in the atlas
+    bool remove(int index);
+    /// Returns true if the glyph is currently placed in a page
+    bool contains(int index) const;
+    /// Outputs the page and position of the glyph's box. Returns false if the glyph is not in the atlas
+    bool getBoxLocation(int index, int &page, int &x, int &y) const;
+    /// Releases all open pages that hold no glyphs, returns their number
+    int releaseEmptyPages();
+    /// Returns the number of page indices in use, including released pages that have not been reused yet
+    int getPageCount() const;
+    /// Returns true if the page is open, i.e. has not been released
+    bool isPageOpen(int page) const;
+    /// Returns the number of glyphs in an open page
+    int getPageGlyphCount(int page) const;
+    int getPageSize() const;
+    /// Allows access to the generator of an open page. Do not add glyphs to the generator directly!
+    AtlasGenerator & atlasGenerator(int page);
+    const AtlasGenerator & atlasGenerator(int page) const;
+
+private:
+    struct Page {
+        /// Owned by the atlas, null if the page has been released
+        AtlasGenerator *generator;
+        RectanglePacker packer;
+        int glyphCount;
+        int generatedCount;
+        /// Set when a glyph has been removed, which may leave the packer's free space fragmented
+        bool fragmented;
+    };
+
+    struct GlyphLocation {
+        /// -1 if the glyph is not in the atlas
+        int page;
+        /// The glyph's index in the page's generator
+        int index;
+        Rectangle rect;
+    };
+
+    int pageSize;
+    int maxPages;
+    PageInitializer pageInitializer;
+    std::vector<Page> pages;
+    std::vector<GlyphLocation> locations;
+
+    int openPage();
+    int packIntoPage(int page, Rectangle *rectangles, int *slotPages, int count);
+
+    PagedDynamicAtlas(const PagedDynamicAtlas &);
+    PagedDynamicAtlas & operator=(const PagedDynamicAtlas &);
+
+};
+
+}
+
+#include "PagedDynamicAtlas.hpp"
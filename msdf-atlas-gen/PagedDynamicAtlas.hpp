@@ -0,0 +1,218 @@
+
+#include "PagedDynamicAtlas.h"
+
+namespace msdf_atlas {
+
+template <class AtlasGenerator>
+PagedDynamicAtlas<AtlasGenerator>::PagedDynamicAtlas(int pageSize) : pageSize(pageSize), maxPages(0) { }
+
+template <class AtlasGenerator>
+PagedDynamicAtlas<AtlasGenerator>::~PagedDynamicAtlas() {
+    for (Page &page : pages)
+        delete page.generator;
+}
+
+template <class AtlasGenerator>
+void PagedDynamicAtlas<AtlasGenerator>::setPageInitializer(const PageInitializer &initializer) {
+    pageInitializer = initializer;
+}
+
+template <class AtlasGenerator>
+void PagedDynamicAtlas<AtlasGenerator>::setMaxPages(int maxPages) {
+    this->maxPages = maxPages;
+}
+
+template <class AtlasGenerator>
+int PagedDynamicAtlas<AtlasGenerator>::add(GlyphGeometry *glyphs, int count) {
+    int start = locations.size();
+    locations.resize(start+count);
+    std::vector<Rectangle> rectangles;
+    std::vector<int> glyphSlots(count, -1);
+    for (int i = 0; i < count; ++i) {
+        GlyphLocation location = { -1, -1, { } };
+        locations[start+i] = location;
+        if (!glyphs[i].isWhitespace()) {
+            Rectangle rect = { -1, -1, 0, 0 };
+            glyphs[i].getBoxSize(rect.w, rect.h);
+            glyphSlots[i] = rectangles.size();
+            rectangles.push_back(rect);
+        }
+    }
+
+    // Fill the existing pages first, then open new ones for the rest
+    std::vector<int> slotPages(rectangles.size(), -1);
+    int unplaced = rectangles.size();
+    for (int i = 0; i < (int) pages.size() && unplaced > 0; ++i) {
+        if (pages[i].generator)
+            unplaced -= packIntoPage(i, rectangles.data(), slotPages.data(), rectangles.size());
+    }
+    while (unplaced > 0) {
+        bool fits = false;
+        for (int i = 0; i < (int) rectangles.size() && !fits; ++i)
+            fits = slotPages[i] < 0 && rectangles[i].w <= pageSize && rectangles[i].h <= pageSize;
+        int openPages = 0;
+        for (const Page &page : pages)
+            openPages += page.generator != nullptr;
+        if (!fits || (maxPages && openPages >= maxPages))
+            break;
+        unplaced -= packIntoPage(openPage(), rectangles.data(), slotPages.data(), rectangles.size());
+    }
+
+    // Glyphs are passed to the generators in contiguous runs of glyphs placed into the same page
+    int runStart = 0, runPage = -1;
+    for (int i = 0; i <= count; ++i) {
+        int page = i < count && glyphSlots[i] >= 0 ? slotPages[glyphSlots[i]] : -1;
+        if (i == count || page != runPage) {
+            if (runPage >= 0) {
+                pages[runPage].generator->generate(glyphs+runStart, i-runStart);
+                pages[runPage].generatedCount += i-runStart;
+            }
+            runStart = i;
+            runPage = page;
+        }
+        if (page >= 0) {
+            const Rectangle &rect = rectangles[glyphSlots[i]];
+            GlyphLocation &location = locations[start+i];
+            location.page = page;
+            location.index = pages[page].generatedCount+i-runStart;
+            location.rect = rect;
+            glyphs[i].placeBox(rect.x, rect.y);
+            ++pages[page].glyphCount;
+        }
+    }
+    return unplaced;
+}
+
+template <class AtlasGenerator>
+bool PagedDynamicAtlas<AtlasGenerator>::remove(int index) {
+    if (!contains(index))
+        return false;
+    GlyphLocation &location = locations[index];
+    Page &page = pages[location.page];
+    page.packer.release(location.rect);
+    page.generator->discard(location.index);
+    --page.glyphCount;
+    page.fragmented = true;
+    location.page = -1;
+    return true;
+}
+
+template <class AtlasGenerator>
+bool PagedDynamicAtlas<AtlasGenerator>::contains(int index) const {
+    return index >= 0 && index < (int) locations.size() && locations[index].page >= 0;
+}
+
+template <class AtlasGenerator>
+bool PagedDynamicAtlas<AtlasGenerator>::getBoxLocation(int index, int &page, int &x, int &y) const {
+    if (!contains(index))
+        return false;
+    page = locations[index].page;
+    x = locations[index].rect.x;
+    y = locations[index].rect.y;
+    return true;
+}
+
+template <class AtlasGenerator>
+int PagedDynamicAtlas<AtlasGenerator>::releaseEmptyPages() {
+    int released = 0;
+    for (Page &page : pages) {
+        if (page.generator && !page.glyphCount) {
+            delete page.generator;
+            page.generator = nullptr;
+            page.packer = RectanglePacker();
+            ++released;
+        }
+    }
+    while (!pages.empty() && !pages.back().generator)
+        pages.pop_back();
+    return released;
+}
+
+template <class AtlasGenerator>
+int PagedDynamicAtlas<AtlasGenerator>::getPageCount() const {
+    return pages.size();
+}
+
+template <class AtlasGenerator>
+bool PagedDynamicAtlas<AtlasGenerator>::isPageOpen(int page) const {
+    return page >= 0 && page < (int) pages.size() && pages[page].generator;
+}
+
+template <class AtlasGenerator>
+int PagedDynamicAtlas<AtlasGenerator>::getPageGlyphCount(int page) const {
+    return pages[page].glyphCount;
+}
+
+template <class AtlasGenerator>
+int PagedDynamicAtlas<AtlasGenerator>::getPageSize() const {
+    return pageSize;
+}
+
+template <class AtlasGenerator>
+AtlasGenerator & PagedDynamicAtlas<AtlasGenerator>::atlasGenerator(int page) {
+    return *pages[page].generator;
+}
+
+template <class AtlasGenerator>
+const AtlasGenerator & PagedDynamicAtlas<AtlasGenerator>::atlasGenerator(int page) const {
+    return *pages[page].generator;
+}
+
+template <class AtlasGenerator>
+int PagedDynamicAtlas<AtlasGenerator>::openPage() {
+    int index = 0;
+    while (index < (int) pages.size() && pages[index].generator)
+        ++index;
+    if (index == (int) pages.size())
+        pages.push_back(Page());
+    Page &page = pages[index];
+    page.generator = new AtlasGenerator(pageSize, pageSize);
+    page.packer = RectanglePacker(pageSize, pageSize);
+    page.glyphCount = 0;
+    page.generatedCount = 0;
+    page.fragmented = false;
+    if (pageInitializer)
+        pageInitializer(*page.generator, index);
+    return index;
+}
+
+template <class AtlasGenerator>
+int PagedDynamicAtlas<AtlasGenerator>::packIntoPage(int page, Rectangle *rectangles, int *slotPages, int count) {
+    Page &target = pages[page];
+    int placed = 0;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        std::vector<Rectangle> pending;
+        std::vector<int> pendingSlots;
+        for (int i = 0; i < count; ++i) {
+            if (slotPages[i] < 0) {
+                pending.push_back(rectangles[i]);
+                pendingSlots.push_back(i);
+            }
+        }
+        int unplaced = target.packer.pack(pending.data(), pending.size());
+        for (int i = 0; i < (int) pending.size(); ++i) {
+            if (pending[i].x >= 0) {
+                rectangles[pendingSlots[i]] = pending[i];
+                slotPages[pendingSlots[i]] = page;
+                ++placed;
+            }
+        }
+        if (!unplaced || !target.fragmented)
+            break;
+        // Removed glyphs may have left the free space fragmented, so it is rebuilt from the occupied areas and packing is retried
+        std::vector<Rectangle> occupied;
+        for (const GlyphLocation &location : locations) {
+            if (location.page == page)
+                occupied.push_back(location.rect);
+        }
+        for (int i = 0; i < count; ++i) {
+            if (slotPages[i] == page)
+                occupied.push_back(rectangles[i]);
+        }
+        target.packer = RectanglePacker(pageSize, pageSize, occupied.data(), occupied.size());
+        target.fragmented = false;
+    }
+    return placed;
+}
+
+}
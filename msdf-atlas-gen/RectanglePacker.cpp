@@ -20,11 +20,75 @@ int RectanglePacker::rateFit(int w, int h, int sw, int sh) {
 
 RectanglePacker::RectanglePacker() : RectanglePacker(0, 0) { }
 
-RectanglePacker::RectanglePacker(int width, int height) {
+RectanglePacker::RectanglePacker(int width, int height) : width(std::max(width, 0)), height(std::max(height, 0)) {
     if (width > 0 && height > 0)
         spaces.push_back(Rectangle { 0, 0, width, height });
 }
 
+RectanglePacker::RectanglePacker(int width, int height, const Rectangle *occupied, int count) : width(std::max(width, 0)), height(std::max(height, 0)) {
+    // The free space is divided into horizontal bands between the edges of occupied rectangles,
+    // and the free intervals of consecutive bands are joined into spaces where they match
+    std::vector<int> edges;
+    edges.push_back(0);
+    edges.push_back(height);
+    for (int i = 0; i < count; ++i) {
+        edges.push_back(std::min(std::max(occupied[i].y, 0), height));
+        edges.push_back(std::min(std::max(occupied[i].y+occupied[i].h, 0), height));
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    std::vector<int> order, active;
+    for (int i = 0; i < count; ++i) {
+        if (occupied[i].w > 0 && occupied[i].h > 0)
+            order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [occupied](int a, int b) {
+        return occupied[a].y < occupied[b].y;
+    });
+    std::vector<Rectangle> open, nextOpen;
+    std::vector<std::pair<int, int> > intervals;
+    size_t next = 0;
+    for (size_t band = 0; band+1 < edges.size(); ++band) {
+        int y0 = edges[band], y1 = edges[band+1];
+        // Rectangles that overlap the band are kept in the active list while sweeping upwards
+        for (; next < order.size() && occupied[order[next]].y <= y0; ++next)
+            active.push_back(order[next]);
+        intervals.clear();
+        for (size_t i = 0; i < active.size();) {
+            const Rectangle &rect = occupied[active[i]];
+            if (rect.y+rect.h <= y0) {
+                removeFromUnorderedVector(active, i);
+                continue;
+            }
+            intervals.push_back(std::make_pair(rect.x, rect.x+rect.w));
+            ++i;
+        }
+        std::sort(intervals.begin(), intervals.end());
+        intervals.push_back(std::make_pair(width, width));
+        nextOpen.clear();
+        int x = 0;
+        size_t openIndex = 0;
+        for (const std::pair<int, int> &interval : intervals) {
+            if (interval.first > x) {
+                Rectangle space = { x, y0, std::min(interval.first, width)-x, y1-y0 };
+                // Open spaces are ordered by x, so a matching one can only be found ahead
+                while (openIndex < open.size() && open[openIndex].x < space.x)
+                    spaces.push_back(open[openIndex++]);
+                if (openIndex < open.size() && open[openIndex].x == space.x && open[openIndex].w == space.w) {
+                    space.y = open[openIndex].y;
+                    space.h += open[openIndex++].h;
+                }
+                if (space.w > 0)
+                    nextOpen.push_back(space);
+            }
+            x = std::max(x, interval.second);
+        }
+        spaces.insert(spaces.end(), open.begin()+openIndex, open.end());
+        open.swap(nextOpen);
+    }
+    spaces.insert(spaces.end(), open.begin(), open.end());
+}
+
 void RectanglePacker::splitSpace(int index, int w, int h) {
     Rectangle space = spaces[index];
     removeFromUnorderedVector(spaces, index);
@@ -140,4 +204,91 @@ int RectanglePacker::pack(OrientedRectangle *rectangles, int count) {
     return (int) remainingRects.size();
 }
 
+bool RectanglePacker::packBelow(Rectangle &rectangle, int top) {
+    int bestFit = WORST_FIT;
+    int bestSpace = -1;
+    for (size_t i = 0; i < spaces.size(); ++i) {
+        const Rectangle &space = spaces[i];
+        if (rectangle.w <= space.w && rectangle.h <= space.h && space.y+rectangle.h <= top) {
+            int fit = rateFit(rectangle.w, rectangle.h, space.w, space.h);
+            if (fit < bestFit) {
+                bestSpace = i;
+                bestFit = fit;
+            }
+        }
+    }
+    if (bestSpace < 0)
+        return false;
+    rectangle.x = spaces[bestSpace].x;
+    rectangle.y = spaces[bestSpace].y;
+    splitSpace(bestSpace, rectangle.w, rectangle.h);
+    return true;
+}
+
+void RectanglePacker::release(const Rectangle &rectangle) {
+    Rectangle space = rectangle;
+    // Merge with free spaces that share an entire edge to limit fragmentation
+    for (size_t i = 0; i < spaces.size();) {
+        const Rectangle &other = spaces[i];
+        if (other.y == space.y && other.h == space.h && (other.x+other.w == space.x || space.x+space.w == other.x)) {
+            space.x = std::min(space.x, other.x);
+            space.w += other.w;
+        } else if (other.x == space.x && other.w == space.w && (other.y+other.h == space.y || space.y+space.h == other.y)) {
+            space.y = std::min(space.y, other.y);
+            space.h += other.h;
+        } else {
+            ++i;
+            continue;
+        }
+        removeFromUnorderedVector(spaces, i);
+        i = 0;
+    }
+    spaces.push_back(space);
+}
+
+void RectanglePacker::expand(int width, int height) {
+    width = std::max(width, this->width), height = std::max(height, this->height);
+    // The new region is L-shaped - a strip to the right of the original area and one above it
+    if (width > this->width)
+        release(Rectangle { this->width, 0, width-this->width, height });
+    if (height > this->height && this->width > 0)
+        release(Rectangle { 0, this->height, this->width, height-this->height });
+    this->width = width, this->height = height;
+}
+
+const std::vector<Rectangle> & RectanglePacker::getFreeSpaces() const {
+    return spaces;
+}
+
+void RectanglePacker::setFreeSpaces(const Rectangle *spaces, int count) {
+    this->spaces.assign(spaces, spaces+count);
+}
+
+bool RectanglePacker::anyOverlap(const Rectangle *rectangles, int count) {
+    std::vector<int> order, active;
+    for (int i = 0; i < count; ++i) {
+        if (rectangles[i].w > 0 && rectangles[i].h > 0)
+            order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [rectangles](int a, int b) {
+        return rectangles[a].y < rectangles[b].y;
+    });
+    // Sweeping upwards, the active list holds the rectangles that extend above the bottom edge of the current one
+    for (int index : order) {
+        const Rectangle &rect = rectangles[index];
+        for (size_t i = 0; i < active.size();) {
+            const Rectangle &other = rectangles[active[i]];
+            if (other.y+other.h <= rect.y) {
+                removeFromUnorderedVector(active, i);
+                continue;
+            }
+            if (other.x < rect.x+rect.w && rect.x < other.x+other.w)
+                return true;
+            ++i;
+        }
+        active.push_back(index);
+    }
+    return false;
+}
+
 }
@@ -12,11 +12,27 @@ class RectanglePacker {
 public:
     RectanglePacker();
     RectanglePacker(int width, int height);
+    /// Creates a packer whose free space excludes the specified (previously packed) rectangles
+    RectanglePacker(int width, int height, const Rectangle *occupied, int count);
     /// Packs the rectangle array, returns how many didn't fit (0 on success)
     int pack(Rectangle *rectangles, int count);
     int pack(OrientedRectangle *rectangles, int count);
+    /// Packs a single rectangle so that it lies entirely below the y coordinate top, returns false if it doesn't fit
+    bool packBelow(Rectangle &rectangle, int top);
+    /// Returns the area of a previously packed rectangle to the free space so that it can be reused
+    void release(const Rectangle &rectangle);
+    /// Enlarges the packing area, adding the newly exposed region to the free space. Already packed rectangles stay in place
+    void expand(int width, int height);
+    /// Returns the free space, e.g. to be saved and later restored by setFreeSpaces
+    const std::vector<Rectangle> & getFreeSpaces() const;
+    /// Replaces the free space with the specified rectangles, which must lie within the packing area and must not overlap
+    void setFreeSpaces(const Rectangle *spaces, int count);
+
+    /// Returns true if any two of the rectangles overlap
+    static bool anyOverlap(const Rectangle *rectangles, int count);
 
 private:
+    int width, height;
     std::vector<Rectangle> spaces;
 
     static int rateFit(int w, int h, int sw, int sh);
@@ -0,0 +1,49 @@
+
+#pragma once
+
+#include <vector>
+#include <functional>
+#include "GlyphGeometry.h"
+#include "AtlasGenerator.h"
+#include "ImageStreamWriter.h"
+
+namespace msdf_atlas {
+
+/**
+ * An atlas generator for very large glyph sets, which never holds the complete atlas or all glyph shapes in memory.
+ * The atlas is generated in horizontal bands in the order of the output file's rows. The shapes of each band's glyphs
+ * are loaded just before generation and freed afterwards, and every finished band is immediately written by an ImageStreamWriter.
+ * T is the generator function's pixel type and OutputType the output image's pixel type.
+ */
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, typename OutputType>
+class StreamingAtlasGenerator {
+
+public:
+    /// Loads (and colors) the shape of a glyph, which is a copy of the glyph at the specified index, before it is generated
+    typedef std::function<bool(GlyphGeometry &glyph, int index)> ShapeLoader;
+
+    StreamingAtlasGenerator(int width, int height);
+    /// Generates the glyphs (whose shapes may be unloaded) band by band and writes the rows of the atlas into the open writer
+    bool generate(const GlyphGeometry *glyphs, int count, const ShapeLoader &loadShape, ImageStreamWriter &writer);
+    /// Sets attributes for the generator function
+    void setAttributes(const GeneratorAttributes &attributes);
+    /// Sets the number of threads to be run by generate
+    void setThreadCount(int threadCount);
+    /// Sets the number of atlas rows finished and written at once
+    void setBandHeight(int bandHeight);
+    /// Selects the largest band height whose buffers fit within memoryLimit bytes, returns false if even a single row does not fit
+    bool setMemoryLimit(size_t memoryLimit, const GlyphGeometry *glyphs, int count);
+    /// Returns the number of atlas rows finished and written at once
+    int getBandHeight() const;
+
+private:
+    int width, height;
+    int bandHeight;
+    GeneratorAttributes attributes;
+    int threadCount;
+
+};
+
+}
+
+#include "StreamingAtlasGenerator.hpp"
@@ -0,0 +1,129 @@
+
+#include "StreamingAtlasGenerator.h"
+
+#include <cstring>
+#include <algorithm>
+#include "Workload.h"
+#include "bitmap-blit.h"
+
+#define MSDF_ATLAS_DEFAULT_BAND_HEIGHT 64
+
+namespace msdf_atlas {
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, typename OutputType>
+StreamingAtlasGenerator<T, N, GEN_FN, OutputType>::StreamingAtlasGenerator(int width, int height) : width(width), height(height), bandHeight(MSDF_ATLAS_DEFAULT_BAND_HEIGHT), threadCount(1) { }
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, typename OutputType>
+bool StreamingAtlasGenerator<T, N, GEN_FN, OutputType>::generate(const GlyphGeometry *glyphs, int count, const ShapeLoader &loadShape, ImageStreamWriter &writer) {
+    bool topDown = writer.isTopDown();
+
+    // Order glyphs by the first output row of their boxes
+    std::vector<std::pair<int, int> > order;
+    int maxBoxWidth = 0, maxBoxHeight = 0;
+    for (int i = 0; i < count; ++i) {
+        int l, b, w, h;
+        glyphs[i].getBoxRect(l, b, w, h);
+        if (!glyphs[i].isWhitespace() && w > 0 && h > 0) {
+            order.push_back(std::make_pair(topDown ? height-b-h : b, i));
+            maxBoxWidth = std::max(maxBoxWidth, w);
+            maxBoxHeight = std::max(maxBoxHeight, h);
+        }
+    }
+    std::sort(order.begin(), order.end());
+
+    int maxBoxArea = maxBoxWidth*maxBoxHeight;
+    int threadBufferSize = N*maxBoxArea;
+    std::vector<T> glyphBuffer(threadCount*threadBufferSize);
+    std::vector<byte> errorCorrectionBuffer(threadCount*maxBoxArea);
+    std::vector<GeneratorAttributes> threadAttributes(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        threadAttributes[i] = attributes;
+        threadAttributes[i].config.errorCorrection.buffer = errorCorrectionBuffer.data()+i*maxBoxArea;
+    }
+
+    // The window holds the rows of the current band and the overhang of boxes that start in it
+    int windowHeight = bandHeight+maxBoxHeight;
+    size_t rowSize = size_t(N)*width;
+    std::vector<OutputType> window(rowSize*windowHeight);
+    BitmapSection<OutputType, N> windowBitmap(window.data(), width, windowHeight);
+    std::vector<GlyphGeometry> bandGlyphs;
+    size_t next = 0;
+    for (int bandStart = 0; bandStart < height; bandStart += bandHeight) {
+        int bandRows = std::min(bandHeight, height-bandStart);
+
+        // Load the shapes of glyphs whose boxes start in this band
+        for (; next < order.size() && order[next].first < bandStart+bandRows; ++next) {
+            bandGlyphs.push_back(glyphs[order[next].second]);
+            if (!loadShape(bandGlyphs.back(), order[next].second))
+                return false;
+        }
+
+        Workload([this, &bandGlyphs, &glyphBuffer, &threadAttributes, &windowBitmap, threadBufferSize, topDown, bandStart](int i, int threadNo) -> bool {
+            const GlyphGeometry &glyph = bandGlyphs[i];
+            int l, b, w, h;
+            glyph.getBoxRect(l, b, w, h);
+            msdfgen::BitmapRef<T, N> glyphBitmap(glyphBuffer.data()+threadNo*threadBufferSize, w, h);
+            GEN_FN(glyphBitmap, glyph, threadAttributes[threadNo]);
+            msdfgen::BitmapConstRef<T, N> source(glyphBitmap);
+            if (topDown) {
+                // The glyph is written into a vertically flipped view of its destination rows
+                int windowY = height-(b+h)-bandStart;
+                blit(windowBitmap.getSection(l, windowY, l+w, windowY+h).flipped(), source, 0, 0, 0, 0, w, h);
+            } else
+                blit(windowBitmap, source, l, b-bandStart, 0, 0, w, h);
+            return true;
+        }, (int) bandGlyphs.size()).finish(threadCount);
+
+        // Free the shapes, write the finished rows, and shift the rest of the window
+        std::vector<GlyphGeometry>().swap(bandGlyphs);
+        if (!writer.writeRows(window.data(), bandRows))
+            return false;
+        memmove(window.data(), window.data()+rowSize*bandRows, sizeof(OutputType)*rowSize*(windowHeight-bandRows));
+        memset(window.data()+rowSize*(windowHeight-bandRows), 0, sizeof(OutputType)*rowSize*bandRows);
+    }
+    return true;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, typename OutputType>
+void StreamingAtlasGenerator<T, N, GEN_FN, OutputType>::setAttributes(const GeneratorAttributes &attributes) {
+    this->attributes = attributes;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, typename OutputType>
+void StreamingAtlasGenerator<T, N, GEN_FN, OutputType>::setThreadCount(int threadCount) {
+    this->threadCount = threadCount;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, typename OutputType>
+void StreamingAtlasGenerator<T, N, GEN_FN, OutputType>::setBandHeight(int bandHeight) {
+    this->bandHeight = std::max(bandHeight, 1);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, typename OutputType>
+bool StreamingAtlasGenerator<T, N, GEN_FN, OutputType>::setMemoryLimit(size_t memoryLimit, const GlyphGeometry *glyphs, int count) {
+    size_t maxBoxHeight = 0, maxBoxArea = 0;
+    for (int i = 0; i < count; ++i) {
+        int w, h;
+        glyphs[i].getBoxSize(w, h);
+        maxBoxHeight = std::max(maxBoxHeight, size_t(h));
+        maxBoxArea = std::max(maxBoxArea, size_t(w)*h);
+    }
+    size_t rowBytes = sizeof(OutputType)*N*width;
+    // Glyph metadata, per-thread generator buffers, and the window's overhang rows do not depend on the band height
+    size_t fixedBytes = count*(sizeof(GlyphGeometry)+sizeof(std::pair<int, int>)) + threadCount*maxBoxArea*(sizeof(T)*N+1) + maxBoxHeight*rowBytes;
+    // Each band row is held in the window and once more by the writer
+    size_t bandRowBytes = 2*rowBytes;
+    if (memoryLimit < fixedBytes+bandRowBytes) {
+        bandHeight = 1;
+        return false;
+    }
+    bandHeight = int(std::min((memoryLimit-fixedBytes)/bandRowBytes, size_t(std::max(height, 1))));
+    return true;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, typename OutputType>
+int StreamingAtlasGenerator<T, N, GEN_FN, OutputType>::getBandHeight() const {
+    return bandHeight;
+}
+
+}
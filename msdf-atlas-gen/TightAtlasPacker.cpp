@@ -2,13 +2,14 @@
 #include "TightAtlasPacker.h"
 
 #include <vector>
+#include <algorithm>
 #include "Rectangle.h"
 #include "rectangle-packing.h"
 #include "size-selectors.h"
 
 namespace msdf_atlas {
 
-int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, int padding, double scale, double range, double miterLimit) {
+int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, int padding, int alignment, int channelCount, double scale, double range, double miterLimit) {
     // Wrap glyphs into boxes
     std::vector<Rectangle> rectangles;
     std::vector<GlyphGeometry *> rectangleGlyphs;
@@ -20,6 +21,11 @@ int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstr
             glyph->wrapBox(scale, range, miterLimit);
             glyph->getBoxSize(rect.w, rect.h);
             if (rect.w > 0 && rect.h > 0) {
+                if (alignment > 1) {
+                    // The padded box is rounded up to whole grid cells, which are then packed without padding
+                    rect.w = (rect.w+std::max(padding, 0)+alignment-1)/alignment*alignment;
+                    rect.h = (rect.h+std::max(padding, 0)+alignment-1)/alignment*alignment;
+                }
                 rectangles.push_back(rect);
                 rectangleGlyphs.push_back(glyph);
             }
@@ -31,8 +37,41 @@ int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstr
             width = 0, height = 0;
         return 0;
     }
+    if (alignment > 1) {
+        padding = 0;
+        if (dimensionsConstraint == DimensionsConstraint::EVEN_SQUARE || dimensionsConstraint == DimensionsConstraint::SQUARE)
+            dimensionsConstraint = DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE;
+    }
+    std::vector<int> channels(rectangles.size());
     // Box rectangle packing
-    if (width < 0 || height < 0) {
+    if (channelCount > 1) {
+        if (width < 0 || height < 0) {
+            std::pair<int, int> dimensions = std::make_pair(width, height);
+            switch (dimensionsConstraint) {
+                case DimensionsConstraint::POWER_OF_TWO_SQUARE:
+                    dimensions = packRectangleLayers<SquarePowerOfTwoSizeSelector>(rectangles.data(), channels.data(), rectangles.size(), channelCount, padding);
+                    break;
+                case DimensionsConstraint::POWER_OF_TWO_RECTANGLE:
+                    dimensions = packRectangleLayers<PowerOfTwoSizeSelector>(rectangles.data(), channels.data(), rectangles.size(), channelCount, padding);
+                    break;
+                case DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE:
+                    dimensions = packRectangleLayers<SquareSizeSelector<4> >(rectangles.data(), channels.data(), rectangles.size(), channelCount, padding);
+                    break;
+                case DimensionsConstraint::EVEN_SQUARE:
+                    dimensions = packRectangleLayers<SquareSizeSelector<2> >(rectangles.data(), channels.data(), rectangles.size(), channelCount, padding);
+                    break;
+                case DimensionsConstraint::SQUARE:
+                    dimensions = packRectangleLayers<SquareSizeSelector<> >(rectangles.data(), channels.data(), rectangles.size(), channelCount, padding);
+                    break;
+            }
+            if (!(dimensions.first > 0 && dimensions.second > 0))
+                return -1;
+            width = dimensions.first, height = dimensions.second;
+        } else {
+            if (int result = packRectangleLayers(rectangles.data(), channels.data(), rectangles.size(), channelCount, width, height, padding))
+                return result;
+        }
+    } else if (width < 0 || height < 0) {
         std::pair<int, int> dimensions = std::make_pair(width, height);
         switch (dimensionsConstraint) {
             case DimensionsConstraint::POWER_OF_TWO_SQUARE:
@@ -58,15 +97,17 @@ int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstr
         if (int result = packRectangles(rectangles.data(), rectangles.size(), width, height, padding))
             return result;
     }
-    // Set glyph box placement
-    for (size_t i = 0; i < rectangles.size(); ++i)
+    // Set glyph box placement (at the bottom left corner of its grid cells if aligned)
+    for (size_t i = 0; i < rectangles.size(); ++i) {
         rectangleGlyphs[i]->placeBox(rectangles[i].x, height-(rectangles[i].y+rectangles[i].h));
+        rectangleGlyphs[i]->setBoxChannel(channels[i]);
+    }
     return 0;
 }
 
-double TightAtlasPacker::packAndScale(GlyphGeometry *glyphs, int count, int width, int height, int padding, double unitRange, double pxRange, double miterLimit, double tolerance) {
+double TightAtlasPacker::packAndScale(GlyphGeometry *glyphs, int count, int width, int height, int padding, int alignment, int channelCount, double unitRange, double pxRange, double miterLimit, double tolerance) {
     bool lastResult = false;
-    #define TRY_PACK(scale) (lastResult = !tryPack(glyphs, count, DimensionsConstraint(), width, height, padding, (scale), unitRange+pxRange/(scale), miterLimit))
+    #define TRY_PACK(scale) (lastResult = !tryPack(glyphs, count, DimensionsConstraint(), width, height, padding, alignment, channelCount, (scale), unitRange+pxRange/(scale), miterLimit))
     double minScale = 1, maxScale = 1;
     if (TRY_PACK(1)) {
         while (maxScale < 1e+32 && ((maxScale = 2*minScale), TRY_PACK(maxScale)))
@@ -92,6 +133,8 @@ double TightAtlasPacker::packAndScale(GlyphGeometry *glyphs, int count, int widt
 TightAtlasPacker::TightAtlasPacker() :
     width(-1), height(-1),
     padding(0),
+    boxAlignment(1),
+    channelCount(1),
     dimensionsConstraint(DimensionsConstraint::POWER_OF_TWO_SQUARE),
     scale(-1),
     minScale(1),
@@ -102,14 +145,19 @@ TightAtlasPacker::TightAtlasPacker() :
 { }
 
 int TightAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
+    // The last row and column of grid cells must be complete, or glyphs would share partial blocks at the edges
+    if (boxAlignment > 1 && width >= 0 && height >= 0) {
+        width = (width+boxAlignment-1)/boxAlignment*boxAlignment;
+        height = (height+boxAlignment-1)/boxAlignment*boxAlignment;
+    }
     double initialScale = scale > 0 ? scale : minScale;
     if (initialScale > 0) {
-        if (int remaining = tryPack(glyphs, count, dimensionsConstraint, width, height, padding, initialScale, unitRange+pxRange/initialScale, miterLimit))
+        if (int remaining = tryPack(glyphs, count, dimensionsConstraint, width, height, padding, boxAlignment, channelCount, initialScale, unitRange+pxRange/initialScale, miterLimit))
             return remaining;
     } else if (width < 0 || height < 0)
         return -1;
     if (scale <= 0)
-        scale = packAndScale(glyphs, count, width, height, padding, unitRange, pxRange, miterLimit, scaleMaximizationTolerance);
+        scale = packAndScale(glyphs, count, width, height, padding, boxAlignment, channelCount, unitRange, pxRange, miterLimit, scaleMaximizationTolerance);
     if (scale <= 0)
         return -1;
     pxRange += scale*unitRange;
@@ -133,6 +181,14 @@ void TightAtlasPacker::setPadding(int padding) {
     this->padding = padding;
 }
 
+void TightAtlasPacker::setBoxAlignment(int alignment) {
+    boxAlignment = alignment;
+}
+
+void TightAtlasPacker::setChannelCount(int channelCount) {
+    this->channelCount = channelCount;
+}
+
 void TightAtlasPacker::setScale(double scale) {
     this->scale = scale;
 }
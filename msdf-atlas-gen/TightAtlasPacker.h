@@ -34,6 +34,10 @@ public:
     void setDimensionsConstraint(DimensionsConstraint dimensionsConstraint);
     /// Sets the padding between glyph boxes
     void setPadding(int padding);
+    /// Aligns the space occupied by each glyph box (including padding) to a grid, e.g. 4 for block-compressed textures, so that no two glyphs share a block. Fixed dimensions are rounded up to multiples of the alignment
+    void setBoxAlignment(int alignment);
+    /// Sets the number of channels that single-channel glyph boxes are distributed into - each channel is packed independently within the same dimensions
+    void setChannelCount(int channelCount);
     /// Sets fixed glyph scale
     void setScale(double scale);
     /// Sets the minimum glyph scale
@@ -55,6 +59,8 @@ public:
 private:
     int width, height;
     int padding;
+    int boxAlignment;
+    int channelCount;
     DimensionsConstraint dimensionsConstraint;
     double scale;
     double minScale;
@@ -63,8 +69,8 @@ private:
     double miterLimit;
     double scaleMaximizationTolerance;
 
-    static int tryPack(GlyphGeometry *glyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, int padding, double scale, double range, double miterLimit);
-    static double packAndScale(GlyphGeometry *glyphs, int count, int width, int height, int padding, double unitRange, double pxRange, double miterLimit, double tolerance);
+    static int tryPack(GlyphGeometry *glyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, int padding, int alignment, int channelCount, double scale, double range, double miterLimit);
+    static double packAndScale(GlyphGeometry *glyphs, int count, int width, int height, int padding, int alignment, int channelCount, double unitRange, double pxRange, double miterLimit, double tolerance);
 
 };
 
@@ -0,0 +1,59 @@
+
+#pragma once
+
+#include <vector>
+#include "AtlasStorage.h"
+#include "BitmapSection.h"
+#include "ImageStreamWriter.h"
+
+namespace msdf_atlas {
+
+/**
+ * An implementation of AtlasStorage that divides the atlas into square tiles of TILE_SIZE pixels,
+ * which are only allocated once a glyph is stored in them. Unallocated tiles read as zero.
+ * Suitable for sparsely populated atlases, and for DynamicAtlas, where it avoids copying the whole atlas when it is enlarged.
+ */
+template <typename T, int N, int TILE_SIZE = 64>
+class TiledAtlasStorage {
+
+public:
+    TiledAtlasStorage();
+    TiledAtlasStorage(int width, int height);
+    TiledAtlasStorage(const TiledAtlasStorage<T, N, TILE_SIZE> &orig, int width, int height);
+    /// Takes over the tiles of orig that are within the new dimensions
+    TiledAtlasStorage(TiledAtlasStorage<T, N, TILE_SIZE> &&orig, int width, int height);
+    TiledAtlasStorage(const TiledAtlasStorage<T, N, TILE_SIZE> &orig, int width, int height, const Remap *remapping, int count);
+    template <typename S>
+    void put(int x, int y, const msdfgen::BitmapConstRef<S, N> &subBitmap);
+    template <typename S>
+    void put(int x, int y, const BitmapConstSection<S, N> &subBitmap);
+    /// Stores a single-channel subsection into the specified channel (N = 3 or 4 only)
+    template <typename S>
+    void put(int x, int y, int channel, const msdfgen::BitmapConstRef<S, 1> &subBitmap);
+    template <typename S>
+    void put(int x, int y, int channel, const BitmapConstSection<S, 1> &subBitmap);
+    void get(int x, int y, const BitmapSection<T, N> &subBitmap) const;
+    void move(const Remap *remapping, int count);
+    /// Writes all rows of the atlas into the open writer, unallocated tiles are written as zeros without being read
+    bool write(ImageStreamWriter &writer) const;
+    int getWidth() const;
+    int getHeight() const;
+    /// Returns the number of tiles that hold any pixels
+    int getAllocatedTileCount() const;
+
+private:
+    int width, height;
+    int tilesX, tilesY;
+    /// Pixels of each tile (row by row, bottom row first), empty if not allocated
+    std::vector<std::vector<T> > tiles;
+
+    void setDimensions(int width, int height);
+    T * allocateTile(int tileX, int tileY);
+    /// Clears the parts of edge tiles beyond the atlas dimensions
+    void clearOutside();
+
+};
+
+}
+
+#include "TiledAtlasStorage.hpp"
@@ -0,0 +1,209 @@
+
+#include "TiledAtlasStorage.h"
+
+#include <cstring>
+#include <algorithm>
+#include "bitmap-blit.h"
+
+namespace msdf_atlas {
+
+template <typename T, int N, int TILE_SIZE>
+TiledAtlasStorage<T, N, TILE_SIZE>::TiledAtlasStorage() : width(0), height(0), tilesX(0), tilesY(0) { }
+
+template <typename T, int N, int TILE_SIZE>
+TiledAtlasStorage<T, N, TILE_SIZE>::TiledAtlasStorage(int width, int height) {
+    setDimensions(width, height);
+}
+
+template <typename T, int N, int TILE_SIZE>
+TiledAtlasStorage<T, N, TILE_SIZE>::TiledAtlasStorage(const TiledAtlasStorage<T, N, TILE_SIZE> &orig, int width, int height) {
+    setDimensions(width, height);
+    for (int ty = 0; ty < std::min(tilesY, orig.tilesY); ++ty)
+        for (int tx = 0; tx < std::min(tilesX, orig.tilesX); ++tx)
+            tiles[tilesX*ty+tx] = orig.tiles[orig.tilesX*ty+tx];
+    clearOutside();
+}
+
+template <typename T, int N, int TILE_SIZE>
+TiledAtlasStorage<T, N, TILE_SIZE>::TiledAtlasStorage(TiledAtlasStorage<T, N, TILE_SIZE> &&orig, int width, int height) {
+    setDimensions(width, height);
+    for (int ty = 0; ty < std::min(tilesY, orig.tilesY); ++ty)
+        for (int tx = 0; tx < std::min(tilesX, orig.tilesX); ++tx)
+            tiles[tilesX*ty+tx].swap(orig.tiles[orig.tilesX*ty+tx]);
+    clearOutside();
+}
+
+template <typename T, int N, int TILE_SIZE>
+TiledAtlasStorage<T, N, TILE_SIZE>::TiledAtlasStorage(const TiledAtlasStorage<T, N, TILE_SIZE> &orig, int width, int height, const Remap *remapping, int count) {
+    setDimensions(width, height);
+    // Each remapped box is copied piece by piece from the allocated source tiles that it overlaps
+    for (int i = 0; i < count; ++i) {
+        const Remap &remap = remapping[i];
+        if (remap.width <= 0 || remap.height <= 0)
+            continue;
+        for (int ty = remap.source.y/TILE_SIZE; ty*TILE_SIZE < remap.source.y+remap.height; ++ty) {
+            for (int tx = remap.source.x/TILE_SIZE; tx*TILE_SIZE < remap.source.x+remap.width; ++tx) {
+                const std::vector<T> &tile = orig.tiles[orig.tilesX*ty+tx];
+                if (tile.empty())
+                    continue;
+                int l = std::max(remap.source.x, tx*TILE_SIZE), b = std::max(remap.source.y, ty*TILE_SIZE);
+                int r = std::min(remap.source.x+remap.width, (tx+1)*TILE_SIZE), t = std::min(remap.source.y+remap.height, (ty+1)*TILE_SIZE);
+                msdfgen::BitmapConstRef<T, N> source(tile.data(), TILE_SIZE, TILE_SIZE);
+                for (int y = b; y < t; ++y) {
+                    // A row of the piece may still span two target tiles
+                    msdfgen::BitmapConstRef<T, N> row(source(l-tx*TILE_SIZE, y-ty*TILE_SIZE), r-l, 1);
+                    put(remap.target.x+l-remap.source.x, remap.target.y+y-remap.source.y, row);
+                }
+            }
+        }
+    }
+}
+
+template <typename T, int N, int TILE_SIZE>
+template <typename S>
+void TiledAtlasStorage<T, N, TILE_SIZE>::put(int x, int y, const msdfgen::BitmapConstRef<S, N> &subBitmap) {
+    put(x, y, BitmapConstSection<S, N>(subBitmap));
+}
+
+template <typename T, int N, int TILE_SIZE>
+template <typename S>
+void TiledAtlasStorage<T, N, TILE_SIZE>::put(int x, int y, const BitmapConstSection<S, N> &subBitmap) {
+    for (int ty = y/TILE_SIZE; ty*TILE_SIZE < y+subBitmap.height; ++ty) {
+        for (int tx = x/TILE_SIZE; tx*TILE_SIZE < x+subBitmap.width; ++tx) {
+            int l = std::max(x, tx*TILE_SIZE), b = std::max(y, ty*TILE_SIZE);
+            int r = std::min(x+subBitmap.width, (tx+1)*TILE_SIZE), t = std::min(y+subBitmap.height, (ty+1)*TILE_SIZE);
+            BitmapSection<T, N> tile(allocateTile(tx, ty), TILE_SIZE, TILE_SIZE);
+            blit(tile, subBitmap, l-tx*TILE_SIZE, b-ty*TILE_SIZE, l-x, b-y, r-l, t-b);
+        }
+    }
+}
+
+template <typename T, int N, int TILE_SIZE>
+template <typename S>
+void TiledAtlasStorage<T, N, TILE_SIZE>::put(int x, int y, int channel, const msdfgen::BitmapConstRef<S, 1> &subBitmap) {
+    put(x, y, channel, BitmapConstSection<S, 1>(subBitmap));
+}
+
+template <typename T, int N, int TILE_SIZE>
+template <typename S>
+void TiledAtlasStorage<T, N, TILE_SIZE>::put(int x, int y, int channel, const BitmapConstSection<S, 1> &subBitmap) {
+    for (int ty = y/TILE_SIZE; ty*TILE_SIZE < y+subBitmap.height; ++ty) {
+        for (int tx = x/TILE_SIZE; tx*TILE_SIZE < x+subBitmap.width; ++tx) {
+            int l = std::max(x, tx*TILE_SIZE), b = std::max(y, ty*TILE_SIZE);
+            int r = std::min(x+subBitmap.width, (tx+1)*TILE_SIZE), t = std::min(y+subBitmap.height, (ty+1)*TILE_SIZE);
+            BitmapSection<T, N> tile(allocateTile(tx, ty), TILE_SIZE, TILE_SIZE);
+            blit(tile, channel, subBitmap, l-tx*TILE_SIZE, b-ty*TILE_SIZE, l-x, b-y, r-l, t-b);
+        }
+    }
+}
+
+template <typename T, int N, int TILE_SIZE>
+void TiledAtlasStorage<T, N, TILE_SIZE>::get(int x, int y, const BitmapSection<T, N> &subBitmap) const {
+    for (int ty = y/TILE_SIZE; ty*TILE_SIZE < y+subBitmap.height; ++ty) {
+        for (int tx = x/TILE_SIZE; tx*TILE_SIZE < x+subBitmap.width; ++tx) {
+            int l = std::max(x, tx*TILE_SIZE), b = std::max(y, ty*TILE_SIZE);
+            int r = std::min(x+subBitmap.width, (tx+1)*TILE_SIZE), t = std::min(y+subBitmap.height, (ty+1)*TILE_SIZE);
+            const std::vector<T> &tile = tiles[tilesX*ty+tx];
+            if (tile.empty()) {
+                for (int row = b; row < t; ++row)
+                    memset(subBitmap(l-x, row-y), 0, sizeof(T)*N*(r-l));
+            } else
+                blit(subBitmap, BitmapConstSection<T, N>(tile.data(), TILE_SIZE, TILE_SIZE), l-x, b-y, l-tx*TILE_SIZE, b-ty*TILE_SIZE, r-l, t-b);
+        }
+    }
+}
+
+template <typename T, int N, int TILE_SIZE>
+void TiledAtlasStorage<T, N, TILE_SIZE>::move(const Remap *remapping, int count) {
+    // The source and target may lie in different tiles, so the pixels are copied through a buffer
+    std::vector<T> buffer;
+    for (int i = 0; i < count; ++i) {
+        const Remap &remap = remapping[i];
+        buffer.resize(N*remap.width*remap.height);
+        BitmapSection<T, N> pixels(buffer.data(), remap.width, remap.height);
+        get(remap.source.x, remap.source.y, pixels);
+        put(remap.target.x, remap.target.y, BitmapConstSection<T, N>(pixels));
+    }
+}
+
+template <typename T, int N, int TILE_SIZE>
+bool TiledAtlasStorage<T, N, TILE_SIZE>::write(ImageStreamWriter &writer) const {
+    bool topDown = writer.isTopDown();
+    size_t rowSize = size_t(N)*width;
+    std::vector<T> rows(rowSize*TILE_SIZE);
+    for (int i = 0; i < tilesY; ++i) {
+        int ty = topDown ? tilesY-i-1 : i;
+        int rowCount = std::min(TILE_SIZE, height-ty*TILE_SIZE);
+        for (int tx = 0; tx < tilesX; ++tx) {
+            const std::vector<T> &tile = tiles[tilesX*ty+tx];
+            int tileWidth = std::min(TILE_SIZE, width-tx*TILE_SIZE);
+            for (int row = 0; row < rowCount; ++row) {
+                T *output = rows.data()+rowSize*(topDown ? rowCount-row-1 : row)+N*TILE_SIZE*tx;
+                if (tile.empty())
+                    memset(output, 0, sizeof(T)*N*tileWidth);
+                else
+                    memcpy(output, tile.data()+N*TILE_SIZE*row, sizeof(T)*N*tileWidth);
+            }
+        }
+        if (!writer.writeRows(rows.data(), rowCount))
+            return false;
+    }
+    return true;
+}
+
+template <typename T, int N, int TILE_SIZE>
+int TiledAtlasStorage<T, N, TILE_SIZE>::getWidth() const {
+    return width;
+}
+
+template <typename T, int N, int TILE_SIZE>
+int TiledAtlasStorage<T, N, TILE_SIZE>::getHeight() const {
+    return height;
+}
+
+template <typename T, int N, int TILE_SIZE>
+int TiledAtlasStorage<T, N, TILE_SIZE>::getAllocatedTileCount() const {
+    int count = 0;
+    for (const std::vector<T> &tile : tiles)
+        count += !tile.empty();
+    return count;
+}
+
+template <typename T, int N, int TILE_SIZE>
+void TiledAtlasStorage<T, N, TILE_SIZE>::setDimensions(int width, int height) {
+    this->width = width, this->height = height;
+    tilesX = (width+TILE_SIZE-1)/TILE_SIZE;
+    tilesY = (height+TILE_SIZE-1)/TILE_SIZE;
+    tiles.resize(tilesX*tilesY);
+}
+
+template <typename T, int N, int TILE_SIZE>
+T * TiledAtlasStorage<T, N, TILE_SIZE>::allocateTile(int tileX, int tileY) {
+    std::vector<T> &tile = tiles[tilesX*tileY+tileX];
+    if (tile.empty())
+        tile.resize(N*TILE_SIZE*TILE_SIZE, T());
+    return tile.data();
+}
+
+template <typename T, int N, int TILE_SIZE>
+void TiledAtlasStorage<T, N, TILE_SIZE>::clearOutside() {
+    int edgeWidth = width-(tilesX-1)*TILE_SIZE, edgeHeight = height-(tilesY-1)*TILE_SIZE;
+    if (edgeWidth < TILE_SIZE) {
+        for (int ty = 0; ty < tilesY; ++ty) {
+            std::vector<T> &tile = tiles[tilesX*ty+tilesX-1];
+            if (!tile.empty()) {
+                for (int row = 0; row < TILE_SIZE; ++row)
+                    memset(tile.data()+N*(TILE_SIZE*row+edgeWidth), 0, sizeof(T)*N*(TILE_SIZE-edgeWidth));
+            }
+        }
+    }
+    if (edgeHeight < TILE_SIZE) {
+        for (int tx = 0; tx < tilesX; ++tx) {
+            std::vector<T> &tile = tiles[tilesX*(tilesY-1)+tx];
+            if (!tile.empty())
+                memset(tile.data()+N*TILE_SIZE*edgeHeight, 0, sizeof(T)*N*TILE_SIZE*(TILE_SIZE-edgeHeight));
+        }
+    }
+}
+
+}
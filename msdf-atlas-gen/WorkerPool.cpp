@@ -0,0 +1,91 @@
+
+#include "WorkerPool.h"
+
+#include <atomic>
+#include <algorithm>
+
+namespace msdf_atlas {
+
+struct WorkerPool::Task {
+    const std::function<bool(int, int)> &workerFunction;
+    int chunks;
+    std::atomic<int> next;
+    std::atomic<bool> result;
+    /// Number of threads that have joined the task, guarded by the pool's mutex
+    int joined;
+    /// Number of the pool's threads still processing the task, guarded by the pool's mutex
+    int running;
+    std::condition_variable finished;
+
+    Task(const std::function<bool(int, int)> &workerFunction, int chunks) : workerFunction(workerFunction), chunks(chunks), next(0), result(true), joined(1), running(0) { }
+
+    void process(int threadNo) {
+        for (int i = next++; result && i < chunks; i = next++) {
+            if (!workerFunction(i, threadNo))
+                result = false;
+        }
+    }
+
+};
+
+WorkerPool::WorkerPool(int threadCount) : stopping(false) {
+    if (threadCount <= 0)
+        threadCount = std::max((int) std::thread::hardware_concurrency()-1, 1);
+    threads.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i)
+        threads.emplace_back(&WorkerPool::workerThread, this);
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+void WorkerPool::workerThread() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wakeCondition.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty())
+            return;
+        Task *task = queue.front();
+        queue.pop_front();
+        int threadNo = task->joined++;
+        ++task->running;
+        lock.unlock();
+        task->process(threadNo);
+        lock.lock();
+        if (!--task->running)
+            task->finished.notify_all();
+    }
+}
+
+bool WorkerPool::run(const std::function<bool(int, int)> &workerFunction, int chunks, int threadCount) {
+    Task task(workerFunction, chunks);
+    int helperCount = std::min(std::min(threadCount, chunks)-1, (int) threads.size());
+    if (helperCount > 0) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.insert(queue.end(), helperCount, &task);
+        }
+        wakeCondition.notify_all();
+    }
+    task.process(0);
+    if (helperCount > 0) {
+        // Threads that have not picked up the task yet are no longer needed
+        std::unique_lock<std::mutex> lock(mutex);
+        queue.erase(std::remove(queue.begin(), queue.end(), &task), queue.end());
+        task.finished.wait(lock, [&task]() { return !task.running; });
+    }
+    return task.result;
+}
+
+int WorkerPool::getThreadCount() const {
+    return (int) threads.size();
+}
+
+}
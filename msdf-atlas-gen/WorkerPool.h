@@ -0,0 +1,47 @@
+
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace msdf_atlas {
+
+/**
+ * A fixed set of threads that stay alive to process the parallel workloads of multiple jobs.
+ * The thread that submits a workload always processes it too, so workloads submitted from within
+ * other workloads make progress even when all of the pool's threads are busy.
+ */
+class WorkerPool {
+
+public:
+    /// Starts threadCount threads, 0 = one less than the number of hardware threads
+    explicit WorkerPool(int threadCount = 0);
+    /// Waits for the threads to finish the workloads in progress
+    ~WorkerPool();
+    /// Processes chunks (see Workload) by the calling thread and up to threadCount-1 of the pool's threads, returns true if all chunks have been processed
+    bool run(const std::function<bool(int, int)> &workerFunction, int chunks, int threadCount);
+    /// Returns the number of the pool's threads
+    int getThreadCount() const;
+
+private:
+    struct Task;
+
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    /// One entry for each thread requested by a workload
+    std::deque<Task *> queue;
+    std::vector<std::thread> threads;
+    bool stopping;
+
+    void workerThread();
+
+    WorkerPool(const WorkerPool &);
+    WorkerPool & operator=(const WorkerPool &);
+
+};
+
+}
@@ -5,9 +5,16 @@
 #include <thread>
 #include <atomic>
 #include <algorithm>
+#include "WorkerPool.h"
 
 namespace msdf_atlas {
 
+static std::atomic<WorkerPool *> workerPool(nullptr);
+
+void Workload::setWorkerPool(WorkerPool *pool) {
+    workerPool = pool;
+}
+
 Workload::Workload() : chunks(0) { }
 
 Workload::Workload(const std::function<bool(int, int)> &workerFunction, int chunks) : workerFunction(workerFunction), chunks(chunks) { }
@@ -20,6 +27,8 @@ bool Workload::finishSequential() {
 }
 
 bool Workload::finishParallel(int threadCount) {
+    if (WorkerPool *pool = workerPool)
+        return pool->run(workerFunction, chunks, threadCount);
     bool result = true;
     std::atomic<int> next(0);
     std::function<void(int)> threadWorker = [this, &result, &next](int threadNo) {
@@ -5,6 +5,8 @@
 
 namespace msdf_atlas {
 
+class WorkerPool;
+
 /**
  * This function allows to split a workload into multiple threads.
  * The worker function:
@@ -19,6 +21,8 @@ public:
     Workload(const std::function<bool(int, int)> &workerFunction, int chunks);
     /// Runs the process and returns true if all chunks have been processed
     bool finish(int threadCount);
+    /// Makes subsequent parallel workloads of all threads run on the given pool instead of their own threads, null restores the default
+    static void setWorkerPool(WorkerPool *pool);
 
 private:
     std::function<bool(int, int)> workerFunction;
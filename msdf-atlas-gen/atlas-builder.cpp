@@ -0,0 +1,260 @@
+
+#include "atlas-builder.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <msdfgen-ext.h>
+#include "BitmapAtlasStorage.h"
+#include "ImmediateAtlasGenerator.h"
+#include "edge-coloring.h"
+#include "glyph-generators.h"
+#include "image-encode.h"
+#include "json-export.h"
+#include "binary-layout-export.h"
+
+namespace msdf_atlas {
+
+AtlasBuildSettings::AtlasBuildSettings() {
+    generatorAttributes.config.overlapSupport = !preprocessGeometry;
+    generatorAttributes.scanlinePass = !preprocessGeometry;
+}
+
+MemoryAtlas::MemoryAtlas(const OutputAllocator &allocator) : allocator(allocator), width(0), height(0), scale(0), pxRange(0), fontGeometry(&glyphs) { }
+
+MemoryAtlas::~MemoryAtlas() {
+    clear();
+}
+
+void MemoryAtlas::clear() {
+    for (OutputBuffer &buffer : outputs) {
+        if (buffer.data) {
+            if (allocator.deallocate)
+                allocator.deallocate(buffer.data, allocator.userPointer);
+            else
+                free(buffer.data);
+        }
+        buffer = OutputBuffer();
+    }
+    width = 0, height = 0;
+    scale = 0, pxRange = 0;
+    glyphs.clear();
+    fontGeometry = FontGeometry(&glyphs);
+}
+
+int MemoryAtlas::getWidth() const {
+    return width;
+}
+
+int MemoryAtlas::getHeight() const {
+    return height;
+}
+
+double MemoryAtlas::getScale() const {
+    return scale;
+}
+
+double MemoryAtlas::getPixelRange() const {
+    return pxRange;
+}
+
+const FontGeometry & MemoryAtlas::getFontGeometry() const {
+    return fontGeometry;
+}
+
+const std::vector<GlyphGeometry> & MemoryAtlas::getGlyphs() const {
+    return glyphs;
+}
+
+const OutputBuffer & MemoryAtlas::getOutput(AtlasOutput output) const {
+    return outputs[int(output)];
+}
+
+OutputBuffer MemoryAtlas::releaseOutput(AtlasOutput output) {
+    OutputBuffer buffer = outputs[int(output)];
+    outputs[int(output)] = OutputBuffer();
+    return buffer;
+}
+
+bool MemoryAtlas::setOutput(AtlasOutput output, const void *data, size_t size) {
+    OutputBuffer &buffer = outputs[int(output)];
+    buffer.data = reinterpret_cast<byte *>(allocator.allocate ? allocator.allocate(size, allocator.userPointer) : malloc(size));
+    if (!buffer.data)
+        return false;
+    memcpy(buffer.data, data, size);
+    buffer.size = size;
+    return true;
+}
+
+/// Encodes the atlas bitmap in the selected format
+template <typename T, int N>
+static bool encodeImage(std::vector<byte> &output, const msdfgen::BitmapConstRef<T, N> &bitmap, const AtlasBuildSettings &settings) {
+    switch (settings.imageFormat) {
+        case ImageFormat::PNG:
+            return encodePng(output, bitmap);
+        case ImageFormat::QOI:
+            return encodeQoi(output, bitmap);
+        case ImageFormat::KTX2:
+        case ImageFormat::KTX2_HALF_FLOAT:
+        case ImageFormat::KTX2_FLOAT: {
+            Ktx2Properties properties = settings.ktx2Properties;
+            properties.halfFloat = settings.imageFormat == ImageFormat::KTX2_HALF_FLOAT;
+            return encodeKtx2(output, &bitmap, 1, settings.yDirection, properties);
+        }
+        case ImageFormat::BINARY:
+        case ImageFormat::BINARY_FLOAT: {
+            // Raw pixels in the native byte order, rows ordered by the output Y direction
+            size_t rowSize = sizeof(T)*N*bitmap.width;
+            output.resize(rowSize*bitmap.height);
+            for (int y = 0; y < bitmap.height; ++y)
+                memcpy(output.data()+rowSize*y, bitmap.pixels+N*bitmap.width*(settings.yDirection == YDirection::TOP_DOWN ? bitmap.height-y-1 : y), rowSize);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+template <typename T, typename S, int N, GeneratorFunction<S, N> GEN_FN>
+static bool generateImage(std::vector<byte> &output, const std::vector<GlyphGeometry> &glyphs, int width, int height, const GeneratorAttributes &attributes, const AtlasBuildSettings &settings) {
+    ImmediateAtlasGenerator<S, N, GEN_FN, BitmapAtlasStorage<T, N> > generator(width, height);
+    generator.setAttributes(attributes);
+    generator.setThreadCount(settings.threadCount);
+    generator.generate(glyphs.data(), glyphs.size());
+    return encodeImage(output, (msdfgen::BitmapConstRef<T, N>) generator.atlasStorage(), settings);
+}
+
+bool buildAtlas(MemoryAtlas &atlas, const byte *fontData, size_t fontDataLength, const Charset &charset, const AtlasBuildSettings &settings) {
+    atlas.clear();
+    bool floatingPointFormat = (
+        settings.imageFormat == ImageFormat::BINARY_FLOAT ||
+        settings.imageFormat == ImageFormat::KTX2_HALF_FLOAT ||
+        settings.imageFormat == ImageFormat::KTX2_FLOAT
+    );
+    if (!(
+        settings.imageFormat == ImageFormat::PNG || settings.imageFormat == ImageFormat::QOI ||
+        settings.imageFormat == ImageFormat::BINARY || settings.imageFormat == ImageFormat::KTX2 ||
+        floatingPointFormat
+    ))
+        return false;
+    // Without channel packing, no atlas type consists of exactly the two channels that BC5 holds
+    if (settings.ktx2Properties.blockCompression == BlockCompression::BC5 || (settings.ktx2Properties.blockCompression == BlockCompression::BC7 && !(settings.imageType == ImageType::MSDF || settings.imageType == ImageType::MTSDF)))
+        return false;
+
+    // Load glyphs
+    {
+        msdfgen::FreetypeHandle *ft = msdfgen::initializeFreetype();
+        if (!ft)
+            return false;
+        int glyphsLoaded = -1;
+        if (msdfgen::FontHandle *font = msdfgen::loadFontData(ft, fontData, int(fontDataLength))) {
+            switch (settings.glyphIdentifierType) {
+                case GlyphIdentifierType::GLYPH_INDEX:
+                    glyphsLoaded = atlas.fontGeometry.loadGlyphset(font, settings.fontScale, charset, settings.preprocessGeometry, settings.kerning);
+                    break;
+                case GlyphIdentifierType::UNICODE_CODEPOINT:
+                    glyphsLoaded = atlas.fontGeometry.loadCharset(font, settings.fontScale, charset, settings.preprocessGeometry, settings.kerning);
+                    break;
+            }
+            msdfgen::destroyFont(font);
+        }
+        msdfgen::deinitializeFreetype(ft);
+        if (glyphsLoaded <= 0)
+            return false;
+        if (settings.fontName)
+            atlas.fontGeometry.setName(settings.fontName);
+    }
+
+    // Determine atlas dimensions and scale, pack glyphs
+    {
+        TightAtlasPacker atlasPacker;
+        if (settings.width >= 0 && settings.height >= 0)
+            atlasPacker.setDimensions(settings.width, settings.height);
+        else
+            atlasPacker.setDimensionsConstraint(settings.dimensionsConstraint);
+        atlasPacker.setPadding(settings.imageType == ImageType::MSDF || settings.imageType == ImageType::MTSDF ? 0 : -1);
+        if (settings.ktx2Properties.blockCompression != BlockCompression::NONE)
+            atlasPacker.setBoxAlignment(4);
+        if (settings.emSize > 0)
+            atlasPacker.setScale(settings.emSize);
+        else
+            atlasPacker.setMinimumScale(settings.minEmSize);
+        // Like in the standalone program, masks have a fixed range (a soft mask is a distance field with a range of one pixel), and only pseudo-distance fields are affected by the miter limit
+        bool distanceField = settings.imageType == ImageType::SDF || settings.imageType == ImageType::PSDF || settings.imageType == ImageType::MSDF || settings.imageType == ImageType::MTSDF;
+        atlasPacker.setPixelRange(distanceField ? settings.pxRange : (double) (settings.imageType == ImageType::SOFT_MASK));
+        atlasPacker.setMiterLimit(settings.imageType == ImageType::PSDF || settings.imageType == ImageType::MSDF || settings.imageType == ImageType::MTSDF ? settings.miterLimit : 0);
+        if (atlasPacker.pack(atlas.glyphs.data(), atlas.glyphs.size()))
+            return false;
+        atlasPacker.getDimensions(atlas.width, atlas.height);
+        if (!(atlas.width > 0 && atlas.height > 0))
+            return false;
+        atlas.scale = atlasPacker.getScale();
+        atlas.pxRange = atlasPacker.getPixelRange();
+    }
+
+    // Generate and encode atlas bitmap
+    {
+        GeneratorAttributes attributes = settings.generatorAttributes;
+        if (attributes.scanlinePass)
+            attributes.config.errorCorrection.distanceCheckMode = msdfgen::ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE;
+        if (settings.imageType == ImageType::MSDF || settings.imageType == ImageType::MTSDF)
+            colorGlyphEdges(atlas.glyphs.data(), atlas.glyphs.size(), settings.edgeColoring, settings.angleThreshold, settings.coloringSeed, settings.expensiveColoring, settings.threadCount);
+        std::vector<byte> image;
+        bool success = false;
+        switch (settings.imageType) {
+            case ImageType::HARD_MASK:
+                if (floatingPointFormat)
+                    success = generateImage<float, float, 1, scanlineGenerator>(image, atlas.glyphs, atlas.width, atlas.height, attributes, settings);
+                else
+                    success = generateImage<byte, float, 1, scanlineGenerator>(image, atlas.glyphs, atlas.width, atlas.height, attributes, settings);
+                break;
+            case ImageType::SOFT_MASK:
+            case ImageType::SDF:
+                if (floatingPointFormat)
+                    success = generateImage<float, float, 1, sdfGenerator>(image, atlas.glyphs, atlas.width, atlas.height, attributes, settings);
+                else
+                    success = generateImage<byte, float, 1, sdfGenerator>(image, atlas.glyphs, atlas.width, atlas.height, attributes, settings);
+                break;
+            case ImageType::PSDF:
+                if (floatingPointFormat)
+                    success = generateImage<float, float, 1, psdfGenerator>(image, atlas.glyphs, atlas.width, atlas.height, attributes, settings);
+                else
+                    success = generateImage<byte, float, 1, psdfGenerator>(image, atlas.glyphs, atlas.width, atlas.height, attributes, settings);
+                break;
+            case ImageType::MSDF:
+                if (floatingPointFormat)
+                    success = generateImage<float, float, 3, msdfGenerator>(image, atlas.glyphs, atlas.width, atlas.height, attributes, settings);
+                else
+                    success = generateImage<byte, float, 3, msdfGenerator>(image, atlas.glyphs, atlas.width, atlas.height, attributes, settings);
+                break;
+            case ImageType::MTSDF:
+                if (floatingPointFormat)
+                    success = generateImage<float, float, 4, mtsdfGenerator>(image, atlas.glyphs, atlas.width, atlas.height, attributes, settings);
+                else
+                    success = generateImage<byte, float, 4, mtsdfGenerator>(image, atlas.glyphs, atlas.width, atlas.height, attributes, settings);
+                break;
+        }
+        if (!(success && atlas.setOutput(AtlasOutput::IMAGE, image.data(), image.size())))
+            return false;
+    }
+
+    // Encode layout
+    if (settings.json) {
+        std::vector<char> json;
+        if (!(
+            encodeJSON(json, &atlas.fontGeometry, 1, atlas.scale, atlas.pxRange, atlas.width, atlas.height, settings.imageType, settings.yDirection, settings.kerning) &&
+            atlas.setOutput(AtlasOutput::JSON, json.data(), json.size())
+        ))
+            return false;
+    }
+    if (settings.binaryLayout) {
+        std::vector<byte> layout;
+        if (!(
+            encodeBinaryLayout(layout, &atlas.fontGeometry, 1, atlas.scale, atlas.pxRange, atlas.width, atlas.height, settings.imageType, settings.yDirection, settings.kerning) &&
+            atlas.setOutput(AtlasOutput::BINARY_LAYOUT, layout.data(), layout.size())
+        ))
+            return false;
+    }
+    return true;
+}
+
+}
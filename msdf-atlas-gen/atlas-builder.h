@@ -0,0 +1,122 @@
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <msdfgen.h>
+#include "types.h"
+#include "Charset.h"
+#include "GlyphGeometry.h"
+#include "FontGeometry.h"
+#include "TightAtlasPacker.h"
+#include "AtlasGenerator.h"
+#include "ktx2-export.h"
+
+namespace msdf_atlas {
+
+/// Memory allocation functions of the output buffers of buildAtlas, malloc and free are used if not set
+struct OutputAllocator {
+    void * (*allocate)(size_t size, void *userPointer) = nullptr;
+    void (*deallocate)(void *memory, void *userPointer) = nullptr;
+    void *userPointer = nullptr;
+};
+
+/// A block of memory allocated by an OutputAllocator
+struct OutputBuffer {
+    byte *data = nullptr;
+    size_t size = 0;
+};
+
+/// Settings of buildAtlas, equivalent to the options of the standalone executable, with the same defaults as its build without Skia
+struct AtlasBuildSettings {
+    AtlasBuildSettings();
+
+    ImageType imageType = ImageType::MSDF;
+    /// Encoding of the image - PNG, QOI, BINARY, BINARY_FLOAT, KTX2, KTX2_HALF_FLOAT, or KTX2_FLOAT
+    ImageFormat imageFormat = ImageFormat::PNG;
+    YDirection yDirection = YDirection::BOTTOM_UP;
+    /// Whether the elements of the charset are Unicode codepoints or glyph indices
+    GlyphIdentifierType glyphIdentifierType = GlyphIdentifierType::UNICODE_CODEPOINT;
+    double fontScale = 1;
+    const char *fontName = nullptr;
+    /// Fixed glyph size in pixels per EM, or 0 to select the largest size that fits the atlas dimensions
+    double emSize = 0;
+    /// Minimum glyph size in pixels per EM if the atlas dimensions are not fixed
+    double minEmSize = MSDF_ATLAS_DEFAULT_EM_SIZE;
+    /// Distance field range in pixels (ignored for hard and soft masks)
+    double pxRange = 2;
+    /// Limits the extension of glyph boxes due to sharp corners (PSDF, MSDF, and MTSDF only)
+    double miterLimit = 1;
+    /// Fixed atlas dimensions, or -1 to determine them according to dimensionsConstraint
+    int width = -1, height = -1;
+    TightAtlasPacker::DimensionsConstraint dimensionsConstraint = TightAtlasPacker::DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE;
+    /// Edge coloring strategy - msdfgen::edgeColoringSimple, edgeColoringInkTrap, or edgeColoringByDistance
+    void (*edgeColoring)(msdfgen::Shape &, double, unsigned long long) = msdfgen::edgeColoringInkTrap;
+    /// Colors the glyphs in parallel with seeds that do not depend on their order, which the CLI enables for edgeColoringByDistance
+    bool expensiveColoring = false;
+    double angleThreshold = 3;
+    unsigned long long coloringSeed = 0;
+    bool preprocessGeometry = false;
+    bool kerning = true;
+    GeneratorAttributes generatorAttributes;
+    /// Properties of the KTX2 formats. Block compression may be BC4, or BC7 for MSDF and MTSDF
+    Ktx2Properties ktx2Properties;
+    /// Selects which layout encodings are produced in addition to the layout structures
+    bool json = false, binaryLayout = false;
+    int threadCount = 1;
+};
+
+/// Encoded outputs of a MemoryAtlas
+enum class AtlasOutput {
+    IMAGE,
+    JSON,
+    BINARY_LAYOUT
+};
+
+/**
+ * An atlas built by buildAtlas, consisting of the encoded image, the optional layout encodings, and the layout structures.
+ * The output buffers are allocated by the OutputAllocator and freed on destruction unless released.
+ */
+class MemoryAtlas {
+
+public:
+    explicit MemoryAtlas(const OutputAllocator &allocator = OutputAllocator());
+    ~MemoryAtlas();
+    /// Frees all outputs and clears the layout
+    void clear();
+    int getWidth() const;
+    int getHeight() const;
+    /// Returns the glyph size in pixels per EM
+    double getScale() const;
+    double getPixelRange() const;
+    /// Returns the layout of the glyphs, their bounds in the atlas are oriented bottom-up regardless of the settings
+    const FontGeometry & getFontGeometry() const;
+    const std::vector<GlyphGeometry> & getGlyphs() const;
+    /// Returns an encoded output, which is empty if it has not been requested
+    const OutputBuffer & getOutput(AtlasOutput output) const;
+    /// Transfers the ownership of an encoded output to the caller, who must free it with the OutputAllocator
+    OutputBuffer releaseOutput(AtlasOutput output);
+
+private:
+    OutputAllocator allocator;
+    int width, height;
+    double scale, pxRange;
+    std::vector<GlyphGeometry> glyphs;
+    FontGeometry fontGeometry;
+    OutputBuffer outputs[3];
+
+    MemoryAtlas(const MemoryAtlas &);
+    MemoryAtlas & operator=(const MemoryAtlas &);
+    bool setOutput(AtlasOutput output, const void *data, size_t size);
+
+    friend bool buildAtlas(MemoryAtlas &atlas, const byte *fontData, size_t fontDataLength, const Charset &charset, const AtlasBuildSettings &settings);
+
+};
+
+/**
+ * Builds an atlas entirely in memory from the contents of a font file and a charset, without touching the filesystem.
+ * Returns false if the font cannot be loaded, the glyphs do not fit, or the image format cannot be encoded in memory.
+ */
+bool buildAtlas(MemoryAtlas &atlas, const byte *fontData, size_t fontDataLength, const Charset &charset, const AtlasBuildSettings &settings = AtlasBuildSettings());
+
+}
@@ -0,0 +1,224 @@
+
+#include "binary-layout-export.h"
+
+#include <cstdio>
+#include <cstring>
+#include "GlyphGeometry.h"
+#include "binary-records.h"
+
+namespace msdf_atlas {
+
+/// Appends a record consisting of 32-bit fields in little-endian byte order
+template <typename T>
+static void appendRecord(std::vector<byte> &output, const T &record) {
+    writeRecord(output, output.size(), record);
+}
+
+static void appendU32(std::vector<byte> &output, uint32_t value) {
+    for (int i = 0; i < 4; ++i)
+        output.push_back(byte(value>>8*i));
+}
+
+static void alignOutput(std::vector<byte> &output) {
+    while (output.size()&3)
+        output.push_back(byte(0));
+}
+
+static uint32_t imageTypeCode(ImageType imageType) {
+    switch (imageType) {
+        case ImageType::HARD_MASK:
+            return BINARY_LAYOUT_IMAGE_HARD_MASK;
+        case ImageType::SOFT_MASK:
+            return BINARY_LAYOUT_IMAGE_SOFT_MASK;
+        case ImageType::SDF:
+            return BINARY_LAYOUT_IMAGE_SDF;
+        case ImageType::PSDF:
+            return BINARY_LAYOUT_IMAGE_PSDF;
+        case ImageType::MSDF:
+            return BINARY_LAYOUT_IMAGE_MSDF;
+        case ImageType::MTSDF:
+            return BINARY_LAYOUT_IMAGE_MTSDF;
+    }
+    return BINARY_LAYOUT_NONE;
+}
+
+/// Appends the data tables of a single font variant and fills in their offsets
+static void encodeFont(std::vector<byte> &output, BinaryLayoutFont &fontRecord, const FontGeometry &font, int atlasWidth, int atlasHeight, YDirection yDirection, bool kerning, bool quadVertices) {
+    FontGeometry::GlyphRange glyphs = font.getGlyphs();
+    const GlyphGeometry *firstGlyph = glyphs.begin();
+    const msdfgen::FontMetrics &metrics = font.getMetrics();
+    float yFactor = yDirection == YDirection::TOP_DOWN ? -1.f : 1.f;
+    bool byCodepoint = font.getPreferredIdentifierType() == GlyphIdentifierType::UNICODE_CODEPOINT;
+
+    fontRecord.identifierType = byCodepoint ? BINARY_LAYOUT_UNICODE_CODEPOINT : BINARY_LAYOUT_GLYPH_INDEX;
+    fontRecord.emSize = float(metrics.emSize);
+    fontRecord.lineHeight = float(metrics.lineHeight);
+    fontRecord.ascender = yFactor*float(metrics.ascenderY);
+    fontRecord.descender = yFactor*float(metrics.descenderY);
+    fontRecord.underlineY = yFactor*float(metrics.underlineY);
+    fontRecord.underlineThickness = float(metrics.underlineThickness);
+
+    // Name
+    const char *name = font.getName();
+    size_t nameLength = name ? strlen(name) : 0;
+    fontRecord.nameOffset = uint32_t(output.size());
+    fontRecord.nameLength = uint32_t(nameLength);
+    output.insert(output.end(), reinterpret_cast<const byte *>(name), reinterpret_cast<const byte *>(name)+nameLength);
+    output.push_back(byte(0));
+    alignOutput(output);
+
+    // Glyph records
+    std::vector<BinaryLayoutGlyph> glyphRecords;
+    glyphRecords.reserve(glyphs.size());
+    for (const GlyphGeometry &glyph : glyphs) {
+        BinaryLayoutGlyph glyphRecord = { };
+        double l, b, r, t;
+        glyphRecord.codepoint = glyph.getCodepoint();
+        glyphRecord.index = uint32_t(glyph.getIndex());
+        glyphRecord.advance = float(glyph.getAdvance());
+        glyph.getQuadPlaneBounds(l, b, r, t);
+        if (yDirection == YDirection::TOP_DOWN) {
+            double top = -b;
+            b = -t, t = top;
+        }
+        glyphRecord.planeLeft = float(l), glyphRecord.planeBottom = float(b), glyphRecord.planeRight = float(r), glyphRecord.planeTop = float(t);
+        glyph.getQuadAtlasBounds(l, b, r, t);
+        if (yDirection == YDirection::TOP_DOWN) {
+            double top = atlasHeight-b;
+            b = atlasHeight-t, t = top;
+        }
+        glyphRecord.atlasLeft = float(l), glyphRecord.atlasBottom = float(b), glyphRecord.atlasRight = float(r), glyphRecord.atlasTop = float(t);
+        glyphRecord.channel = uint32_t(glyph.getBoxChannel());
+        glyphRecords.push_back(glyphRecord);
+    }
+    fontRecord.glyphCount = uint32_t(glyphRecords.size());
+    fontRecord.glyphsOffset = uint32_t(output.size());
+    for (const BinaryLayoutGlyph &glyphRecord : glyphRecords)
+        appendRecord(output, glyphRecord);
+
+    // Two-level identifier lookup table
+    std::vector<uint32_t> pageDirectory;
+    std::vector<uint32_t> pages;
+    for (size_t i = 0; i < glyphRecords.size(); ++i) {
+        uint32_t identifier = byCodepoint ? glyphRecords[i].codepoint : glyphRecords[i].index;
+        if (byCodepoint && !identifier)
+            continue;
+        uint32_t page = identifier/BINARY_LAYOUT_PAGE_SIZE;
+        if (page >= pageDirectory.size())
+            pageDirectory.resize(page+1, BINARY_LAYOUT_NONE);
+        if (pageDirectory[page] == BINARY_LAYOUT_NONE) {
+            pageDirectory[page] = uint32_t(pages.size()/BINARY_LAYOUT_PAGE_SIZE);
+            pages.resize(pages.size()+BINARY_LAYOUT_PAGE_SIZE, BINARY_LAYOUT_NONE);
+        }
+        uint32_t &entry = pages[BINARY_LAYOUT_PAGE_SIZE*pageDirectory[page]+identifier%BINARY_LAYOUT_PAGE_SIZE];
+        if (entry == BINARY_LAYOUT_NONE)
+            entry = uint32_t(i);
+    }
+    fontRecord.pageDirectorySize = uint32_t(pageDirectory.size());
+    fontRecord.pageDirectoryOffset = uint32_t(output.size());
+    for (uint32_t page : pageDirectory)
+        appendU32(output, page);
+    fontRecord.pageCount = uint32_t(pages.size()/BINARY_LAYOUT_PAGE_SIZE);
+    fontRecord.pagesOffset = uint32_t(output.size());
+    for (uint32_t entry : pages)
+        appendU32(output, entry);
+
+    // Kerning hash table, at most half full
+    std::vector<BinaryLayoutKerningPair> kerningTable;
+    uint32_t kerningCount = 0;
+    if (kerning && !font.getKerning().empty()) {
+        uint32_t capacity = 1;
+        while (capacity < 2*font.getKerning().size())
+            capacity <<= 1;
+        BinaryLayoutKerningPair emptySlot = { BINARY_LAYOUT_NONE, BINARY_LAYOUT_NONE, 0.f };
+        kerningTable.resize(capacity, emptySlot);
+        for (const std::pair<const std::pair<int, int>, double> &kernPair : font.getKerning()) {
+            const GlyphGeometry *glyph1 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.first));
+            const GlyphGeometry *glyph2 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.second));
+            if (!(glyph1 && glyph2))
+                continue;
+            BinaryLayoutKerningPair pair = { uint32_t(glyph1-firstGlyph), uint32_t(glyph2-firstGlyph), float(kernPair.second) };
+            uint32_t slot = binaryLayoutKerningHash(pair.glyph1, pair.glyph2)&(capacity-1);
+            while (kerningTable[slot].glyph1 != BINARY_LAYOUT_NONE)
+                slot = (slot+1)&(capacity-1);
+            kerningTable[slot] = pair;
+            ++kerningCount;
+        }
+    }
+    fontRecord.kerningCapacity = uint32_t(kerningTable.size());
+    fontRecord.kerningCount = kerningCount;
+    fontRecord.kerningOffset = uint32_t(output.size());
+    for (const BinaryLayoutKerningPair &pair : kerningTable)
+        appendRecord(output, pair);
+
+    // Quad vertices
+    fontRecord.quadsOffset = 0;
+    if (quadVertices) {
+        fontRecord.quadsOffset = uint32_t(output.size());
+        float uScale = atlasWidth > 0 ? 1.f/float(atlasWidth) : 0.f;
+        float vScale = atlasHeight > 0 ? 1.f/float(atlasHeight) : 0.f;
+        for (const BinaryLayoutGlyph &g : glyphRecords) {
+            BinaryLayoutQuadVertex vertices[4] = {
+                { g.planeLeft, g.planeBottom, uScale*g.atlasLeft, vScale*g.atlasBottom },
+                { g.planeRight, g.planeBottom, uScale*g.atlasRight, vScale*g.atlasBottom },
+                { g.planeRight, g.planeTop, uScale*g.atlasRight, vScale*g.atlasTop },
+                { g.planeLeft, g.planeTop, uScale*g.atlasLeft, vScale*g.atlasTop }
+            };
+            for (const BinaryLayoutQuadVertex &vertex : vertices)
+                appendRecord(output, vertex);
+        }
+    }
+}
+
+bool encodeBinaryLayout(std::vector<byte> &output, const FontGeometry *fonts, int fontCount, double fontSize, double pxRange, int atlasWidth, int atlasHeight, ImageType imageType, YDirection yDirection, bool kerning, int packedChannelCount, bool quadVertices) {
+    if (fontCount < 0 || atlasWidth < 0 || atlasHeight < 0)
+        return false;
+
+    BinaryLayoutHeader header = { };
+    header.magic = BINARY_LAYOUT_MAGIC;
+    header.version = BINARY_LAYOUT_VERSION;
+    header.flags = (
+        (yDirection == YDirection::TOP_DOWN ? BINARY_LAYOUT_FLAG_Y_TOP_DOWN : 0u) |
+        (kerning ? BINARY_LAYOUT_FLAG_KERNING : 0u) |
+        (quadVertices ? BINARY_LAYOUT_FLAG_QUAD_VERTICES : 0u)
+    );
+    header.imageType = imageTypeCode(imageType);
+    header.distanceRange = imageType == ImageType::SDF || imageType == ImageType::PSDF || imageType == ImageType::MSDF || imageType == ImageType::MTSDF ? float(pxRange) : 0.f;
+    header.fontSize = float(fontSize);
+    header.atlasWidth = uint32_t(atlasWidth);
+    header.atlasHeight = uint32_t(atlasHeight);
+    header.packedChannels = uint32_t(packedChannelCount > 0 ? packedChannelCount : 0);
+    header.fontCount = uint32_t(fontCount);
+    header.fontsOffset = uint32_t(sizeof(BinaryLayoutHeader));
+
+    // Font records are written after their tables' offsets are known, offsets are relative to the start of the layout data
+    std::vector<byte> tables;
+    std::vector<BinaryLayoutFont> fontRecords(fontCount);
+    size_t tablesOffset = sizeof(BinaryLayoutHeader)+fontCount*sizeof(BinaryLayoutFont);
+    tables.resize(tablesOffset);
+    for (int i = 0; i < fontCount; ++i)
+        encodeFont(tables, fontRecords[i], fonts[i], atlasWidth, atlasHeight, yDirection, kerning, quadVertices);
+    if (tables.size() > 0xffffffffu)
+        return false;
+    header.size = uint32_t(tables.size());
+    writeRecord(tables, 0, header);
+    for (int i = 0; i < fontCount; ++i)
+        writeRecord(tables, sizeof(BinaryLayoutHeader)+i*sizeof(BinaryLayoutFont), fontRecords[i]);
+
+    output.insert(output.end(), tables.begin(), tables.end());
+    return true;
+}
+
+bool exportBinaryLayout(const FontGeometry *fonts, int fontCount, double fontSize, double pxRange, int atlasWidth, int atlasHeight, ImageType imageType, YDirection yDirection, const char *filename, bool kerning, int packedChannelCount, bool quadVertices) {
+    std::vector<byte> data;
+    if (!encodeBinaryLayout(data, fonts, fontCount, fontSize, pxRange, atlasWidth, atlasHeight, imageType, yDirection, kerning, packedChannelCount, quadVertices))
+        return false;
+    FILE *f = fopen(filename, "wb");
+    if (!f)
+        return false;
+    bool success = fwrite(data.data(), 1, data.size(), f) == data.size();
+    fclose(f);
+    return success;
+}
+
+}
@@ -0,0 +1,20 @@
+
+#pragma once
+
+#include <vector>
+#include "types.h"
+#include "FontGeometry.h"
+#include "BinaryLayout.h"
+
+namespace msdf_atlas {
+
+/**
+ * Encodes the font and glyph metrics, atlas layout, codepoint lookup table and kerning pairs in the binary layout format (see BinaryLayout.h).
+ * If quadVertices is true, the textured quad of each glyph is precomputed as well.
+ */
+bool encodeBinaryLayout(std::vector<byte> &output, const FontGeometry *fonts, int fontCount, double fontSize, double pxRange, int atlasWidth, int atlasHeight, ImageType imageType, YDirection yDirection, bool kerning, int packedChannelCount = 0, bool quadVertices = false);
+
+/// Writes the binary layout data into a file, which can be memory-mapped and read by BinaryLayout
+bool exportBinaryLayout(const FontGeometry *fonts, int fontCount, double fontSize, double pxRange, int atlasWidth, int atlasHeight, ImageType imageType, YDirection yDirection, const char *filename, bool kerning, int packedChannelCount = 0, bool quadVertices = false);
+
+}
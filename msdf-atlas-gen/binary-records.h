@@ -0,0 +1,25 @@
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+#include "types.h"
+
+namespace msdf_atlas {
+
+/// Writes a record consisting of 32-bit fields in little-endian byte order at the specified offset, enlarging the output if needed.
+/// Used by the binary layout and atlas bundle exporters
+template <typename T>
+void writeRecord(std::vector<byte> &output, size_t offset, const T &record) {
+    static_assert(sizeof(T)%4 == 0, "Binary records must consist of 32-bit fields");
+    if (output.size() < offset+sizeof(T))
+        output.resize(offset+sizeof(T));
+    for (size_t i = 0; i < sizeof(T); i += 4) {
+        uint32_t value;
+        memcpy(&value, reinterpret_cast<const byte *>(&record)+i, 4);
+        for (int j = 0; j < 4; ++j)
+            output[offset+i+j] = byte(value>>8*j);
+    }
+}
+
+}
@@ -6,12 +6,12 @@
 namespace msdf_atlas {
 
 template <typename T, int N>
-void blitSameType(const msdfgen::BitmapRef<T, N> &dst, const msdfgen::BitmapConstRef<T, N> &src, int dx, int dy, int sx, int sy, int w, int h) {
+void blitSameType(const BitmapSection<T, N> &dst, const BitmapConstSection<T, N> &src, int dx, int dy, int sx, int sy, int w, int h) {
     for (int y = 0; y < h; ++y)
         memcpy(dst(dx, dy+y), src(sx, sy+y), sizeof(T)*N*w);
 }
 
-#define BLIT_SAME_TYPE_IMPL(T, N) void blit(const msdfgen::BitmapRef<T, N> &dst, const msdfgen::BitmapConstRef<T, N> &src, int dx, int dy, int sx, int sy, int w, int h) { blitSameType(dst, src, dx, dy, sx, sy, w, h); }
+#define BLIT_SAME_TYPE_IMPL(T, N) void blit(const BitmapSection<T, N> &dst, const BitmapConstSection<T, N> &src, int dx, int dy, int sx, int sy, int w, int h) { blitSameType(dst, src, dx, dy, sx, sy, w, h); }
 
 BLIT_SAME_TYPE_IMPL(byte, 1)
 BLIT_SAME_TYPE_IMPL(byte, 3)
@@ -20,7 +20,7 @@ BLIT_SAME_TYPE_IMPL(float, 1)
 BLIT_SAME_TYPE_IMPL(float, 3)
 BLIT_SAME_TYPE_IMPL(float, 4)
 
-void blit(const msdfgen::BitmapRef<byte, 1> &dst, const msdfgen::BitmapConstRef<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h) {
+void blit(const BitmapSection<byte, 1> &dst, const BitmapConstSection<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h) {
     for (int y = 0; y < h; ++y) {
         byte *dstPixel = dst(dx, dy+y);
         for (int x = 0; x < w; ++x) {
@@ -30,7 +30,7 @@ void blit(const msdfgen::BitmapRef<byte, 1> &dst, const msdfgen::BitmapConstRef<
     }
 }
 
-void blit(const msdfgen::BitmapRef<byte, 3> &dst, const msdfgen::BitmapConstRef<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h) {
+void blit(const BitmapSection<byte, 3> &dst, const BitmapConstSection<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h) {
     for (int y = 0; y < h; ++y) {
         byte *dstPixel = dst(dx, dy+y);
         for (int x = 0; x < w; ++x) {
@@ -42,7 +42,7 @@ void blit(const msdfgen::BitmapRef<byte, 3> &dst, const msdfgen::BitmapConstRef<
     }
 }
 
-void blit(const msdfgen::BitmapRef<byte, 4> &dst, const msdfgen::BitmapConstRef<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h) {
+void blit(const BitmapSection<byte, 4> &dst, const BitmapConstSection<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h) {
     for (int y = 0; y < h; ++y) {
         byte *dstPixel = dst(dx, dy+y);
         for (int x = 0; x < w; ++x) {
@@ -55,4 +55,35 @@ void blit(const msdfgen::BitmapRef<byte, 4> &dst, const msdfgen::BitmapConstRef<
     }
 }
 
+static byte convertPixel(byte value, byte *) {
+    return value;
+}
+
+static float convertPixel(float value, float *) {
+    return value;
+}
+
+static byte convertPixel(float value, byte *) {
+    return msdfgen::pixelFloatToByte(value);
+}
+
+template <typename T, typename S, int N>
+void blitChannel(const BitmapSection<T, N> &dst, int dstChannel, const BitmapConstSection<S, 1> &src, int dx, int dy, int sx, int sy, int w, int h) {
+    for (int y = 0; y < h; ++y) {
+        T *dstPixel = dst(dx, dy+y)+dstChannel;
+        const S *srcPixel = src(sx, sy+y);
+        for (int x = 0; x < w; ++x, dstPixel += N)
+            *dstPixel = convertPixel(*srcPixel++, (T *) nullptr);
+    }
+}
+
+#define BLIT_CHANNEL_IMPL(T, S, N) void blit(const BitmapSection<T, N> &dst, int dstChannel, const BitmapConstSection<S, 1> &src, int dx, int dy, int sx, int sy, int w, int h) { blitChannel(dst, dstChannel, src, dx, dy, sx, sy, w, h); }
+
+BLIT_CHANNEL_IMPL(byte, byte, 3)
+BLIT_CHANNEL_IMPL(byte, byte, 4)
+BLIT_CHANNEL_IMPL(float, float, 3)
+BLIT_CHANNEL_IMPL(float, float, 4)
+BLIT_CHANNEL_IMPL(byte, float, 3)
+BLIT_CHANNEL_IMPL(byte, float, 4)
+
 }
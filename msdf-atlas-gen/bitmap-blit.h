@@ -3,24 +3,38 @@
 
 #include <msdfgen.h>
 #include "types.h"
+#include "BitmapSection.h"
 
 namespace msdf_atlas {
 
 /*
  * Copies a rectangular section from source bitmap to destination bitmap.
+ * The bitmaps may be sections of larger bitmaps or have their rows in reverse order.
  * Width and height are not checked and must not exceed bitmap bounds!
  */
 
-void blit(const msdfgen::BitmapRef<byte, 1> &dst, const msdfgen::BitmapConstRef<byte, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
-void blit(const msdfgen::BitmapRef<byte, 3> &dst, const msdfgen::BitmapConstRef<byte, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
-void blit(const msdfgen::BitmapRef<byte, 4> &dst, const msdfgen::BitmapConstRef<byte, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const BitmapSection<byte, 1> &dst, const BitmapConstSection<byte, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const BitmapSection<byte, 3> &dst, const BitmapConstSection<byte, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const BitmapSection<byte, 4> &dst, const BitmapConstSection<byte, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
 
-void blit(const msdfgen::BitmapRef<float, 1> &dst, const msdfgen::BitmapConstRef<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
-void blit(const msdfgen::BitmapRef<float, 3> &dst, const msdfgen::BitmapConstRef<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
-void blit(const msdfgen::BitmapRef<float, 4> &dst, const msdfgen::BitmapConstRef<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const BitmapSection<float, 1> &dst, const BitmapConstSection<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const BitmapSection<float, 3> &dst, const BitmapConstSection<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const BitmapSection<float, 4> &dst, const BitmapConstSection<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
 
-void blit(const msdfgen::BitmapRef<byte, 1> &dst, const msdfgen::BitmapConstRef<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
-void blit(const msdfgen::BitmapRef<byte, 3> &dst, const msdfgen::BitmapConstRef<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
-void blit(const msdfgen::BitmapRef<byte, 4> &dst, const msdfgen::BitmapConstRef<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const BitmapSection<byte, 1> &dst, const BitmapConstSection<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const BitmapSection<byte, 3> &dst, const BitmapConstSection<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const BitmapSection<byte, 4> &dst, const BitmapConstSection<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+
+/*
+ * Copies a rectangular section from single-channel source bitmap into the specified channel of destination bitmap.
+ * The remaining channels of the destination are left untouched.
+ */
+
+void blit(const BitmapSection<byte, 3> &dst, int dstChannel, const BitmapConstSection<byte, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const BitmapSection<byte, 4> &dst, int dstChannel, const BitmapConstSection<byte, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const BitmapSection<float, 3> &dst, int dstChannel, const BitmapConstSection<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const BitmapSection<float, 4> &dst, int dstChannel, const BitmapConstSection<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const BitmapSection<byte, 3> &dst, int dstChannel, const BitmapConstSection<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const BitmapSection<byte, 4> &dst, int dstChannel, const BitmapConstSection<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
 
 }
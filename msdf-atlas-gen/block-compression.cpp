@@ -0,0 +1,560 @@
+
+#include "block-compression.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "Workload.h"
+
+namespace msdf_atlas {
+
+/// Texels whose distance is within this many 8-bit units of the edge get more weight during endpoint selection
+#define EDGE_PROXIMITY_RANGE 48.0
+#define EDGE_PROXIMITY_WEIGHT 3.0
+/// Mode 6 results with a lower mean squared error per channel skip the two-subset mode search
+#define BC7_SINGLE_SUBSET_ACCEPTABLE_ERROR 1.0
+/// Number of two-subset partitions (ranked by principal axis fit) that are fully evaluated
+#define BC7_PARTITION_CANDIDATES 4
+#define BC7_REFINEMENT_PASSES 2
+
+static const int bc7Weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const int bc7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+/// BC7 two-subset partitions, bit i set means that pixel i belongs to the second subset
+static const unsigned bc7Partitions2[64] = {
+    0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80, 0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+    0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce, 0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+    0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a, 0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+    0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c, 0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22
+};
+
+/// Anchor pixel of the second subset of each BC7 two-subset partition
+static const int bc7Anchors2[64] = {
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+    15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+    6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15
+};
+
+/// Pixels of a single 4x4 block and their importance
+struct Block {
+    int pixels[16][4];
+    double weights[16];
+    /// Number of channels that contribute to the error
+    int channels;
+};
+
+/// Quantized endpoints and indices of a single BC7 subset
+struct Bc7Subset {
+    int endpoints[2][4];
+    int pBits[2];
+    int indices[16];
+    double weightedError;
+    double error;
+};
+
+class BitWriter {
+
+public:
+    explicit BitWriter(byte *output) : output(output), position(0) {
+        memset(output, 0, 16);
+    }
+    void write(unsigned value, int bits) {
+        for (int i = 0; i < bits; ++i, ++position) {
+            if (value>>i&1)
+                output[position>>3] |= byte(1<<(position&7));
+        }
+    }
+
+private:
+    byte *output;
+    int position;
+
+};
+
+static int median(int a, int b, int c) {
+    return std::max(std::min(a, b), std::min(std::max(a, b), c));
+}
+
+static double edgeWeight(int distance) {
+    double proximity = 1-fabs(distance-127.5)/EDGE_PROXIMITY_RANGE;
+    return 1+EDGE_PROXIMITY_WEIGHT*std::max(proximity, 0.);
+}
+
+template <int N>
+static void loadBlock(Block &block, const msdfgen::BitmapConstRef<byte, N> &bitmap, int blockX, int blockY, YDirection outputYDirection) {
+    for (int i = 0; i < 16; ++i) {
+        int x = std::min(4*blockX+(i&3), bitmap.width-1);
+        int row = std::min(4*blockY+(i>>2), bitmap.height-1);
+        int y = outputYDirection == YDirection::TOP_DOWN ? bitmap.height-row-1 : row;
+        const byte *pixel = bitmap(x, y);
+        for (int c = 0; c < 4; ++c)
+            block.pixels[i][c] = c < N ? pixel[c] : 255;
+        switch (N) {
+            case 1:
+                block.weights[i] = edgeWeight(pixel[0]);
+                break;
+            case 3:
+                block.weights[i] = edgeWeight(median(pixel[0], pixel[1], pixel[2]));
+                break;
+            default:
+                block.weights[i] = std::max(edgeWeight(median(pixel[0], pixel[1], pixel[2])), edgeWeight(pixel[N-1]));
+        }
+    }
+    block.channels = N;
+}
+
+static double encodeBC4(byte *output, const Block &block, int channel) {
+    int lo = 255, hi = 0, innerLo = 255, innerHi = 0;
+    bool extremes = false;
+    for (int i = 0; i < 16; ++i) {
+        int v = block.pixels[i][channel];
+        lo = std::min(lo, v), hi = std::max(hi, v);
+        if (v == 0 || v == 255)
+            extremes = true;
+        else
+            innerLo = std::min(innerLo, v), innerHi = std::max(innerHi, v);
+    }
+    // Candidate endpoints: eight interpolated values, or six interpolated values plus exact 0 and 255, which suits saturated distance fields
+    int candidates[2][2] = { { hi, lo }, { innerLo, innerHi } };
+    int candidateCount = extremes && innerLo <= innerHi ? 2 : 1;
+    double bestWeightedError = HUGE_VAL, bestError = 0;
+    for (int c = 0; c < candidateCount; ++c) {
+        int r0 = candidates[c][0], r1 = candidates[c][1];
+        int palette[8] = { r0, r1 };
+        if (r0 > r1) {
+            for (int i = 2; i < 8; ++i)
+                palette[i] = ((8-i)*r0+(i-1)*r1+3)/7;
+        } else {
+            for (int i = 2; i < 6; ++i)
+                palette[i] = ((6-i)*r0+(i-1)*r1+2)/5;
+            palette[6] = 0, palette[7] = 255;
+        }
+        unsigned long long indexBits = 0;
+        double weightedError = 0, error = 0;
+        for (int i = 0; i < 16; ++i) {
+            int v = block.pixels[i][channel];
+            int best = 0, bestDiff = abs(v-palette[0]);
+            for (int j = 1; j < 8; ++j) {
+                int diff = abs(v-palette[j]);
+                if (diff < bestDiff)
+                    best = j, bestDiff = diff;
+            }
+            indexBits |= (unsigned long long) best<<3*i;
+            error += bestDiff*bestDiff;
+            weightedError += block.weights[i]*bestDiff*bestDiff;
+        }
+        if (weightedError < bestWeightedError) {
+            bestWeightedError = weightedError, bestError = error;
+            output[0] = byte(r0), output[1] = byte(r1);
+            for (int i = 0; i < 6; ++i)
+                output[2+i] = byte(indexBits>>8*i);
+        }
+    }
+    return bestError;
+}
+
+/// Finds endpoints along the principal axis of the subset's pixels, returns the residual error of the line fit
+static double fitPrincipalAxis(double endpoints[2][4], const Block &block, unsigned mask, int channels) {
+    double mean[4] = { }, totalWeight = 0;
+    for (int i = 0; i < 16; ++i) {
+        if (mask>>i&1) {
+            for (int c = 0; c < channels; ++c)
+                mean[c] += block.weights[i]*block.pixels[i][c];
+            totalWeight += block.weights[i];
+        }
+    }
+    if (totalWeight <= 0)
+        return 0;
+    for (int c = 0; c < channels; ++c)
+        mean[c] /= totalWeight;
+    double covariance[4][4] = { };
+    for (int i = 0; i < 16; ++i) {
+        if (mask>>i&1) {
+            for (int a = 0; a < channels; ++a)
+                for (int b = 0; b < channels; ++b)
+                    covariance[a][b] += block.weights[i]*(block.pixels[i][a]-mean[a])*(block.pixels[i][b]-mean[b]);
+        }
+    }
+    int dominant = 0;
+    for (int c = 1; c < channels; ++c) {
+        if (covariance[c][c] > covariance[dominant][dominant])
+            dominant = c;
+    }
+    double axis[4] = { };
+    for (int c = 0; c < channels; ++c)
+        axis[c] = covariance[dominant][c];
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        double next[4] = { }, length = 0;
+        for (int a = 0; a < channels; ++a) {
+            for (int b = 0; b < channels; ++b)
+                next[a] += covariance[a][b]*axis[b];
+            length += next[a]*next[a];
+        }
+        if (length <= 1e-12)
+            break;
+        length = sqrt(length);
+        for (int c = 0; c < channels; ++c)
+            axis[c] = next[c]/length;
+    }
+    double axisLength = 0;
+    for (int c = 0; c < channels; ++c)
+        axisLength += axis[c]*axis[c];
+    if (axisLength <= 1e-12) {
+        for (int c = 0; c < channels; ++c)
+            endpoints[0][c] = mean[c], endpoints[1][c] = mean[c];
+        return 0;
+    }
+    axisLength = sqrt(axisLength);
+    for (int c = 0; c < channels; ++c)
+        axis[c] /= axisLength;
+    double tMin = HUGE_VAL, tMax = -HUGE_VAL, residual = 0;
+    for (int i = 0; i < 16; ++i) {
+        if (mask>>i&1) {
+            double t = 0, distanceSquared = 0;
+            for (int c = 0; c < channels; ++c)
+                t += (block.pixels[i][c]-mean[c])*axis[c];
+            for (int c = 0; c < channels; ++c) {
+                double d = block.pixels[i][c]-mean[c]-t*axis[c];
+                distanceSquared += d*d;
+            }
+            tMin = std::min(tMin, t), tMax = std::max(tMax, t);
+            residual += block.weights[i]*distanceSquared;
+        }
+    }
+    for (int c = 0; c < channels; ++c) {
+        endpoints[0][c] = std::min(std::max(mean[c]+tMin*axis[c], 0.), 255.);
+        endpoints[1][c] = std::min(std::max(mean[c]+tMax*axis[c], 0.), 255.);
+    }
+    return residual;
+}
+
+/// Mode 6 endpoint: 7 bits per channel and a unique P-bit
+static void quantizeEndpointMode6(int quantized[4], int &pBit, const double endpoint[4], int channels) {
+    double bestError = HUGE_VAL;
+    for (int p = 0; p < 2; ++p) {
+        int q[4];
+        double error = 0;
+        for (int c = 0; c < 4; ++c) {
+            if (c < channels) {
+                q[c] = std::min(std::max((int) lround(.5*(endpoint[c]-p)), 0), 127);
+                double d = (q[c]<<1|p)-endpoint[c];
+                error += d*d;
+            } else
+                q[c] = 127;
+        }
+        if (error < bestError) {
+            bestError = error;
+            memcpy(quantized, q, sizeof(q));
+            pBit = p;
+        }
+    }
+}
+
+static int unquantizeMode1(int q, int pBit) {
+    int v = q<<1|pBit;
+    return v<<1|v>>6;
+}
+
+/// Mode 1 endpoints: 6 bits per channel and a P-bit shared by both endpoints of the subset
+static void quantizeEndpointsMode1(int quantized[2][4], int &pBit, const double endpoints[2][4]) {
+    double bestError = HUGE_VAL;
+    for (int p = 0; p < 2; ++p) {
+        int q[2][4] = { };
+        double error = 0;
+        for (int e = 0; e < 2; ++e) {
+            for (int c = 0; c < 3; ++c) {
+                int estimate = (int) lround(.5*(endpoints[e][c]*127/255-p));
+                double bestChannelError = HUGE_VAL;
+                for (int candidate = estimate-1; candidate <= estimate+1; ++candidate) {
+                    if (candidate < 0 || candidate > 63)
+                        continue;
+                    double d = unquantizeMode1(candidate, p)-endpoints[e][c];
+                    if (d*d < bestChannelError)
+                        bestChannelError = d*d, q[e][c] = candidate;
+                }
+                error += bestChannelError;
+            }
+        }
+        if (error < bestError) {
+            bestError = error;
+            memcpy(quantized, q, sizeof(q));
+            pBit = p;
+        }
+    }
+}
+
+/// Selects the nearest palette entry for each pixel of the subset and evaluates the error
+static void selectIndices(Bc7Subset &subset, const Block &block, unsigned mask, const int palette[][4], int paletteSize) {
+    subset.weightedError = 0, subset.error = 0;
+    for (int i = 0; i < 16; ++i) {
+        if (mask>>i&1) {
+            int bestIndex = 0, bestDistance = 0x7fffffff;
+            for (int j = 0; j < paletteSize; ++j) {
+                int distance = 0;
+                for (int c = 0; c < block.channels; ++c) {
+                    int d = block.pixels[i][c]-palette[j][c];
+                    distance += d*d;
+                }
+                if (distance < bestDistance)
+                    bestIndex = j, bestDistance = distance;
+            }
+            subset.indices[i] = bestIndex;
+            subset.error += bestDistance;
+            subset.weightedError += block.weights[i]*bestDistance;
+        }
+    }
+}
+
+/// Least squares fit of the endpoints to the selected indices
+static bool refineEndpoints(double endpoints[2][4], const Bc7Subset &subset, const Block &block, unsigned mask, const int *interpolationWeights, int channels) {
+    double a = 0, b = 0, c = 0, x0[4] = { }, x1[4] = { };
+    for (int i = 0; i < 16; ++i) {
+        if (mask>>i&1) {
+            double t = interpolationWeights[subset.indices[i]]/64., w = block.weights[i];
+            a += w*(1-t)*(1-t), b += w*(1-t)*t, c += w*t*t;
+            for (int ch = 0; ch < channels; ++ch) {
+                x0[ch] += w*(1-t)*block.pixels[i][ch];
+                x1[ch] += w*t*block.pixels[i][ch];
+            }
+        }
+    }
+    double det = a*c-b*b;
+    if (fabs(det) < 1e-9)
+        return false;
+    for (int ch = 0; ch < channels; ++ch) {
+        endpoints[0][ch] = std::min(std::max((c*x0[ch]-b*x1[ch])/det, 0.), 255.);
+        endpoints[1][ch] = std::min(std::max((a*x1[ch]-b*x0[ch])/det, 0.), 255.);
+    }
+    return true;
+}
+
+static void buildPalette(int palette[][4], const int endpoints[2][4], const int *interpolationWeights, int paletteSize) {
+    for (int j = 0; j < paletteSize; ++j) {
+        int w = interpolationWeights[j];
+        for (int c = 0; c < 4; ++c)
+            palette[j][c] = ((64-w)*endpoints[0][c]+w*endpoints[1][c]+32)>>6;
+    }
+}
+
+static void evaluateMode6(Bc7Subset &subset, const Block &block) {
+    double endpoints[2][4] = { };
+    fitPrincipalAxis(endpoints, block, 0xffffu, block.channels);
+    subset.weightedError = HUGE_VAL;
+    for (int pass = 0; pass <= BC7_REFINEMENT_PASSES; ++pass) {
+        Bc7Subset candidate;
+        int quantized[2][4], palette[16][4];
+        for (int e = 0; e < 2; ++e) {
+            quantizeEndpointMode6(quantized[e], candidate.pBits[e], endpoints[e], block.channels);
+            for (int c = 0; c < 4; ++c)
+                candidate.endpoints[e][c] = quantized[e][c];
+            for (int c = 0; c < 4; ++c)
+                quantized[e][c] = quantized[e][c]<<1|candidate.pBits[e];
+        }
+        buildPalette(palette, quantized, bc7Weights4, 16);
+        selectIndices(candidate, block, 0xffffu, palette, 16);
+        if (candidate.weightedError < subset.weightedError)
+            subset = candidate;
+        if (!candidate.weightedError || !refineEndpoints(endpoints, candidate, block, 0xffffu, bc7Weights4, block.channels))
+            break;
+    }
+}
+
+static void evaluateMode1Subset(Bc7Subset &subset, const Block &block, unsigned mask) {
+    double endpoints[2][4] = { };
+    fitPrincipalAxis(endpoints, block, mask, 3);
+    subset.weightedError = HUGE_VAL;
+    for (int pass = 0; pass <= BC7_REFINEMENT_PASSES; ++pass) {
+        Bc7Subset candidate;
+        int quantized[2][4], palette[8][4];
+        quantizeEndpointsMode1(candidate.endpoints, candidate.pBits[0], endpoints);
+        candidate.pBits[1] = candidate.pBits[0];
+        for (int e = 0; e < 2; ++e) {
+            for (int c = 0; c < 3; ++c)
+                quantized[e][c] = unquantizeMode1(candidate.endpoints[e][c], candidate.pBits[e]);
+            quantized[e][3] = 255;
+        }
+        buildPalette(palette, quantized, bc7Weights3, 8);
+        selectIndices(candidate, block, mask, palette, 8);
+        if (candidate.weightedError < subset.weightedError)
+            subset = candidate;
+        if (!candidate.weightedError || !refineEndpoints(endpoints, candidate, block, mask, bc7Weights3, 3))
+            break;
+    }
+}
+
+/// Swaps the subset's endpoints if necessary so that the anchor pixel's index has its most significant bit clear
+static void fixAnchor(Bc7Subset &subset, unsigned mask, int anchor, int indexBits) {
+    int maxIndex = (1<<indexBits)-1;
+    if (subset.indices[anchor]>>(indexBits-1)) {
+        for (int c = 0; c < 4; ++c)
+            std::swap(subset.endpoints[0][c], subset.endpoints[1][c]);
+        std::swap(subset.pBits[0], subset.pBits[1]);
+        for (int i = 0; i < 16; ++i) {
+            if (mask>>i&1)
+                subset.indices[i] = maxIndex-subset.indices[i];
+        }
+    }
+}
+
+static void writeMode6(byte *output, Bc7Subset &subset) {
+    fixAnchor(subset, 0xffffu, 0, 4);
+    BitWriter bits(output);
+    bits.write(1u<<6, 7);
+    for (int c = 0; c < 4; ++c) {
+        bits.write(subset.endpoints[0][c], 7);
+        bits.write(subset.endpoints[1][c], 7);
+    }
+    bits.write(subset.pBits[0], 1);
+    bits.write(subset.pBits[1], 1);
+    for (int i = 0; i < 16; ++i)
+        bits.write(subset.indices[i], i ? 4 : 3);
+}
+
+static void writeMode1(byte *output, int partition, Bc7Subset subsets[2]) {
+    unsigned masks[2] = { ~bc7Partitions2[partition]&0xffffu, bc7Partitions2[partition] };
+    int anchor = bc7Anchors2[partition];
+    fixAnchor(subsets[0], masks[0], 0, 3);
+    fixAnchor(subsets[1], masks[1], anchor, 3);
+    BitWriter bits(output);
+    bits.write(1u<<1, 2);
+    bits.write(partition, 6);
+    for (int c = 0; c < 3; ++c) {
+        for (int s = 0; s < 2; ++s) {
+            bits.write(subsets[s].endpoints[0][c], 6);
+            bits.write(subsets[s].endpoints[1][c], 6);
+        }
+    }
+    bits.write(subsets[0].pBits[0], 1);
+    bits.write(subsets[1].pBits[0], 1);
+    for (int i = 0; i < 16; ++i) {
+        int s = bc7Partitions2[partition]>>i&1;
+        bits.write(subsets[s].indices[i], i == 0 || i == anchor ? 2 : 3);
+    }
+}
+
+static double encodeBC7(byte *output, const Block &block) {
+    Bc7Subset single;
+    evaluateMode6(single, block);
+    // Smooth distance field blocks are almost always represented well by the single subset mode
+    if (block.channels == 4 || single.error <= BC7_SINGLE_SUBSET_ACCEPTABLE_ERROR*16*block.channels) {
+        writeMode6(output, single);
+        return single.error;
+    }
+    // Rank two-subset partitions by how well each subset fits a line
+    std::pair<double, int> ranking[64];
+    for (int p = 0; p < 64; ++p) {
+        double endpoints[2][4];
+        ranking[p].first = fitPrincipalAxis(endpoints, block, ~bc7Partitions2[p]&0xffffu, 3)+fitPrincipalAxis(endpoints, block, bc7Partitions2[p], 3);
+        ranking[p].second = p;
+    }
+    std::partial_sort(ranking, ranking+BC7_PARTITION_CANDIDATES, ranking+64);
+    int bestPartition = -1;
+    Bc7Subset bestSubsets[2];
+    double bestWeightedError = single.weightedError;
+    for (int i = 0; i < BC7_PARTITION_CANDIDATES; ++i) {
+        int partition = ranking[i].second;
+        Bc7Subset subsets[2];
+        evaluateMode1Subset(subsets[0], block, ~bc7Partitions2[partition]&0xffffu);
+        evaluateMode1Subset(subsets[1], block, bc7Partitions2[partition]);
+        if (subsets[0].weightedError+subsets[1].weightedError < bestWeightedError) {
+            bestWeightedError = subsets[0].weightedError+subsets[1].weightedError;
+            bestPartition = partition;
+            bestSubsets[0] = subsets[0], bestSubsets[1] = subsets[1];
+        }
+    }
+    if (bestPartition < 0) {
+        writeMode6(output, single);
+        return single.error;
+    }
+    writeMode1(output, bestPartition, bestSubsets);
+    return bestSubsets[0].error+bestSubsets[1].error;
+}
+
+int getBlockSize(BlockCompression format) {
+    switch (format) {
+        case BlockCompression::NONE:
+            return 0;
+        case BlockCompression::BC4:
+            return 8;
+        case BlockCompression::BC5:
+        case BlockCompression::BC7:
+            return 16;
+    }
+    return 0;
+}
+
+template <int N>
+static bool compressBitmapBlocks(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, N> &bitmap, BlockCompression format, YDirection outputYDirection, int threadCount, std::vector<double> *blockErrors) {
+    if ((format == BlockCompression::BC5 && N < 2) || (format == BlockCompression::BC7 && N < 3) || format == BlockCompression::NONE)
+        return false;
+    int blocksX = (bitmap.width+3)/4, blocksY = (bitmap.height+3)/4;
+    int blockSize = getBlockSize(format);
+    output.resize(blockSize*blocksX*blocksY);
+    if (blockErrors)
+        blockErrors->resize(blocksX*blocksY);
+    Workload([&output, &bitmap, format, outputYDirection, blocksX, blockSize, blockErrors](int blockY, int) -> bool {
+        Block block;
+        for (int blockX = 0; blockX < blocksX; ++blockX) {
+            loadBlock(block, bitmap, blockX, blockY, outputYDirection);
+            byte *blockOutput = &output[blockSize*(blocksX*blockY+blockX)];
+            double error = 0;
+            int channels = 1;
+            switch (format) {
+                case BlockCompression::NONE:
+                    break;
+                case BlockCompression::BC4:
+                    error = encodeBC4(blockOutput, block, 0);
+                    break;
+                case BlockCompression::BC5:
+                    error = encodeBC4(blockOutput, block, 0)+encodeBC4(blockOutput+8, block, 1);
+                    channels = 2;
+                    break;
+                case BlockCompression::BC7:
+                    error = encodeBC7(blockOutput, block);
+                    channels = block.channels;
+                    break;
+            }
+            if (blockErrors)
+                (*blockErrors)[blocksX*blockY+blockX] = error/(16*channels);
+        }
+        return true;
+    }, blocksY).finish(threadCount);
+    return true;
+}
+
+bool compressBlocks(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 1> &bitmap, BlockCompression format, YDirection outputYDirection, int threadCount, std::vector<double> *blockErrors) {
+    return compressBitmapBlocks(output, bitmap, format, outputYDirection, threadCount, blockErrors);
+}
+
+bool compressBlocks(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 3> &bitmap, BlockCompression format, YDirection outputYDirection, int threadCount, std::vector<double> *blockErrors) {
+    return compressBitmapBlocks(output, bitmap, format, outputYDirection, threadCount, blockErrors);
+}
+
+bool compressBlocks(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 4> &bitmap, BlockCompression format, YDirection outputYDirection, int threadCount, std::vector<double> *blockErrors) {
+    return compressBitmapBlocks(output, bitmap, format, outputYDirection, threadCount, blockErrors);
+}
+
+void getGlyphCompressionErrors(std::vector<double> &glyphErrors, const GlyphGeometry *glyphs, int count, const std::vector<double> &blockErrors, int atlasWidth, int atlasHeight, YDirection outputYDirection) {
+    int blocksX = (atlasWidth+3)/4, blocksY = (atlasHeight+3)/4;
+    glyphErrors.resize(count);
+    for (int i = 0; i < count; ++i) {
+        int x, y, w, h;
+        glyphs[i].getBoxRect(x, y, w, h);
+        glyphErrors[i] = 0;
+        if (w <= 0 || h <= 0 || (int) blockErrors.size() < blocksX*blocksY)
+            continue;
+        int row = outputYDirection == YDirection::TOP_DOWN ? atlasHeight-(y+h) : y;
+        int bx0 = std::max(x/4, 0), bx1 = std::min((x+w-1)/4, blocksX-1);
+        int by0 = std::max(row/4, 0), by1 = std::min((row+h-1)/4, blocksY-1);
+        double totalError = 0;
+        int blockCount = 0;
+        for (int by = by0; by <= by1; ++by)
+            for (int bx = bx0; bx <= bx1; ++bx)
+                totalError += blockErrors[blocksX*by+bx], ++blockCount;
+        if (blockCount)
+            glyphErrors[i] = sqrt(totalError/blockCount);
+    }
+}
+
+}
@@ -0,0 +1,38 @@
+
+#pragma once
+
+#include <vector>
+#include <msdfgen.h>
+#include "types.h"
+#include "GlyphGeometry.h"
+
+namespace msdf_atlas {
+
+/// GPU block compression format
+enum class BlockCompression {
+    NONE,
+    /// Single channel, 8 bytes per 4x4 block
+    BC4,
+    /// Two channels (red & green), 16 bytes per 4x4 block
+    BC5,
+    /// RGB or RGBA, 16 bytes per 4x4 block
+    BC7
+};
+
+/**
+ * Compresses the bitmap into 4x4 blocks of the specified format, ordered by rows in the output Y direction.
+ * BC4 encodes the first channel, BC5 the first two channels (N >= 3), BC7 requires N = 3 or 4.
+ * The encoder prioritizes pixels near the glyph edges, where the distance field's median is close to 0.5.
+ * If blockErrors is not null, it receives the mean squared error (in 8-bit units) of each block.
+ */
+bool compressBlocks(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 1> &bitmap, BlockCompression format, YDirection outputYDirection, int threadCount = 1, std::vector<double> *blockErrors = nullptr);
+bool compressBlocks(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 3> &bitmap, BlockCompression format, YDirection outputYDirection, int threadCount = 1, std::vector<double> *blockErrors = nullptr);
+bool compressBlocks(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 4> &bitmap, BlockCompression format, YDirection outputYDirection, int threadCount = 1, std::vector<double> *blockErrors = nullptr);
+
+/// Returns the number of bytes of a single compressed 4x4 block
+int getBlockSize(BlockCompression format);
+
+/// Computes the root mean square compression error of each glyph's box from the block errors output by compressBlocks
+void getGlyphCompressionErrors(std::vector<double> &glyphErrors, const GlyphGeometry *glyphs, int count, const std::vector<double> &blockErrors, int atlasWidth, int atlasHeight, YDirection outputYDirection);
+
+}
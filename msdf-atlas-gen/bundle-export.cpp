@@ -0,0 +1,227 @@
+
+#include "bundle-export.h"
+
+#include <cstdio>
+#include <cstring>
+#include "binary-records.h"
+
+namespace msdf_atlas {
+
+static void writePadding(std::vector<byte> &output, size_t alignment) {
+    output.resize((output.size()+alignment-1)/alignment*alignment, byte(0));
+}
+
+static uint32_t rawPixelFormat(const byte *, int channels) {
+    switch (channels) {
+        case 1:
+            return ATLAS_BUNDLE_FORMAT_R8;
+        case 3:
+            return ATLAS_BUNDLE_FORMAT_RGB8;
+        case 4:
+            return ATLAS_BUNDLE_FORMAT_RGBA8;
+    }
+    return 0;
+}
+
+static uint32_t rawPixelFormat(const float *, int channels) {
+    switch (channels) {
+        case 1:
+            return ATLAS_BUNDLE_FORMAT_R32F;
+        case 3:
+            return ATLAS_BUNDLE_FORMAT_RGB32F;
+        case 4:
+            return ATLAS_BUNDLE_FORMAT_RGBA32F;
+    }
+    return 0;
+}
+
+static uint32_t compressedPixelFormat(BlockCompression blockCompression) {
+    switch (blockCompression) {
+        case BlockCompression::NONE:
+            break;
+        case BlockCompression::BC4:
+            return ATLAS_BUNDLE_FORMAT_BC4;
+        case BlockCompression::BC5:
+            return ATLAS_BUNDLE_FORMAT_BC5;
+        case BlockCompression::BC7:
+            return ATLAS_BUNDLE_FORMAT_BC7;
+    }
+    return 0;
+}
+
+/// Returns the y-th pixel row in the output Y direction
+template <typename T, int N>
+static const byte * outputRow(const msdfgen::BitmapConstRef<T, N> &bitmap, int y, YDirection outputYDirection) {
+    return reinterpret_cast<const byte *>(bitmap.pixels+N*bitmap.width*(outputYDirection == YDirection::TOP_DOWN ? bitmap.height-y-1 : y));
+}
+
+/// Appends the pixel rows in the output Y direction
+template <typename T, int N>
+static void writeRawPixels(std::vector<byte> &output, const msdfgen::BitmapConstRef<T, N> &bitmap, YDirection outputYDirection) {
+    size_t rowSize = sizeof(T)*N*bitmap.width;
+    for (int y = 0; y < bitmap.height; ++y) {
+        const byte *row = outputRow(bitmap, y, outputYDirection);
+        output.insert(output.end(), row, row+rowSize);
+    }
+}
+
+template <int N>
+static bool compressPage(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, N> &bitmap, BlockCompression blockCompression, YDirection outputYDirection, int threadCount) {
+    return compressBlocks(output, bitmap, blockCompression, outputYDirection, threadCount);
+}
+
+template <int N>
+static bool compressPage(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, N> &bitmap, BlockCompression blockCompression, YDirection outputYDirection, int threadCount) {
+    std::vector<byte> pixels(N*bitmap.width*bitmap.height);
+    for (size_t i = 0; i < pixels.size(); ++i)
+        pixels[i] = msdfgen::pixelFloatToByte(bitmap.pixels[i]);
+    return compressBlocks(output, msdfgen::BitmapConstRef<byte, N>(pixels.data(), bitmap.width, bitmap.height), blockCompression, outputYDirection, threadCount);
+}
+
+template <typename T, int N>
+static bool encodeBundle(std::vector<byte> &output, const msdfgen::BitmapConstRef<T, N> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression, int threadCount) {
+    // Page alignment is relative to the start of the output buffer
+    if (pageCount < 0 || (pageCount && !pages) || !layoutData || output.size()%ATLAS_BUNDLE_PAGE_ALIGNMENT)
+        return false;
+    std::vector<byte> bundle;
+    AtlasBundleHeader header = { };
+    header.magic = ATLAS_BUNDLE_MAGIC;
+    header.version = ATLAS_BUNDLE_VERSION;
+    header.pageCount = uint32_t(pageCount);
+    header.pagesOffset = uint32_t(sizeof(AtlasBundleHeader));
+    bundle.resize(sizeof(AtlasBundleHeader)+pageCount*sizeof(AtlasBundlePage));
+
+    writePadding(bundle, ATLAS_BUNDLE_LAYOUT_ALIGNMENT);
+    header.layoutOffset = uint32_t(bundle.size());
+    header.layoutSize = uint32_t(layoutSize);
+    bundle.insert(bundle.end(), layoutData, layoutData+layoutSize);
+
+    std::vector<AtlasBundlePage> pageRecords(pageCount);
+    for (int i = 0; i < pageCount; ++i) {
+        const msdfgen::BitmapConstRef<T, N> &bitmap = pages[i];
+        AtlasBundlePage &page = pageRecords[i];
+        page.width = uint32_t(bitmap.width);
+        page.height = uint32_t(bitmap.height);
+        writePadding(bundle, ATLAS_BUNDLE_PAGE_ALIGNMENT);
+        page.dataOffset = uint32_t(bundle.size());
+        if (blockCompression != BlockCompression::NONE) {
+            std::vector<byte> blocks;
+            if (!compressPage(blocks, bitmap, blockCompression, outputYDirection, threadCount))
+                return false;
+            page.format = compressedPixelFormat(blockCompression);
+            page.rowSize = uint32_t(getBlockSize(blockCompression)*((bitmap.width+3)/4));
+            page.rowCount = uint32_t((bitmap.height+3)/4);
+            bundle.insert(bundle.end(), blocks.begin(), blocks.end());
+        } else {
+            page.format = rawPixelFormat(bitmap.pixels, N);
+            page.rowSize = uint32_t(sizeof(T)*N*bitmap.width);
+            page.rowCount = uint32_t(bitmap.height);
+            writeRawPixels(bundle, bitmap, outputYDirection);
+        }
+        page.dataSize = uint32_t(bundle.size()-page.dataOffset);
+    }
+
+    if (bundle.size() > 0xffffffffu)
+        return false;
+    header.size = uint32_t(bundle.size());
+    writeRecord(bundle, 0, header);
+    for (int i = 0; i < pageCount; ++i)
+        writeRecord(bundle, sizeof(AtlasBundleHeader)+i*sizeof(AtlasBundlePage), pageRecords[i]);
+
+    output.insert(output.end(), bundle.begin(), bundle.end());
+    return true;
+}
+
+/// Reads the bundle file through AtlasBundle and checks that its layout data and pages match the input of encodeAtlasBundle
+template <typename T, int N>
+static bool verifyBundle(const char *filename, const msdfgen::BitmapConstRef<T, N> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression, int threadCount) {
+    std::vector<byte> bundle;
+    if (FILE *f = fopen(filename, "rb")) {
+        byte buffer[1<<16];
+        for (size_t n; (n = fread(buffer, 1, sizeof(buffer), f));)
+            bundle.insert(bundle.end(), buffer, buffer+n);
+        fclose(f);
+    } else
+        return false;
+    AtlasBundle reader;
+    if (!reader.open(bundle.data(), bundle.size()))
+        return false;
+    const AtlasBundleHeader &header = reader.getHeader();
+    if (!(reader.getPageCount() == pageCount && header.layoutSize == layoutSize && !memcmp(bundle.data()+header.layoutOffset, layoutData, layoutSize)))
+        return false;
+    for (int i = 0; i < pageCount; ++i) {
+        const AtlasBundlePage &page = reader.getPage(i);
+        if (!(page.width == uint32_t(pages[i].width) && page.height == uint32_t(pages[i].height)))
+            return false;
+        const byte *data = reinterpret_cast<const byte *>(reader.getPageData(i));
+        if (blockCompression != BlockCompression::NONE) {
+            // Block compression is deterministic, so the source page must compress to the same blocks
+            std::vector<byte> blocks;
+            if (!(
+                page.format == compressedPixelFormat(blockCompression) &&
+                compressPage(blocks, pages[i], blockCompression, outputYDirection, threadCount) &&
+                blocks.size() == page.dataSize && !memcmp(data, blocks.data(), blocks.size())
+            ))
+                return false;
+        } else {
+            size_t rowSize = sizeof(T)*N*pages[i].width;
+            if (!(page.format == rawPixelFormat(pages[i].pixels, N) && page.rowSize == rowSize && page.rowCount == page.height))
+                return false;
+            for (int y = 0; y < pages[i].height; ++y) {
+                if (memcmp(data+rowSize*y, outputRow(pages[i], y, outputYDirection), rowSize))
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool encodeAtlasBundle(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 1> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression, int threadCount) {
+    return encodeBundle(output, pages, pageCount, layoutData, layoutSize, outputYDirection, blockCompression, threadCount);
+}
+
+bool encodeAtlasBundle(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 3> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression, int threadCount) {
+    return encodeBundle(output, pages, pageCount, layoutData, layoutSize, outputYDirection, blockCompression, threadCount);
+}
+
+bool encodeAtlasBundle(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 4> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression, int threadCount) {
+    return encodeBundle(output, pages, pageCount, layoutData, layoutSize, outputYDirection, blockCompression, threadCount);
+}
+
+bool encodeAtlasBundle(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression, int threadCount) {
+    return encodeBundle(output, pages, pageCount, layoutData, layoutSize, outputYDirection, blockCompression, threadCount);
+}
+
+bool encodeAtlasBundle(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression, int threadCount) {
+    return encodeBundle(output, pages, pageCount, layoutData, layoutSize, outputYDirection, blockCompression, threadCount);
+}
+
+bool encodeAtlasBundle(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression, int threadCount) {
+    return encodeBundle(output, pages, pageCount, layoutData, layoutSize, outputYDirection, blockCompression, threadCount);
+}
+
+bool verifyAtlasBundle(const char *filename, const msdfgen::BitmapConstRef<byte, 1> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression, int threadCount) {
+    return verifyBundle(filename, pages, pageCount, layoutData, layoutSize, outputYDirection, blockCompression, threadCount);
+}
+
+bool verifyAtlasBundle(const char *filename, const msdfgen::BitmapConstRef<byte, 3> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression, int threadCount) {
+    return verifyBundle(filename, pages, pageCount, layoutData, layoutSize, outputYDirection, blockCompression, threadCount);
+}
+
+bool verifyAtlasBundle(const char *filename, const msdfgen::BitmapConstRef<byte, 4> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression, int threadCount) {
+    return verifyBundle(filename, pages, pageCount, layoutData, layoutSize, outputYDirection, blockCompression, threadCount);
+}
+
+bool verifyAtlasBundle(const char *filename, const msdfgen::BitmapConstRef<float, 1> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression, int threadCount) {
+    return verifyBundle(filename, pages, pageCount, layoutData, layoutSize, outputYDirection, blockCompression, threadCount);
+}
+
+bool verifyAtlasBundle(const char *filename, const msdfgen::BitmapConstRef<float, 3> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression, int threadCount) {
+    return verifyBundle(filename, pages, pageCount, layoutData, layoutSize, outputYDirection, blockCompression, threadCount);
+}
+
+bool verifyAtlasBundle(const char *filename, const msdfgen::BitmapConstRef<float, 4> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression, int threadCount) {
+    return verifyBundle(filename, pages, pageCount, layoutData, layoutSize, outputYDirection, blockCompression, threadCount);
+}
+
+}
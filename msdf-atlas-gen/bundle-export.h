@@ -0,0 +1,40 @@
+
+#pragma once
+
+#include <vector>
+#include <msdfgen.h>
+#include "types.h"
+#include "block-compression.h"
+#include "AtlasBundle.h"
+
+namespace msdf_atlas {
+
+/**
+ * Encodes one or more atlas pages and the binary layout data (see encodeBinaryLayout) into a single atlas bundle (see AtlasBundle.h).
+ * If block compression is enabled, floating-point pixels are converted to 8 bits first, and threadCount threads are used to compress the blocks.
+ */
+bool encodeAtlasBundle(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 1> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression = BlockCompression::NONE, int threadCount = 1);
+bool encodeAtlasBundle(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 3> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression = BlockCompression::NONE, int threadCount = 1);
+bool encodeAtlasBundle(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 4> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression = BlockCompression::NONE, int threadCount = 1);
+bool encodeAtlasBundle(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression = BlockCompression::NONE, int threadCount = 1);
+bool encodeAtlasBundle(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression = BlockCompression::NONE, int threadCount = 1);
+bool encodeAtlasBundle(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression = BlockCompression::NONE, int threadCount = 1);
+
+/**
+ * Loads an atlas bundle file through AtlasBundle (little-endian platforms only) and checks that its layout data and pages match the input it was encoded from.
+ * Block-compressed pages are compressed again for the comparison
+ */
+bool verifyAtlasBundle(const char *filename, const msdfgen::BitmapConstRef<byte, 1> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression = BlockCompression::NONE, int threadCount = 1);
+bool verifyAtlasBundle(const char *filename, const msdfgen::BitmapConstRef<byte, 3> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression = BlockCompression::NONE, int threadCount = 1);
+bool verifyAtlasBundle(const char *filename, const msdfgen::BitmapConstRef<byte, 4> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression = BlockCompression::NONE, int threadCount = 1);
+bool verifyAtlasBundle(const char *filename, const msdfgen::BitmapConstRef<float, 1> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression = BlockCompression::NONE, int threadCount = 1);
+bool verifyAtlasBundle(const char *filename, const msdfgen::BitmapConstRef<float, 3> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression = BlockCompression::NONE, int threadCount = 1);
+bool verifyAtlasBundle(const char *filename, const msdfgen::BitmapConstRef<float, 4> *pages, int pageCount, const byte *layoutData, size_t layoutSize, YDirection outputYDirection, BlockCompression blockCompression = BlockCompression::NONE, int threadCount = 1);
+
+/// Saves one or more atlas pages and the binary layout data as an atlas bundle file
+template <typename T, int N>
+bool saveAtlasBundle(const msdfgen::BitmapConstRef<T, N> *pages, int pageCount, const byte *layoutData, size_t layoutSize, const char *filename, YDirection outputYDirection, BlockCompression blockCompression = BlockCompression::NONE, int threadCount = 1);
+
+}
+
+#include "bundle-export.hpp"
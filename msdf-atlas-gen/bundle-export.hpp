@@ -0,0 +1,21 @@
+
+#include "bundle-export.h"
+
+#include <cstdio>
+
+namespace msdf_atlas {
+
+template <typename T, int N>
+bool saveAtlasBundle(const msdfgen::BitmapConstRef<T, N> *pages, int pageCount, const byte *layoutData, size_t layoutSize, const char *filename, YDirection outputYDirection, BlockCompression blockCompression, int threadCount) {
+    std::vector<byte> bundleData;
+    if (!encodeAtlasBundle(bundleData, pages, pageCount, layoutData, layoutSize, outputYDirection, blockCompression, threadCount))
+        return false;
+    bool success = false;
+    if (FILE *f = fopen(filename, "wb")) {
+        success = fwrite(bundleData.data(), 1, bundleData.size(), f) == bundleData.size();
+        fclose(f);
+    }
+    return success;
+}
+
+}
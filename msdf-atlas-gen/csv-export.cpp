@@ -3,43 +3,54 @@
 
 #include <cstdio>
 #include "GlyphGeometry.h"
+#include "BufferedWriter.h"
 
 namespace msdf_atlas {
 
-bool exportCSV(const FontGeometry *fonts, int fontCount, int atlasWidth, int atlasHeight, YDirection yDirection, const char *filename) {
+bool exportCSV(const FontGeometry *fonts, int fontCount, int atlasWidth, int atlasHeight, YDirection yDirection, const char *filename, bool channelPacked, int floatPrecision) {
     FILE *f = fopen(filename, "w");
     if (!f)
         return false;
 
-    for (int i = 0; i < fontCount; ++i) {
-        for (const GlyphGeometry &glyph : fonts[i].getGlyphs()) {
-            double l, b, r, t;
-            if (fontCount > 1)
-                fprintf(f, "%d,", i);
-            fprintf(f, "%d,%.17g,", glyph.getIdentifier(fonts[i].getPreferredIdentifierType()), glyph.getAdvance());
-            glyph.getQuadPlaneBounds(l, b, r, t);
-            switch (yDirection) {
-                case YDirection::BOTTOM_UP:
-                    fprintf(f, "%.17g,%.17g,%.17g,%.17g,", l, b, r, t);
-                    break;
-                case YDirection::TOP_DOWN:
-                    fprintf(f, "%.17g,%.17g,%.17g,%.17g,", l, -t, r, -b);
-                    break;
-            }
-            glyph.getQuadAtlasBounds(l, b, r, t);
-            switch (yDirection) {
-                case YDirection::BOTTOM_UP:
-                    fprintf(f, "%.17g,%.17g,%.17g,%.17g\n", l, b, r, t);
-                    break;
-                case YDirection::TOP_DOWN:
-                    fprintf(f, "%.17g,%.17g,%.17g,%.17g\n", l, atlasHeight-t, r, atlasHeight-b);
-                    break;
+    bool success;
+    {
+        BufferedWriter w(f);
+        w.setFloatPrecision(floatPrecision);
+        for (int i = 0; i < fontCount; ++i) {
+            for (const GlyphGeometry &glyph : fonts[i].getGlyphs()) {
+                double l, b, r, t;
+                if (fontCount > 1)
+                    w.writeInt(i), w.write(',');
+                w.writeInt(glyph.getIdentifier(fonts[i].getPreferredIdentifierType())), w.write(',');
+                w.writeDouble(glyph.getAdvance()), w.write(',');
+                glyph.getQuadPlaneBounds(l, b, r, t);
+                if (yDirection == YDirection::TOP_DOWN) {
+                    double top = -b;
+                    b = -t, t = top;
+                }
+                w.writeDouble(l), w.write(',');
+                w.writeDouble(b), w.write(',');
+                w.writeDouble(r), w.write(',');
+                w.writeDouble(t), w.write(',');
+                glyph.getQuadAtlasBounds(l, b, r, t);
+                if (yDirection == YDirection::TOP_DOWN) {
+                    double top = atlasHeight-b;
+                    b = atlasHeight-t, t = top;
+                }
+                w.writeDouble(l), w.write(',');
+                w.writeDouble(b), w.write(',');
+                w.writeDouble(r), w.write(',');
+                w.writeDouble(t);
+                if (channelPacked)
+                    w.write(','), w.writeInt(glyph.getBoxChannel());
+                w.write('\n');
             }
         }
+        success = w.flush();
     }
 
     fclose(f);
-    return true;
+    return success;
 }
 
 }
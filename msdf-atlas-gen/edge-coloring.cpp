@@ -0,0 +1,36 @@
+
+#include "edge-coloring.h"
+
+#include "Workload.h"
+
+namespace msdf_atlas {
+
+unsigned long long glyphColoringSeed(unsigned long long coloringSeed, int index, bool independent) {
+    if (independent)
+        return (MSDF_ATLAS_LCG_MULTIPLIER*(coloringSeed^(unsigned long long) index)+MSDF_ATLAS_LCG_INCREMENT)*!!coloringSeed;
+    // coloringSeed * MSDF_ATLAS_LCG_MULTIPLIER^(index+1), by repeated squaring
+    unsigned long long factor = MSDF_ATLAS_LCG_MULTIPLIER;
+    for (unsigned exponent = unsigned(index)+1; exponent; exponent >>= 1) {
+        if (exponent&1)
+            coloringSeed *= factor;
+        factor *= factor;
+    }
+    return coloringSeed;
+}
+
+void colorGlyphEdges(GlyphGeometry *glyphs, int count, void (*edgeColoring)(msdfgen::Shape &, double, unsigned long long), double angleThreshold, unsigned long long coloringSeed, bool independent, int threadCount) {
+    if (independent) {
+        Workload([glyphs, edgeColoring, angleThreshold, coloringSeed](int i, int) -> bool {
+            glyphs[i].edgeColoring(edgeColoring, angleThreshold, glyphColoringSeed(coloringSeed, i, true));
+            return true;
+        }, count).finish(threadCount);
+    } else {
+        unsigned long long glyphSeed = coloringSeed;
+        for (int i = 0; i < count; ++i) {
+            glyphSeed *= MSDF_ATLAS_LCG_MULTIPLIER;
+            glyphs[i].edgeColoring(edgeColoring, angleThreshold, glyphSeed);
+        }
+    }
+}
+
+}
@@ -0,0 +1,19 @@
+
+#pragma once
+
+#include <msdfgen.h>
+#include "GlyphGeometry.h"
+
+/// Linear congruential generator that derives the edge coloring seeds of individual glyphs from the coloring seed
+#define MSDF_ATLAS_LCG_MULTIPLIER 6364136223846793005ull
+#define MSDF_ATLAS_LCG_INCREMENT 1442695040888963407ull
+
+namespace msdf_atlas {
+
+/// Returns the edge coloring seed of the glyph at the given position. Unless independent, it is derived from the previous glyph's seed,
+/// otherwise from the position only, so that the glyphs may be colored in any order (a zero coloring seed then gives zero to all glyphs)
+unsigned long long glyphColoringSeed(unsigned long long coloringSeed, int index, bool independent);
+/// Applies edge coloring to the glyphs with the seeds of glyphColoringSeed, in parallel with threadCount threads if independent
+void colorGlyphEdges(GlyphGeometry *glyphs, int count, void (*edgeColoring)(msdfgen::Shape &, double, unsigned long long), double angleThreshold, unsigned long long coloringSeed, bool independent, int threadCount = 1);
+
+}
@@ -1,8 +1,36 @@
 
 #include "glyph-generators.h"
 
+#include <algorithm>
+
 namespace msdf_atlas {
 
+template <int N>
+static void generatePlaceholder(const msdfgen::BitmapRef<float, N> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
+    if (!(output.width > 0 && output.height > 0))
+        return;
+    // Pixel centers of the low resolution grid coincide with the centers of MSDF_ATLAS_PLACEHOLDER_DOWNSCALE-sized blocks of output pixels
+    const int downscale = MSDF_ATLAS_PLACEHOLDER_DOWNSCALE;
+    msdfgen::Bitmap<float, 1> sdf((output.width+downscale-1)/downscale, (output.height+downscale-1)/downscale);
+    msdfgen::Projection projection(msdfgen::Vector2(glyph.getBoxScale()/downscale), glyph.getBoxTranslate());
+    msdfgen::generateSDF(sdf, glyph.getShape(), projection, glyph.getBoxRange(), attribs.config);
+    if (attribs.scanlinePass)
+        msdfgen::distanceSignCorrection(sdf, glyph.getShape(), projection, MSDF_ATLAS_GLYPH_FILL_RULE);
+    for (int y = 0; y < output.height; ++y) {
+        float v = std::max((float) (y+.5)/downscale-.5f, 0.f);
+        int y0 = std::min((int) v, sdf.height()-1), y1 = std::min(y0+1, sdf.height()-1);
+        float fy = v-y0;
+        for (int x = 0; x < output.width; ++x) {
+            float u = std::max((float) (x+.5)/downscale-.5f, 0.f);
+            int x0 = std::min((int) u, sdf.width()-1), x1 = std::min(x0+1, sdf.width()-1);
+            float fx = u-x0;
+            float value = (1-fy)*((1-fx)**sdf(x0, y0)+fx**sdf(x1, y0))+fy*((1-fx)**sdf(x0, y1)+fx**sdf(x1, y1));
+            for (int i = 0; i < N; ++i)
+                output(x, y)[i] = value;
+        }
+    }
+}
+
 void scanlineGenerator(const msdfgen::BitmapRef<float, 1> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
     msdfgen::rasterize(output, glyph.getShape(), glyph.getBoxScale(), glyph.getBoxTranslate(), MSDF_ATLAS_GLYPH_FILL_RULE);
 }
@@ -49,4 +77,16 @@ void mtsdfGenerator(const msdfgen::BitmapRef<float, 4> &output, const GlyphGeome
     }
 }
 
+void placeholderGenerator(const msdfgen::BitmapRef<float, 1> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
+    generatePlaceholder(output, glyph, attribs);
+}
+
+void placeholderGenerator(const msdfgen::BitmapRef<float, 3> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
+    generatePlaceholder(output, glyph, attribs);
+}
+
+void placeholderGenerator(const msdfgen::BitmapRef<float, 4> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
+    generatePlaceholder(output, glyph, attribs);
+}
+
 }
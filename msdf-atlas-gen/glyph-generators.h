@@ -6,6 +6,7 @@
 #include "AtlasGenerator.h"
 
 #define MSDF_ATLAS_GLYPH_FILL_RULE msdfgen::FILL_NONZERO
+#define MSDF_ATLAS_PLACEHOLDER_DOWNSCALE 4
 
 namespace msdf_atlas {
 
@@ -21,5 +22,10 @@ void psdfGenerator(const msdfgen::BitmapRef<float, 1> &output, const GlyphGeomet
 void msdfGenerator(const msdfgen::BitmapRef<float, 3> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs);
 /// Generates a multi-channel and alpha-encoded true signed distance field of the glyph
 void mtsdfGenerator(const msdfgen::BitmapRef<float, 4> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs);
+/// Quickly generates an approximate placeholder for any of the above - a true signed distance field computed at reduced resolution
+/// (MSDF_ATLAS_PLACEHOLDER_DOWNSCALE) and upsampled into the box, with all channels equal
+void placeholderGenerator(const msdfgen::BitmapRef<float, 1> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs);
+void placeholderGenerator(const msdfgen::BitmapRef<float, 3> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs);
+void placeholderGenerator(const msdfgen::BitmapRef<float, 4> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs);
 
 }
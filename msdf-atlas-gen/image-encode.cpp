@@ -1,32 +1,33 @@
 
 #include "image-encode.h"
 
+#include <cstring>
 #include <lodepng.h>
 
 namespace msdf_atlas {
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 1> &bitmap) {
+bool encodePng(std::vector<byte> &output, const BitmapConstSection<msdfgen::byte, 1> &bitmap) {
     std::vector<byte> pixels(bitmap.width*bitmap.height);
     for (int y = 0; y < bitmap.height; ++y)
         memcpy(&pixels[bitmap.width*y], bitmap(0, bitmap.height-y-1), bitmap.width);
     return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_GREY);
 }
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 3> &bitmap) {
+bool encodePng(std::vector<byte> &output, const BitmapConstSection<msdfgen::byte, 3> &bitmap) {
     std::vector<byte> pixels(3*bitmap.width*bitmap.height);
     for (int y = 0; y < bitmap.height; ++y)
         memcpy(&pixels[3*bitmap.width*y], bitmap(0, bitmap.height-y-1), 3*bitmap.width);
     return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_RGB);
 }
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 4> &bitmap) {
+bool encodePng(std::vector<byte> &output, const BitmapConstSection<msdfgen::byte, 4> &bitmap) {
     std::vector<byte> pixels(4*bitmap.width*bitmap.height);
     for (int y = 0; y < bitmap.height; ++y)
         memcpy(&pixels[4*bitmap.width*y], bitmap(0, bitmap.height-y-1), 4*bitmap.width);
     return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_RGBA);
 }
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1> &bitmap) {
+bool encodePng(std::vector<byte> &output, const BitmapConstSection<float, 1> &bitmap) {
     std::vector<byte> pixels(bitmap.width*bitmap.height);
     std::vector<byte>::iterator it = pixels.begin();
     for (int y = bitmap.height-1; y >= 0; --y)
@@ -35,7 +36,7 @@ bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1
     return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_GREY);
 }
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3> &bitmap) {
+bool encodePng(std::vector<byte> &output, const BitmapConstSection<float, 3> &bitmap) {
     std::vector<byte> pixels(3*bitmap.width*bitmap.height);
     std::vector<byte>::iterator it = pixels.begin();
     for (int y = bitmap.height-1; y >= 0; --y)
@@ -47,7 +48,7 @@ bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3
     return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_RGB);
 }
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4> &bitmap) {
+bool encodePng(std::vector<byte> &output, const BitmapConstSection<float, 4> &bitmap) {
     std::vector<byte> pixels(4*bitmap.width*bitmap.height);
     std::vector<byte>::iterator it = pixels.begin();
     for (int y = bitmap.height-1; y >= 0; --y)
@@ -60,4 +61,228 @@ bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4
     return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_RGBA);
 }
 
+#define QOI_HEADER_SIZE 14
+#define QOI_COLORSPACE_LINEAR 1
+#define QOI_OP_INDEX 0x00
+#define QOI_OP_DIFF 0x40
+#define QOI_OP_LUMA 0x80
+#define QOI_OP_RUN 0xc0
+#define QOI_OP_RGB 0xfe
+#define QOI_OP_RGBA 0xff
+#define QOI_MASK_2 0xc0
+#define QOI_MAX_RUN 62
+#define QOI_MAX_PIXELS 400000000
+
+static const byte qoiEndMarker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+struct QoiPixel {
+    byte r, g, b, a;
+};
+
+static bool operator==(const QoiPixel &a, const QoiPixel &b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+static int qoiHash(const QoiPixel &px) {
+    return (3*px.r+5*px.g+7*px.b+11*px.a)%64;
+}
+
+static void writeQoiU32(byte *output, unsigned value) {
+    output[0] = byte(value>>24);
+    output[1] = byte(value>>16);
+    output[2] = byte(value>>8);
+    output[3] = byte(value);
+}
+
+static unsigned readQoiU32(const byte *input) {
+    return unsigned(input[0])<<24|unsigned(input[1])<<16|unsigned(input[2])<<8|unsigned(input[3]);
+}
+
+static QoiPixel loadQoiPixel(const byte *pixel, int channels) {
+    QoiPixel px = { pixel[0], pixel[0], pixel[0], 255 };
+    if (channels >= 3)
+        px.g = pixel[1], px.b = pixel[2];
+    if (channels == 4)
+        px.a = pixel[3];
+    return px;
+}
+
+static QoiPixel loadQoiPixel(const float *pixel, int channels) {
+    byte converted[4];
+    for (int i = 0; i < channels; ++i)
+        converted[i] = msdfgen::pixelFloatToByte(pixel[i]);
+    return loadQoiPixel(converted, channels);
+}
+
+/// Encodes the bitmap's rows from top to bottom
+template <typename T, int N>
+static bool encodeQoiPixels(std::vector<byte> &output, const BitmapConstSection<T, N> &bitmap) {
+    if (!(bitmap.width > 0 && bitmap.height > 0 && (long long) bitmap.width*bitmap.height <= QOI_MAX_PIXELS))
+        return false;
+    int channels = N == 4 ? 4 : 3;
+    output.resize(QOI_HEADER_SIZE+(size_t) (channels+1)*bitmap.width*bitmap.height+sizeof(qoiEndMarker));
+    byte *out = output.data();
+    memcpy(out, "qoif", 4);
+    writeQoiU32(out+4, bitmap.width);
+    writeQoiU32(out+8, bitmap.height);
+    out[12] = byte(channels);
+    out[13] = QOI_COLORSPACE_LINEAR;
+    out += QOI_HEADER_SIZE;
+
+    QoiPixel index[64] = { };
+    QoiPixel prev = { 0, 0, 0, 255 };
+    int run = 0;
+    for (int y = bitmap.height-1; y >= 0; --y) {
+        const T *pixel = bitmap(0, y);
+        for (int x = 0; x < bitmap.width; ++x, pixel += N) {
+            QoiPixel px = loadQoiPixel(pixel, N);
+            if (px == prev) {
+                if (++run == QOI_MAX_RUN) {
+                    *out++ = byte(QOI_OP_RUN|(run-1));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run) {
+                *out++ = byte(QOI_OP_RUN|(run-1));
+                run = 0;
+            }
+            int hash = qoiHash(px);
+            if (index[hash] == px)
+                *out++ = byte(QOI_OP_INDEX|hash);
+            else {
+                index[hash] = px;
+                if (px.a == prev.a) {
+                    signed char dr = (signed char) (px.r-prev.r);
+                    signed char dg = (signed char) (px.g-prev.g);
+                    signed char db = (signed char) (px.b-prev.b);
+                    signed char drg = (signed char) (dr-dg), dbg = (signed char) (db-dg);
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+                        *out++ = byte(QOI_OP_DIFF|(dr+2)<<4|(dg+2)<<2|(db+2));
+                    else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                        *out++ = byte(QOI_OP_LUMA|(dg+32));
+                        *out++ = byte((drg+8)<<4|(dbg+8));
+                    } else {
+                        *out++ = QOI_OP_RGB;
+                        *out++ = px.r, *out++ = px.g, *out++ = px.b;
+                    }
+                } else {
+                    *out++ = QOI_OP_RGBA;
+                    *out++ = px.r, *out++ = px.g, *out++ = px.b, *out++ = px.a;
+                }
+            }
+            prev = px;
+        }
+    }
+    if (run)
+        *out++ = byte(QOI_OP_RUN|(run-1));
+    memcpy(out, qoiEndMarker, sizeof(qoiEndMarker));
+    out += sizeof(qoiEndMarker);
+    output.resize(out-output.data());
+    return true;
+}
+
+template <int N>
+static bool decodeQoiPixels(msdfgen::Bitmap<byte, N> &output, const byte *data, size_t length) {
+    if (!data || length < QOI_HEADER_SIZE+sizeof(qoiEndMarker) || memcmp(data, "qoif", 4))
+        return false;
+    unsigned width = readQoiU32(data+4), height = readQoiU32(data+8);
+    if (!(width > 0 && height > 0 && (data[12] == 3 || data[12] == 4) && (unsigned long long) width*height <= QOI_MAX_PIXELS))
+        return false;
+    output = msdfgen::Bitmap<byte, N>(width, height);
+    const byte *in = data+QOI_HEADER_SIZE, *end = data+length-sizeof(qoiEndMarker);
+    QoiPixel index[64] = { };
+    QoiPixel px = { 0, 0, 0, 255 };
+    int run = 0;
+    for (int y = height-1; y >= 0; --y) {
+        byte *pixel = output(0, y);
+        for (unsigned x = 0; x < width; ++x, pixel += N) {
+            if (run)
+                --run;
+            else {
+                if (in >= end)
+                    return false;
+                int op = *in++;
+                if (op == QOI_OP_RGB) {
+                    if (end-in < 3)
+                        return false;
+                    px.r = in[0], px.g = in[1], px.b = in[2];
+                    in += 3;
+                } else if (op == QOI_OP_RGBA) {
+                    if (end-in < 4)
+                        return false;
+                    px.r = in[0], px.g = in[1], px.b = in[2], px.a = in[3];
+                    in += 4;
+                } else {
+                    switch (op&QOI_MASK_2) {
+                        case QOI_OP_INDEX:
+                            px = index[op];
+                            break;
+                        case QOI_OP_DIFF:
+                            px.r = byte(px.r+(op>>4&0x03)-2);
+                            px.g = byte(px.g+(op>>2&0x03)-2);
+                            px.b = byte(px.b+(op&0x03)-2);
+                            break;
+                        case QOI_OP_LUMA: {
+                            if (in >= end)
+                                return false;
+                            int dg = (op&0x3f)-32, rb = *in++;
+                            px.r = byte(px.r+dg+(rb>>4)-8);
+                            px.g = byte(px.g+dg);
+                            px.b = byte(px.b+dg+(rb&0x0f)-8);
+                            break;
+                        }
+                        case QOI_OP_RUN:
+                            run = op&0x3f;
+                            break;
+                    }
+                }
+                index[qoiHash(px)] = px;
+            }
+            pixel[0] = px.r;
+            if (N >= 3)
+                pixel[1] = px.g, pixel[2] = px.b;
+            if (N == 4)
+                pixel[3] = px.a;
+        }
+    }
+    return true;
+}
+
+bool encodeQoi(std::vector<byte> &output, const BitmapConstSection<msdfgen::byte, 1> &bitmap) {
+    return encodeQoiPixels(output, bitmap);
+}
+
+bool encodeQoi(std::vector<byte> &output, const BitmapConstSection<msdfgen::byte, 3> &bitmap) {
+    return encodeQoiPixels(output, bitmap);
+}
+
+bool encodeQoi(std::vector<byte> &output, const BitmapConstSection<msdfgen::byte, 4> &bitmap) {
+    return encodeQoiPixels(output, bitmap);
+}
+
+bool encodeQoi(std::vector<byte> &output, const BitmapConstSection<float, 1> &bitmap) {
+    return encodeQoiPixels(output, bitmap);
+}
+
+bool encodeQoi(std::vector<byte> &output, const BitmapConstSection<float, 3> &bitmap) {
+    return encodeQoiPixels(output, bitmap);
+}
+
+bool encodeQoi(std::vector<byte> &output, const BitmapConstSection<float, 4> &bitmap) {
+    return encodeQoiPixels(output, bitmap);
+}
+
+bool decodeQoi(msdfgen::Bitmap<msdfgen::byte, 1> &output, const byte *data, size_t length) {
+    return decodeQoiPixels(output, data, length);
+}
+
+bool decodeQoi(msdfgen::Bitmap<msdfgen::byte, 3> &output, const byte *data, size_t length) {
+    return decodeQoiPixels(output, data, length);
+}
+
+bool decodeQoi(msdfgen::Bitmap<msdfgen::byte, 4> &output, const byte *data, size_t length) {
+    return decodeQoiPixels(output, data, length);
+}
+
 }
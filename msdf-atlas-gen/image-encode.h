@@ -4,17 +4,31 @@
 #include <vector>
 #include <msdfgen.h>
 #include "types.h"
+#include "BitmapSection.h"
 
 namespace msdf_atlas {
 
 // Functions to encode an image as a sequence of bytes in memory
-// Only PNG format available currently
-
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 1> &bitmap);
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 3> &bitmap);
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 4> &bitmap);
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1> &bitmap);
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3> &bitmap);
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4> &bitmap);
+// Available formats are PNG and QOI
+
+bool encodePng(std::vector<byte> &output, const BitmapConstSection<msdfgen::byte, 1> &bitmap);
+bool encodePng(std::vector<byte> &output, const BitmapConstSection<msdfgen::byte, 3> &bitmap);
+bool encodePng(std::vector<byte> &output, const BitmapConstSection<msdfgen::byte, 4> &bitmap);
+bool encodePng(std::vector<byte> &output, const BitmapConstSection<float, 1> &bitmap);
+bool encodePng(std::vector<byte> &output, const BitmapConstSection<float, 3> &bitmap);
+bool encodePng(std::vector<byte> &output, const BitmapConstSection<float, 4> &bitmap);
+
+/// Encodes the bitmap in the QOI format, which is much faster to encode and decode than PNG. Single-channel bitmaps are stored as grayscale RGB
+bool encodeQoi(std::vector<byte> &output, const BitmapConstSection<msdfgen::byte, 1> &bitmap);
+bool encodeQoi(std::vector<byte> &output, const BitmapConstSection<msdfgen::byte, 3> &bitmap);
+bool encodeQoi(std::vector<byte> &output, const BitmapConstSection<msdfgen::byte, 4> &bitmap);
+bool encodeQoi(std::vector<byte> &output, const BitmapConstSection<float, 1> &bitmap);
+bool encodeQoi(std::vector<byte> &output, const BitmapConstSection<float, 3> &bitmap);
+bool encodeQoi(std::vector<byte> &output, const BitmapConstSection<float, 4> &bitmap);
+
+/// Decodes a QOI image into a bitmap with the specified number of channels (the first channel is kept if N = 1)
+bool decodeQoi(msdfgen::Bitmap<msdfgen::byte, 1> &output, const byte *data, size_t length);
+bool decodeQoi(msdfgen::Bitmap<msdfgen::byte, 3> &output, const byte *data, size_t length);
+bool decodeQoi(msdfgen::Bitmap<msdfgen::byte, 4> &output, const byte *data, size_t length);
 
 }
@@ -3,12 +3,16 @@
 
 #include <msdfgen.h>
 #include "types.h"
+#include "BitmapSection.h"
 
 namespace msdf_atlas {
 
 /// Saves the bitmap as an image file with the specified format
 template <typename T, int N>
 bool saveImage(const msdfgen::BitmapConstRef<T, N> &bitmap, ImageFormat format, const char *filename, YDirection outputYDirection = YDirection::BOTTOM_UP);
+/// Saves a bitmap section as an image file, raw binary and text formats are written without copying the pixels
+template <typename T, int N>
+bool saveImage(const BitmapConstSection<T, N> &bitmap, ImageFormat format, const char *filename, YDirection outputYDirection = YDirection::BOTTOM_UP);
 
 }
 
@@ -3,28 +3,47 @@
 
 #include <cstdio>
 #include <msdfgen-ext.h>
+#include "image-encode.h"
+#include "BufferedWriter.h"
+#include "ktx2-export.h"
+#include "bitmap-blit.h"
 
 namespace msdf_atlas {
 
 template <int N>
-bool saveImageBinary(const msdfgen::BitmapConstRef<byte, N> &bitmap, const char *filename, YDirection outputYDirection);
+bool saveImageBinary(const BitmapConstSection<byte, N> &bitmap, const char *filename, YDirection outputYDirection);
 template <int N>
-bool saveImageBinaryLE(const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection outputYDirection);
+bool saveImageBinaryLE(const BitmapConstSection<float, N> &bitmap, const char *filename, YDirection outputYDirection);
 template <int N>
-bool saveImageBinaryBE(const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection outputYDirection);
+bool saveImageBinaryBE(const BitmapConstSection<float, N> &bitmap, const char *filename, YDirection outputYDirection);
+
+template <typename T, int N>
+bool saveImageQoi(const BitmapConstSection<T, N> &bitmap, const char *filename);
 
 template <int N>
-bool saveImageText(const msdfgen::BitmapConstRef<byte, N> &bitmap, const char *filename, YDirection outputYDirection);
+bool saveImageText(const BitmapConstSection<byte, N> &bitmap, const char *filename, YDirection outputYDirection);
 template <int N>
-bool saveImageText(const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection outputYDirection);
+bool saveImageText(const BitmapConstSection<float, N> &bitmap, const char *filename, YDirection outputYDirection);
+
+template <typename T, int N>
+bool saveImage(const msdfgen::BitmapConstRef<T, N> &bitmap, ImageFormat format, const char *filename, YDirection outputYDirection) {
+    return saveImage(BitmapConstSection<T, N>(bitmap), format, filename, outputYDirection);
+}
 
 template <int N>
-bool saveImage(const msdfgen::BitmapConstRef<byte, N> &bitmap, ImageFormat format, const char *filename, YDirection outputYDirection) {
+bool saveImage(const BitmapConstSection<byte, N> &bitmap, ImageFormat format, const char *filename, YDirection outputYDirection) {
+    // Images saved by msdfgen and KTX2 files are written from tightly packed bitmaps
+    if (!bitmap.isContiguous() && (format == ImageFormat::PNG || format == ImageFormat::BMP || format == ImageFormat::TIFF || format == ImageFormat::KTX2 || format == ImageFormat::KTX2_HALF_FLOAT || format == ImageFormat::KTX2_FLOAT)) {
+        msdfgen::Bitmap<byte, N> copy(bitmap.width, bitmap.height);
+        blit(copy, bitmap, 0, 0, 0, 0, bitmap.width, bitmap.height);
+        return saveImage(BitmapConstSection<byte, N>(copy), format, filename, outputYDirection);
+    }
+    msdfgen::BitmapConstRef<byte, N> contiguous(bitmap.pixels, bitmap.width, bitmap.height);
     switch (format) {
         case ImageFormat::PNG:
-            return msdfgen::savePng(bitmap, filename);
+            return msdfgen::savePng(contiguous, filename);
         case ImageFormat::BMP:
-            return msdfgen::saveBmp(bitmap, filename);
+            return msdfgen::saveBmp(contiguous, filename);
         case ImageFormat::TIFF:
             return false;
         case ImageFormat::TEXT:
@@ -36,20 +55,34 @@ bool saveImage(const msdfgen::BitmapConstRef<byte, N> &bitmap, ImageFormat forma
         case ImageFormat::BINARY_FLOAT:
         case ImageFormat::BINARY_FLOAT_BE:
             return false;
+        case ImageFormat::KTX2:
+            return saveKtx2(&contiguous, 1, filename, outputYDirection);
+        case ImageFormat::KTX2_HALF_FLOAT:
+        case ImageFormat::KTX2_FLOAT:
+            return false;
+        case ImageFormat::QOI:
+            return saveImageQoi(bitmap, filename);
         default:;
     }
     return false;
 }
 
 template <int N>
-bool saveImage(const msdfgen::BitmapConstRef<float, N> &bitmap, ImageFormat format, const char *filename, YDirection outputYDirection) {
+bool saveImage(const BitmapConstSection<float, N> &bitmap, ImageFormat format, const char *filename, YDirection outputYDirection) {
+    // Images saved by msdfgen and KTX2 files are written from tightly packed bitmaps
+    if (!bitmap.isContiguous() && (format == ImageFormat::PNG || format == ImageFormat::BMP || format == ImageFormat::TIFF || format == ImageFormat::KTX2 || format == ImageFormat::KTX2_HALF_FLOAT || format == ImageFormat::KTX2_FLOAT)) {
+        msdfgen::Bitmap<float, N> copy(bitmap.width, bitmap.height);
+        blit(copy, bitmap, 0, 0, 0, 0, bitmap.width, bitmap.height);
+        return saveImage(BitmapConstSection<float, N>(copy), format, filename, outputYDirection);
+    }
+    msdfgen::BitmapConstRef<float, N> contiguous(bitmap.pixels, bitmap.width, bitmap.height);
     switch (format) {
         case ImageFormat::PNG:
-            return msdfgen::savePng(bitmap, filename);
+            return msdfgen::savePng(contiguous, filename);
         case ImageFormat::BMP:
-            return msdfgen::saveBmp(bitmap, filename);
+            return msdfgen::saveBmp(contiguous, filename);
         case ImageFormat::TIFF:
-            return msdfgen::saveTiff(bitmap, filename);
+            return msdfgen::saveTiff(contiguous, filename);
         case ImageFormat::TEXT:
             return false;
         case ImageFormat::TEXT_FLOAT:
@@ -60,25 +93,30 @@ bool saveImage(const msdfgen::BitmapConstRef<float, N> &bitmap, ImageFormat form
             return saveImageBinaryLE(bitmap, filename, outputYDirection);
         case ImageFormat::BINARY_FLOAT_BE:
             return saveImageBinaryBE(bitmap, filename, outputYDirection);
+        case ImageFormat::KTX2:
+            return false;
+        case ImageFormat::KTX2_HALF_FLOAT: {
+            Ktx2Properties properties;
+            properties.halfFloat = true;
+            return saveKtx2(&contiguous, 1, filename, outputYDirection, properties);
+        }
+        case ImageFormat::KTX2_FLOAT:
+            return saveKtx2(&contiguous, 1, filename, outputYDirection);
+        case ImageFormat::QOI:
+            return saveImageQoi(bitmap, filename);
         default:;
     }
     return false;
 }
 
 template <int N>
-bool saveImageBinary(const msdfgen::BitmapConstRef<byte, N> &bitmap, const char *filename, YDirection outputYDirection) {
+bool saveImageBinary(const BitmapConstSection<byte, N> &bitmap, const char *filename, YDirection outputYDirection) {
+    BitmapConstSection<byte, N> rows = outputYDirection == YDirection::TOP_DOWN ? bitmap.flipped() : bitmap;
     bool success = false;
     if (FILE *f = fopen(filename, "wb")) {
         int written = 0;
-        switch (outputYDirection) {
-            case YDirection::BOTTOM_UP:
-                written = fwrite(bitmap.pixels, 1, N*bitmap.width*bitmap.height, f);
-                break;
-            case YDirection::TOP_DOWN:
-                for (int y = bitmap.height-1; y >= 0; --y)
-                    written += fwrite(bitmap.pixels+N*bitmap.width*y, 1, N*bitmap.width, f);
-                break;
-        }
+        for (int y = 0; y < rows.height; ++y)
+            written += fwrite(rows(0, y), 1, N*rows.width, f);
         success = written == N*bitmap.width*bitmap.height;
         fclose(f);
     }
@@ -92,19 +130,13 @@ bool
     #else
         saveImageBinaryLE
     #endif
-        (const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection outputYDirection) {
+        (const BitmapConstSection<float, N> &bitmap, const char *filename, YDirection outputYDirection) {
+    BitmapConstSection<float, N> rows = outputYDirection == YDirection::TOP_DOWN ? bitmap.flipped() : bitmap;
     bool success = false;
     if (FILE *f = fopen(filename, "wb")) {
         int written = 0;
-        switch (outputYDirection) {
-            case YDirection::BOTTOM_UP:
-                written = fwrite(bitmap.pixels, sizeof(float), N*bitmap.width*bitmap.height, f);
-                break;
-            case YDirection::TOP_DOWN:
-                for (int y = bitmap.height-1; y >= 0; --y)
-                    written += fwrite(bitmap.pixels+N*bitmap.width*y, sizeof(float), N*bitmap.width, f);
-                break;
-        }
+        for (int y = 0; y < rows.height; ++y)
+            written += fwrite(rows(0, y), sizeof(float), N*rows.width, f);
         success = written == N*bitmap.width*bitmap.height;
         fclose(f);
     }
@@ -118,13 +150,14 @@ bool
     #else
         saveImageBinaryBE
     #endif
-        (const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection outputYDirection) {
+        (const BitmapConstSection<float, N> &bitmap, const char *filename, YDirection outputYDirection) {
+    BitmapConstSection<float, N> rows = outputYDirection == YDirection::TOP_DOWN ? bitmap.flipped() : bitmap;
     bool success = false;
     if (FILE *f = fopen(filename, "wb")) {
         int written = 0;
-        for (int y = 0; y < bitmap.height; ++y) {
-            const float *p = bitmap.pixels+N*bitmap.width*(outputYDirection == YDirection::TOP_DOWN ? bitmap.height-y-1 : y);
-            for (int x = 0; x < bitmap.width; ++x) {
+        for (int y = 0; y < rows.height; ++y) {
+            const float *p = rows(0, y);
+            for (int x = 0; x < rows.width; ++x) {
                 const unsigned char *b = reinterpret_cast<const unsigned char *>(p++);
                 for (int i = sizeof(float)-1; i >= 0; --i)
                     written += fwrite(b+i, 1, 1, f);
@@ -136,17 +169,36 @@ bool
     return success;
 }
 
+template <typename T, int N>
+bool saveImageQoi(const BitmapConstSection<T, N> &bitmap, const char *filename) {
+    std::vector<byte> qoiData;
+    if (!encodeQoi(qoiData, bitmap))
+        return false;
+    bool success = false;
+    if (FILE *f = fopen(filename, "wb")) {
+        success = fwrite(qoiData.data(), 1, qoiData.size(), f) == qoiData.size();
+        fclose(f);
+    }
+    return success;
+}
 
 template <int N>
-bool saveImageText(const msdfgen::BitmapConstRef<byte, N> &bitmap, const char *filename, YDirection outputYDirection) {
+bool saveImageText(const BitmapConstSection<byte, N> &bitmap, const char *filename, YDirection outputYDirection) {
+    BitmapConstSection<byte, N> rows = outputYDirection == YDirection::TOP_DOWN ? bitmap.flipped() : bitmap;
     bool success = false;
     if (FILE *f = fopen(filename, "wb")) {
-        success = true;
-        for (int y = 0; y < bitmap.height; ++y) {
-            const byte *p = bitmap.pixels+N*bitmap.width*(outputYDirection == YDirection::TOP_DOWN ? bitmap.height-y-1 : y);
-            for (int x = 0; x < N*bitmap.width; ++x)
-                success &= fprintf(f, x ? " %02X" : "%02X", (unsigned) *p++) > 0;
-            success &= fprintf(f, "\n") > 0;
+        {
+            BufferedWriter w(f);
+            for (int y = 0; y < rows.height; ++y) {
+                const byte *p = rows(0, y);
+                for (int x = 0; x < N*rows.width; ++x) {
+                    if (x)
+                        w.write(' ');
+                    w.writeHexByte(*p++);
+                }
+                w.write('\n');
+            }
+            success = w.flush();
         }
         fclose(f);
     }
@@ -154,15 +206,24 @@ bool saveImageText(const msdfgen::BitmapConstRef<byte, N> &bitmap, const char *f
 }
 
 template <int N>
-bool saveImageText(const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection outputYDirection) {
+bool saveImageText(const BitmapConstSection<float, N> &bitmap, const char *filename, YDirection outputYDirection) {
+    BitmapConstSection<float, N> rows = outputYDirection == YDirection::TOP_DOWN ? bitmap.flipped() : bitmap;
     bool success = false;
     if (FILE *f = fopen(filename, "wb")) {
-        success = true;
-        for (int y = 0; y < bitmap.height; ++y) {
-            const float *p = bitmap.pixels+N*bitmap.width*(outputYDirection == YDirection::TOP_DOWN ? bitmap.height-y-1 : y);
-            for (int x = 0; x < N*bitmap.width; ++x)
-                success &= fprintf(f, x ? " %g" : "%g", *p++) > 0;
-            success &= fprintf(f, "\n") > 0;
+        {
+            BufferedWriter w(f);
+            // Same as %g
+            w.setFloatPrecision(6);
+            for (int y = 0; y < rows.height; ++y) {
+                const float *p = rows(0, y);
+                for (int x = 0; x < N*rows.width; ++x) {
+                    if (x)
+                        w.write(' ');
+                    w.writeDouble(*p++);
+                }
+                w.write('\n');
+            }
+            success = w.flush();
         }
         fclose(f);
     }
@@ -1,45 +1,13 @@
 
 #include "json-export.h"
 
-#include <string>
+#include <vector>
 #include "GlyphGeometry.h"
+#include "BufferedWriter.h"
+#include "Workload.h"
 
 namespace msdf_atlas {
 
-static std::string escapeJsonString(const char *str) {
-    char uval[7] = "\\u0000";
-    std::string outStr;
-    while (*str) {
-        switch (*str) {
-            case '\\':
-                outStr += "\\\\";
-                break;
-            case '"':
-                outStr += "\\\"";
-                break;
-            case '\n':
-                outStr += "\\n";
-                break;
-            case '\r':
-                outStr += "\\r";
-                break;
-            case '\t':
-                outStr += "\\t";
-                break;
-            case 0x00: case 0x01: case 0x02: case 0x03: case 0x04: case 0x05: case 0x06: case 0x07: case 0x08: /* \\t */  /* \\n */  case 0x0b: case 0x0c: /* \\r */  case 0x0e: case 0x0f:
-            case 0x10: case 0x11: case 0x12: case 0x13: case 0x14: case 0x15: case 0x16: case 0x17: case 0x18: case 0x19: case 0x1a: case 0x1b: case 0x1c: case 0x1d: case 0x1e: case 0x1f:
-                uval[4] = '0'+(*str >= 0x10);
-                uval[5] = "0123456789abcdef"[*str&0x0f];
-                outStr += uval;
-                break;
-            default:
-                outStr.push_back(*str);
-        }
-        ++str;
-    }
-    return outStr;
-}
-
 static const char * imageTypeString(ImageType type) {
     switch (type) {
         case ImageType::HARD_MASK:
@@ -58,129 +26,185 @@ static const char * imageTypeString(ImageType type) {
     return nullptr;
 }
 
-bool exportJSON(const FontGeometry *fonts, int fontCount, double fontSize, double pxRange, int atlasWidth, int atlasHeight, ImageType imageType, YDirection yDirection, const char *filename, bool kerning) {
-    FILE *f = fopen(filename, "w");
-    if (!f)
-        return false;
-    fputs("{", f);
+/// Writes the metrics, glyphs and kerning of a single font variant
+static void writeFontJSON(BufferedWriter &w, const FontGeometry &font, int atlasHeight, YDirection yDirection, bool kerning, int packedChannelCount) {
+    // Font name
+    const char *name = font.getName();
+    if (name) {
+        w.write("\"name\":\"");
+        w.writeEscapedJson(name);
+        w.write("\",");
+    }
 
-    // Atlas properties
-    fputs("\"atlas\":{", f); {
-        fprintf(f, "\"type\":\"%s\",", imageTypeString(imageType));
-        if (imageType == ImageType::SDF || imageType == ImageType::PSDF || imageType == ImageType::MSDF || imageType == ImageType::MTSDF)
-            fprintf(f, "\"distanceRange\":%.17g,", pxRange);
-        fprintf(f, "\"size\":%.17g,", fontSize);
-        fprintf(f, "\"width\":%d,", atlasWidth);
-        fprintf(f, "\"height\":%d,", atlasHeight);
-        fprintf(f, "\"yOrigin\":\"%s\"", yDirection == YDirection::TOP_DOWN ? "top" : "bottom");
-    } fputs("},", f);
+    // Font metrics
+    w.write("\"metrics\":{"); {
+        double yFactor = yDirection == YDirection::TOP_DOWN ? -1 : 1;
+        const msdfgen::FontMetrics &metrics = font.getMetrics();
+        w.write("\"emSize\":"), w.writeDouble(metrics.emSize);
+        w.write(",\"lineHeight\":"), w.writeDouble(metrics.lineHeight);
+        w.write(",\"ascender\":"), w.writeDouble(yFactor*metrics.ascenderY);
+        w.write(",\"descender\":"), w.writeDouble(yFactor*metrics.descenderY);
+        w.write(",\"underlineY\":"), w.writeDouble(yFactor*metrics.underlineY);
+        w.write(",\"underlineThickness\":"), w.writeDouble(metrics.underlineThickness);
+    } w.write("},");
 
-    if (fontCount > 1)
-        fputs("\"variants\":[", f);
-    for (int i = 0; i < fontCount; ++i) {
-        const FontGeometry &font = fonts[i];
-        if (fontCount > 1)
-            fputs(i == 0 ? "{" : ",{", f);
-
-        // Font name
-        const char *name = font.getName();
-        if (name)
-            fprintf(f, "\"name\":\"%s\",", escapeJsonString(name).c_str());
-
-        // Font metrics
-        fputs("\"metrics\":{", f); {
-            double yFactor = yDirection == YDirection::TOP_DOWN ? -1 : 1;
-            const msdfgen::FontMetrics &metrics = font.getMetrics();
-            fprintf(f, "\"emSize\":%.17g,", metrics.emSize);
-            fprintf(f, "\"lineHeight\":%.17g,", metrics.lineHeight);
-            fprintf(f, "\"ascender\":%.17g,", yFactor*metrics.ascenderY);
-            fprintf(f, "\"descender\":%.17g,", yFactor*metrics.descenderY);
-            fprintf(f, "\"underlineY\":%.17g,", yFactor*metrics.underlineY);
-            fprintf(f, "\"underlineThickness\":%.17g", metrics.underlineThickness);
-        } fputs("},", f);
-
-        // Glyph mapping
-        fputs("\"glyphs\":[", f);
-        bool firstGlyph = true;
-        for (const GlyphGeometry &glyph : font.getGlyphs()) {
-            fputs(firstGlyph ? "{" : ",{", f);
-            switch (font.getPreferredIdentifierType()) {
-                case GlyphIdentifierType::GLYPH_INDEX:
-                    fprintf(f, "\"index\":%d,", glyph.getIndex());
+    // Glyph mapping
+    w.write("\"glyphs\":[");
+    bool firstGlyph = true;
+    for (const GlyphGeometry &glyph : font.getGlyphs()) {
+        w.write(firstGlyph ? "{" : ",{");
+        switch (font.getPreferredIdentifierType()) {
+            case GlyphIdentifierType::GLYPH_INDEX:
+                w.write("\"index\":"), w.writeInt(glyph.getIndex());
+                break;
+            case GlyphIdentifierType::UNICODE_CODEPOINT:
+                w.write("\"unicode\":"), w.writeUnsigned(glyph.getCodepoint());
+                break;
+        }
+        w.write(",\"advance\":"), w.writeDouble(glyph.getAdvance());
+        double l, b, r, t;
+        glyph.getQuadPlaneBounds(l, b, r, t);
+        if (l || b || r || t) {
+            switch (yDirection) {
+                case YDirection::BOTTOM_UP:
+                    w.write(",\"planeBounds\":{\"left\":"), w.writeDouble(l);
+                    w.write(",\"bottom\":"), w.writeDouble(b);
+                    w.write(",\"right\":"), w.writeDouble(r);
+                    w.write(",\"top\":"), w.writeDouble(t);
                     break;
-                case GlyphIdentifierType::UNICODE_CODEPOINT:
-                    fprintf(f, "\"unicode\":%u,", glyph.getCodepoint());
+                case YDirection::TOP_DOWN:
+                    w.write(",\"planeBounds\":{\"left\":"), w.writeDouble(l);
+                    w.write(",\"top\":"), w.writeDouble(-t);
+                    w.write(",\"right\":"), w.writeDouble(r);
+                    w.write(",\"bottom\":"), w.writeDouble(-b);
                     break;
             }
-            fprintf(f, "\"advance\":%.17g", glyph.getAdvance());
-            double l, b, r, t;
-            glyph.getQuadPlaneBounds(l, b, r, t);
-            if (l || b || r || t) {
-                switch (yDirection) {
-                    case YDirection::BOTTOM_UP:
-                        fprintf(f, ",\"planeBounds\":{\"left\":%.17g,\"bottom\":%.17g,\"right\":%.17g,\"top\":%.17g}", l, b, r, t);
-                        break;
-                    case YDirection::TOP_DOWN:
-                        fprintf(f, ",\"planeBounds\":{\"left\":%.17g,\"top\":%.17g,\"right\":%.17g,\"bottom\":%.17g}", l, -t, r, -b);
-                        break;
-                }
+            w.write('}');
+        }
+        glyph.getQuadAtlasBounds(l, b, r, t);
+        if (l || b || r || t) {
+            switch (yDirection) {
+                case YDirection::BOTTOM_UP:
+                    w.write(",\"atlasBounds\":{\"left\":"), w.writeDouble(l);
+                    w.write(",\"bottom\":"), w.writeDouble(b);
+                    w.write(",\"right\":"), w.writeDouble(r);
+                    w.write(",\"top\":"), w.writeDouble(t);
+                    break;
+                case YDirection::TOP_DOWN:
+                    w.write(",\"atlasBounds\":{\"left\":"), w.writeDouble(l);
+                    w.write(",\"top\":"), w.writeDouble(atlasHeight-t);
+                    w.write(",\"right\":"), w.writeDouble(r);
+                    w.write(",\"bottom\":"), w.writeDouble(atlasHeight-b);
+                    break;
             }
-            glyph.getQuadAtlasBounds(l, b, r, t);
-            if (l || b || r || t) {
-                switch (yDirection) {
-                    case YDirection::BOTTOM_UP:
-                        fprintf(f, ",\"atlasBounds\":{\"left\":%.17g,\"bottom\":%.17g,\"right\":%.17g,\"top\":%.17g}", l, b, r, t);
-                        break;
-                    case YDirection::TOP_DOWN:
-                        fprintf(f, ",\"atlasBounds\":{\"left\":%.17g,\"top\":%.17g,\"right\":%.17g,\"bottom\":%.17g}", l, atlasHeight-t, r, atlasHeight-b);
-                        break;
+            w.write('}');
+            if (packedChannelCount > 0)
+                w.write(",\"channel\":"), w.writeInt(glyph.getBoxChannel());
+        }
+        w.write('}');
+        firstGlyph = false;
+    } w.write(']');
+
+    // Kerning pairs
+    if (kerning) {
+        w.write(",\"kerning\":[");
+        bool firstPair = true;
+        switch (font.getPreferredIdentifierType()) {
+            case GlyphIdentifierType::GLYPH_INDEX:
+                for (const std::pair<std::pair<int, int>, double> &kernPair : font.getKerning()) {
+                    w.write(firstPair ? "{" : ",{");
+                    w.write("\"index1\":"), w.writeInt(kernPair.first.first);
+                    w.write(",\"index2\":"), w.writeInt(kernPair.first.second);
+                    w.write(",\"advance\":"), w.writeDouble(kernPair.second);
+                    w.write('}');
+                    firstPair = false;
                 }
-            }
-            fputs("}", f);
-            firstGlyph = false;
-        } fputs("]", f);
-
-        // Kerning pairs
-        if (kerning) {
-            fputs(",\"kerning\":[", f);
-            bool firstPair = true;
-            switch (font.getPreferredIdentifierType()) {
-                case GlyphIdentifierType::GLYPH_INDEX:
-                    for (const std::pair<std::pair<int, int>, double> &kernPair : font.getKerning()) {
-                        fputs(firstPair ? "{" : ",{", f);
-                        fprintf(f, "\"index1\":%d,", kernPair.first.first);
-                        fprintf(f, "\"index2\":%d,", kernPair.first.second);
-                        fprintf(f, "\"advance\":%.17g", kernPair.second);
-                        fputs("}", f);
+                break;
+            case GlyphIdentifierType::UNICODE_CODEPOINT:
+                for (const std::pair<std::pair<int, int>, double> &kernPair : font.getKerning()) {
+                    const GlyphGeometry *glyph1 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.first));
+                    const GlyphGeometry *glyph2 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.second));
+                    if (glyph1 && glyph2 && glyph1->getCodepoint() && glyph2->getCodepoint()) {
+                        w.write(firstPair ? "{" : ",{");
+                        w.write("\"unicode1\":"), w.writeUnsigned(glyph1->getCodepoint());
+                        w.write(",\"unicode2\":"), w.writeUnsigned(glyph2->getCodepoint());
+                        w.write(",\"advance\":"), w.writeDouble(kernPair.second);
+                        w.write('}');
                         firstPair = false;
                     }
-                    break;
-                case GlyphIdentifierType::UNICODE_CODEPOINT:
-                    for (const std::pair<std::pair<int, int>, double> &kernPair : font.getKerning()) {
-                        const GlyphGeometry *glyph1 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.first));
-                        const GlyphGeometry *glyph2 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.second));
-                        if (glyph1 && glyph2 && glyph1->getCodepoint() && glyph2->getCodepoint()) {
-                            fputs(firstPair ? "{" : ",{", f);
-                            fprintf(f, "\"unicode1\":%u,", glyph1->getCodepoint());
-                            fprintf(f, "\"unicode2\":%u,", glyph2->getCodepoint());
-                            fprintf(f, "\"advance\":%.17g", kernPair.second);
-                            fputs("}", f);
-                            firstPair = false;
-                        }
-                    }
-                    break;
-            } fputs("]", f);
-        }
+                }
+                break;
+        } w.write(']');
+    }
+}
+
+/// Writes the complete JSON document
+static void writeJSON(BufferedWriter &w, const FontGeometry *fonts, int fontCount, double fontSize, double pxRange, int atlasWidth, int atlasHeight, ImageType imageType, YDirection yDirection, bool kerning, int packedChannelCount, int threadCount) {
+    w.write('{');
+
+    // Atlas properties
+    w.write("\"atlas\":{"); {
+        w.write("\"type\":\""), w.write(imageTypeString(imageType)), w.write("\",");
+        if (imageType == ImageType::SDF || imageType == ImageType::PSDF || imageType == ImageType::MSDF || imageType == ImageType::MTSDF)
+            w.write("\"distanceRange\":"), w.writeDouble(pxRange), w.write(',');
+        w.write("\"size\":"), w.writeDouble(fontSize);
+        w.write(",\"width\":"), w.writeInt(atlasWidth);
+        w.write(",\"height\":"), w.writeInt(atlasHeight);
+        if (packedChannelCount > 0)
+            w.write(",\"packedChannels\":"), w.writeInt(packedChannelCount);
+        w.write(",\"yOrigin\":\""), w.write(yDirection == YDirection::TOP_DOWN ? "top" : "bottom"), w.write('"');
+    } w.write("},");
+
+    // Font variants are formatted in parallel into separate memory buffers
+    std::vector<BufferedWriter> fontOutputs(threadCount > 1 && fontCount > 1 ? fontCount : 0);
+    if (!fontOutputs.empty()) {
+        for (BufferedWriter &fontOutput : fontOutputs)
+            fontOutput.setFloatPrecision(w.getFloatPrecision());
+        Workload([&fontOutputs, fonts, atlasHeight, yDirection, kerning, packedChannelCount](int i, int) -> bool {
+            writeFontJSON(fontOutputs[i], fonts[i], atlasHeight, yDirection, kerning, packedChannelCount);
+            return true;
+        }, fontCount).finish(threadCount);
+    }
 
+    if (fontCount > 1)
+        w.write("\"variants\":[");
+    for (int i = 0; i < fontCount; ++i) {
+        if (fontCount > 1)
+            w.write(i == 0 ? "{" : ",{");
+        if (fontOutputs.empty())
+            writeFontJSON(w, fonts[i], atlasHeight, yDirection, kerning, packedChannelCount);
+        else
+            w.write(fontOutputs[i].data().data(), fontOutputs[i].data().size());
         if (fontCount > 1)
-            fputs("}", f);
+            w.write('}');
     }
     if (fontCount > 1)
-        fputs("]", f);
+        w.write(']');
 
-    fputs("}\n", f);
-    fclose(f);
+    w.write("}\n");
+}
+
+bool encodeJSON(std::vector<char> &output, const FontGeometry *fonts, int fontCount, double fontSize, double pxRange, int atlasWidth, int atlasHeight, ImageType imageType, YDirection yDirection, bool kerning, int packedChannelCount, int threadCount, int floatPrecision) {
+    BufferedWriter w;
+    w.setFloatPrecision(floatPrecision);
+    writeJSON(w, fonts, fontCount, fontSize, pxRange, atlasWidth, atlasHeight, imageType, yDirection, kerning, packedChannelCount, threadCount);
+    output = w.data();
     return true;
 }
 
+bool exportJSON(const FontGeometry *fonts, int fontCount, double fontSize, double pxRange, int atlasWidth, int atlasHeight, ImageType imageType, YDirection yDirection, const char *filename, bool kerning, int packedChannelCount, int threadCount, int floatPrecision) {
+    FILE *f = fopen(filename, "w");
+    if (!f)
+        return false;
+    bool success;
+    {
+        BufferedWriter w(f);
+        w.setFloatPrecision(floatPrecision);
+        writeJSON(w, fonts, fontCount, fontSize, pxRange, atlasWidth, atlasHeight, imageType, yDirection, kerning, packedChannelCount, threadCount);
+        success = w.flush();
+    }
+    fclose(f);
+    return success;
+}
+
 }
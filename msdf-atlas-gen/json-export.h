@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <vector>
 #include <msdfgen.h>
 #include <msdfgen-ext.h>
 #include "types.h"
@@ -8,7 +9,14 @@
 
 namespace msdf_atlas {
 
-/// Writes the font and glyph metrics and atlas layout data into a comprehensive JSON file
-bool exportJSON(const FontGeometry *fonts, int fontCount, double fontSize, double pxRange, int atlasWidth, int atlasHeight, ImageType imageType, YDirection yDirection, const char *filename, bool kerning);
+/**
+ * Writes the font and glyph metrics and atlas layout data into a comprehensive JSON file.
+ * If packedChannelCount > 0, the atlas is channel-packed and each glyph's channel is included.
+ * If threadCount > 1, multiple font variants are formatted in parallel.
+ * Floating-point values have floatPrecision significant digits, or the shortest round-trip representation if 0.
+ */
+bool exportJSON(const FontGeometry *fonts, int fontCount, double fontSize, double pxRange, int atlasWidth, int atlasHeight, ImageType imageType, YDirection yDirection, const char *filename, bool kerning, int packedChannelCount = 0, int threadCount = 1, int floatPrecision = 0);
+/// Formats the same JSON document into memory
+bool encodeJSON(std::vector<char> &output, const FontGeometry *fonts, int fontCount, double fontSize, double pxRange, int atlasWidth, int atlasHeight, ImageType imageType, YDirection yDirection, bool kerning, int packedChannelCount = 0, int threadCount = 1, int floatPrecision = 0);
 
 }
@@ -0,0 +1,428 @@
+
+#include "ktx2-export.h"
+
+#include <cstring>
+#include <algorithm>
+#include <lodepng.h>
+
+namespace msdf_atlas {
+
+#define KTX2_HEADER_SIZE 80
+#define KTX2_LEVEL_INDEX_ENTRY_SIZE 24
+#define KTX2_SUPERCOMPRESSION_NONE 0
+#define KTX2_SUPERCOMPRESSION_ZLIB 3
+
+#define KHR_DF_MODEL_RGBSDA 1
+#define KHR_DF_MODEL_BC4 131
+#define KHR_DF_MODEL_BC5 132
+#define KHR_DF_MODEL_BC7 134
+#define KHR_DF_PRIMARIES_BT709 1
+#define KHR_DF_TRANSFER_LINEAR 1
+#define KHR_DF_SAMPLE_DATATYPE_SIGNED 0x40
+#define KHR_DF_SAMPLE_DATATYPE_FLOAT 0x80
+
+static const byte ktx2Identifier[12] = { 0xab, 'K', 'T', 'X', ' ', '2', '0', 0xbb, '\r', '\n', 0x1a, '\n' };
+
+/// Layout of a single texel in the KTX2 container
+struct Ktx2TexelFormat {
+    unsigned vkFormat;
+    int channels;
+    int componentSize;
+    bool floatingPoint;
+    BlockCompression blockCompression;
+};
+
+static void writeU8(std::vector<byte> &output, unsigned value) {
+    output.push_back(byte(value));
+}
+
+static void writeU16(std::vector<byte> &output, unsigned value) {
+    output.push_back(byte(value));
+    output.push_back(byte(value>>8));
+}
+
+static void writeU32(std::vector<byte> &output, uint32_t value) {
+    for (int i = 0; i < 4; ++i)
+        output.push_back(byte(value>>8*i));
+}
+
+static void writeU64(std::vector<byte> &output, uint64_t value) {
+    for (int i = 0; i < 8; ++i)
+        output.push_back(byte(value>>8*i));
+}
+
+static void writePadding(std::vector<byte> &output, size_t alignment) {
+    while (output.size()%alignment)
+        output.push_back(byte(0));
+}
+
+static uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = bits>>16&0x8000u;
+    uint32_t mantissa = bits&0x007fffffu;
+    int exponent = int(bits>>23&0xffu)-127+15;
+    if ((bits&0x7fffffffu) >= 0x7f800000u)
+        return uint16_t(sign|0x7c00u|(mantissa ? 0x0200u : 0u));
+    if (exponent >= 31)
+        return uint16_t(sign|0x7c00u);
+    if (exponent <= 0) {
+        if (exponent < -10)
+            return uint16_t(sign);
+        mantissa |= 0x00800000u;
+        int shift = 14-exponent;
+        uint32_t half = mantissa>>shift;
+        uint32_t remainder = mantissa&((1u<<shift)-1), halfway = 1u<<(shift-1);
+        if (remainder > halfway || (remainder == halfway && (half&1u)))
+            ++half;
+        return uint16_t(sign|half);
+    }
+    uint32_t half = sign|uint32_t(exponent)<<10|mantissa>>13;
+    uint32_t remainder = mantissa&0x1fffu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half&1u)))
+        ++half;
+    return uint16_t(half);
+}
+
+static Ktx2TexelFormat texelFormat(int channels, int componentSize, bool floatingPoint, BlockCompression blockCompression) {
+    Ktx2TexelFormat format = { 0, channels, componentSize, floatingPoint, blockCompression };
+    switch (blockCompression) {
+        case BlockCompression::NONE:
+            break;
+        case BlockCompression::BC4: // VK_FORMAT_BC4_UNORM_BLOCK
+            format.vkFormat = 139, format.channels = 1, format.componentSize = 1, format.floatingPoint = false;
+            return format;
+        case BlockCompression::BC5: // VK_FORMAT_BC5_UNORM_BLOCK
+            format.vkFormat = channels >= 3 ? 141 : 0, format.channels = 2, format.componentSize = 1, format.floatingPoint = false;
+            return format;
+        case BlockCompression::BC7: // VK_FORMAT_BC7_UNORM_BLOCK
+            format.vkFormat = channels >= 3 ? 145 : 0, format.componentSize = 1, format.floatingPoint = false;
+            return format;
+    }
+    switch (componentSize) {
+        case 1: // VK_FORMAT_R8_UNORM, VK_FORMAT_R8G8B8_UNORM, VK_FORMAT_R8G8B8A8_UNORM
+            format.vkFormat = channels == 1 ? 9 : channels == 3 ? 23 : channels == 4 ? 37 : 0;
+            break;
+        case 2: // VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT
+            format.vkFormat = channels == 1 ? 76 : channels == 3 ? 90 : channels == 4 ? 97 : 0;
+            break;
+        case 4: // VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT
+            format.vkFormat = channels == 1 ? 100 : channels == 3 ? 106 : channels == 4 ? 109 : 0;
+            break;
+    }
+    return format;
+}
+
+/// Block-compressed formats are described by a single 4x4 texel block with samples covering the whole block
+static void writeCompressedDataFormatDescriptor(std::vector<byte> &output, const Ktx2TexelFormat &format, bool supercompressed) {
+    int sampleCount = format.blockCompression == BlockCompression::BC5 ? 2 : 1;
+    int blockSize = 24+16*sampleCount;
+    writeU32(output, 4+blockSize);
+    writeU32(output, 0); // vendor ID & descriptor type
+    writeU16(output, 2); // version number
+    writeU16(output, blockSize);
+    switch (format.blockCompression) {
+        case BlockCompression::BC4:
+            writeU8(output, KHR_DF_MODEL_BC4);
+            break;
+        case BlockCompression::BC5:
+            writeU8(output, KHR_DF_MODEL_BC5);
+            break;
+        default:
+            writeU8(output, KHR_DF_MODEL_BC7);
+    }
+    writeU8(output, KHR_DF_PRIMARIES_BT709);
+    writeU8(output, KHR_DF_TRANSFER_LINEAR);
+    writeU8(output, 0); // flags (straight alpha)
+    writeU32(output, 0x00000303u); // texel block dimensions (4x4x1x1)
+    writeU8(output, supercompressed ? 0 : getBlockSize(format.blockCompression)); // bytes in plane 0
+    for (int i = 1; i < 8; ++i)
+        writeU8(output, 0);
+    // Samples
+    int bitLength = 8*getBlockSize(format.blockCompression)/sampleCount;
+    for (int i = 0; i < sampleCount; ++i) {
+        writeU16(output, bitLength*i);
+        writeU8(output, bitLength-1);
+        writeU8(output, i);
+        writeU32(output, 0); // sample position
+        writeU32(output, 0);
+        writeU32(output, 0xffffffffu);
+    }
+}
+
+static void writeDataFormatDescriptor(std::vector<byte> &output, const Ktx2TexelFormat &format, bool supercompressed) {
+    static const byte channelIds[4] = { 0, 1, 2, 15 };
+    if (format.blockCompression != BlockCompression::NONE) {
+        writeCompressedDataFormatDescriptor(output, format, supercompressed);
+        return;
+    }
+    int blockSize = 24+16*format.channels;
+    writeU32(output, 4+blockSize);
+    // Basic descriptor block header
+    writeU32(output, 0); // vendor ID & descriptor type
+    writeU16(output, 2); // version number
+    writeU16(output, blockSize);
+    writeU8(output, KHR_DF_MODEL_RGBSDA);
+    writeU8(output, KHR_DF_PRIMARIES_BT709);
+    writeU8(output, KHR_DF_TRANSFER_LINEAR);
+    writeU8(output, 0); // flags (straight alpha)
+    writeU32(output, 0); // texel block dimensions (1x1x1x1)
+    writeU8(output, supercompressed ? 0 : format.channels*format.componentSize); // bytes in plane 0
+    for (int i = 1; i < 8; ++i)
+        writeU8(output, 0);
+    // Samples
+    for (int i = 0; i < format.channels; ++i) {
+        writeU16(output, 8*format.componentSize*i);
+        writeU8(output, 8*format.componentSize-1);
+        writeU8(output, (format.channels == 1 ? channelIds[0] : channelIds[i])|(format.floatingPoint ? KHR_DF_SAMPLE_DATATYPE_FLOAT|KHR_DF_SAMPLE_DATATYPE_SIGNED : 0));
+        writeU32(output, 0); // sample position
+        if (format.floatingPoint) {
+            writeU32(output, 0xbf800000u); // -1.0f
+            writeU32(output, 0x3f800000u); // +1.0f
+        } else {
+            writeU32(output, 0);
+            writeU32(output, 0xffu);
+        }
+    }
+}
+
+static void writeKeyValue(std::vector<byte> &output, const char *key, const char *value) {
+    size_t keyLength = strlen(key)+1, valueLength = strlen(value)+1;
+    writeU32(output, uint32_t(keyLength+valueLength));
+    output.insert(output.end(), reinterpret_cast<const byte *>(key), reinterpret_cast<const byte *>(key)+keyLength);
+    output.insert(output.end(), reinterpret_cast<const byte *>(value), reinterpret_cast<const byte *>(value)+valueLength);
+    writePadding(output, 4);
+}
+
+static void writeComponent(std::vector<byte> &output, byte value, const Ktx2TexelFormat &) {
+    output.push_back(value);
+}
+
+static void writeComponent(std::vector<byte> &output, float value, const Ktx2TexelFormat &format) {
+    switch (format.componentSize) {
+        case 1:
+            output.push_back(msdfgen::pixelFloatToByte(value));
+            break;
+        case 2:
+            writeU16(output, floatToHalf(value));
+            break;
+        case 4: {
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            writeU32(output, bits);
+            break;
+        }
+    }
+}
+
+/// Serializes the rows of a level in the output Y direction
+template <typename T>
+static void writeLevelPixels(std::vector<byte> &output, const T *pixels, int width, int height, const Ktx2TexelFormat &format, YDirection outputYDirection) {
+    int rowLength = format.channels*width;
+    for (int y = 0; y < height; ++y) {
+        const T *row = pixels+rowLength*(outputYDirection == YDirection::TOP_DOWN ? height-y-1 : y);
+        for (int x = 0; x < rowLength; ++x)
+            writeComponent(output, row[x], format);
+    }
+}
+
+template <int N>
+static void convertToByte(std::vector<byte> &output, const float *pixels, int width, int height) {
+    output.resize(N*width*height);
+    for (size_t i = 0; i < output.size(); ++i)
+        output[i] = msdfgen::pixelFloatToByte(pixels[i]);
+}
+
+/// Appends the level's pixels as compressed blocks
+template <int N>
+static bool writeLevelBlocks(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, N> &bitmap, const Ktx2TexelFormat &format, YDirection outputYDirection, int threadCount, std::vector<double> *blockErrors) {
+    std::vector<byte> blocks;
+    if (!compressBlocks(blocks, bitmap, format.blockCompression, outputYDirection, threadCount, blockErrors))
+        return false;
+    output.insert(output.end(), blocks.begin(), blocks.end());
+    return true;
+}
+
+template <int N>
+static bool writeLevelBlocks(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, N> &bitmap, const Ktx2TexelFormat &format, YDirection outputYDirection, int threadCount, std::vector<double> *blockErrors) {
+    std::vector<byte> pixels;
+    convertToByte<N>(pixels, bitmap.pixels, bitmap.width, bitmap.height);
+    return writeLevelBlocks(output, msdfgen::BitmapConstRef<byte, N>(pixels.data(), bitmap.width, bitmap.height), format, outputYDirection, threadCount, blockErrors);
+}
+
+template <int N>
+static void convertToFloat(std::vector<float> &output, const msdfgen::BitmapConstRef<byte, N> &bitmap) {
+    output.resize(N*bitmap.width*bitmap.height);
+    for (size_t i = 0; i < output.size(); ++i)
+        output[i] = msdfgen::pixelByteToFloat(bitmap.pixels[i]);
+}
+
+template <int N>
+static void convertToFloat(std::vector<float> &output, const msdfgen::BitmapConstRef<float, N> &bitmap) {
+    output.assign(bitmap.pixels, bitmap.pixels+N*bitmap.width*bitmap.height);
+}
+
+/// Halves the level's resolution with a box filter. Averaging distances keeps them valid distances in normalized units
+static void downsampleLevel(std::vector<float> &output, const std::vector<float> &input, int channels, int inputWidth, int inputHeight, int outputWidth, int outputHeight) {
+    output.resize(channels*outputWidth*outputHeight);
+    float *dst = output.data();
+    for (int y = 0; y < outputHeight; ++y) {
+        int y0 = std::min(2*y, inputHeight-1), y1 = std::min(2*y+1, inputHeight-1);
+        for (int x = 0; x < outputWidth; ++x) {
+            int x0 = std::min(2*x, inputWidth-1), x1 = std::min(2*x+1, inputWidth-1);
+            const float *a = &input[channels*(inputWidth*y0+x0)];
+            const float *b = &input[channels*(inputWidth*y0+x1)];
+            const float *c = &input[channels*(inputWidth*y1+x0)];
+            const float *d = &input[channels*(inputWidth*y1+x1)];
+            for (int i = 0; i < channels; ++i)
+                *dst++ = .25f*(a[i]+b[i]+c[i]+d[i]);
+        }
+    }
+}
+
+static int mipChainLength(int width, int height) {
+    int levels = 1;
+    while ((width|height) > 1)
+        width >>= 1, height >>= 1, ++levels;
+    return levels;
+}
+
+static bool writeContainer(std::vector<byte> &output, const Ktx2TexelFormat &format, int width, int height, int layerCount, std::vector<std::vector<byte> > &levels, const Ktx2Properties &properties, YDirection outputYDirection) {
+    int levelCount = (int) levels.size();
+    std::vector<size_t> uncompressedLengths(levelCount);
+    for (int i = 0; i < levelCount; ++i) {
+        uncompressedLengths[i] = levels[i].size();
+        if (properties.supercompression) {
+            std::vector<byte> compressed;
+            if (lodepng::compress(compressed, levels[i].data(), levels[i].size()))
+                return false;
+            levels[i].swap(compressed);
+        }
+    }
+
+    std::vector<byte> dfd, kvd;
+    writeDataFormatDescriptor(dfd, format, properties.supercompression);
+    writeKeyValue(kvd, "KTXorientation", outputYDirection == YDirection::TOP_DOWN ? "rd" : "ru");
+    writeKeyValue(kvd, "KTXwriter", "msdf-atlas-gen");
+
+    size_t dfdOffset = KTX2_HEADER_SIZE+KTX2_LEVEL_INDEX_ENTRY_SIZE*levelCount;
+    size_t kvdOffset = dfdOffset+dfd.size();
+    // Level data alignment must be a multiple of both 4 and the texel block size unless supercompressed
+    size_t alignment = 1;
+    if (!properties.supercompression) {
+        size_t texelBlockSize = format.blockCompression != BlockCompression::NONE ? getBlockSize(format.blockCompression) : format.channels*format.componentSize;
+        alignment = texelBlockSize;
+        while (alignment%4)
+            alignment += texelBlockSize;
+    }
+
+    output.clear();
+    output.insert(output.end(), ktx2Identifier, ktx2Identifier+sizeof(ktx2Identifier));
+    writeU32(output, format.vkFormat);
+    writeU32(output, format.componentSize);
+    writeU32(output, width);
+    writeU32(output, height);
+    writeU32(output, 0); // pixel depth
+    writeU32(output, layerCount > 1 ? layerCount : 0);
+    writeU32(output, 1); // face count
+    writeU32(output, levelCount);
+    writeU32(output, properties.supercompression ? KTX2_SUPERCOMPRESSION_ZLIB : KTX2_SUPERCOMPRESSION_NONE);
+    writeU32(output, uint32_t(dfdOffset));
+    writeU32(output, uint32_t(dfd.size()));
+    writeU32(output, uint32_t(kvdOffset));
+    writeU32(output, uint32_t(kvd.size()));
+    writeU64(output, 0); // supercompression global data offset
+    writeU64(output, 0); // supercompression global data length
+
+    // Level data is stored from the smallest level to the largest, but indexed from the largest
+    std::vector<size_t> levelOffsets(levelCount);
+    size_t offset = kvdOffset+kvd.size();
+    for (int i = levelCount-1; i >= 0; --i) {
+        offset = (offset+alignment-1)/alignment*alignment;
+        levelOffsets[i] = offset;
+        offset += levels[i].size();
+    }
+    for (int i = 0; i < levelCount; ++i) {
+        writeU64(output, levelOffsets[i]);
+        writeU64(output, levels[i].size());
+        writeU64(output, uncompressedLengths[i]);
+    }
+    output.insert(output.end(), dfd.begin(), dfd.end());
+    output.insert(output.end(), kvd.begin(), kvd.end());
+    for (int i = levelCount-1; i >= 0; --i) {
+        writePadding(output, alignment);
+        output.insert(output.end(), levels[i].begin(), levels[i].end());
+    }
+    return true;
+}
+
+template <typename T, int N>
+static bool encodeKtx2Layers(std::vector<byte> &output, const msdfgen::BitmapConstRef<T, N> *layers, int layerCount, YDirection outputYDirection, const Ktx2Properties &properties, std::vector<double> *blockErrors) {
+    if (!(layers && layerCount > 0 && layers[0].width > 0 && layers[0].height > 0))
+        return false;
+    int width = layers[0].width, height = layers[0].height;
+    for (int i = 1; i < layerCount; ++i) {
+        if (layers[i].width != width || layers[i].height != height)
+            return false;
+    }
+    bool floatingPoint = sizeof(T) == sizeof(float);
+    Ktx2TexelFormat format = texelFormat(N, floatingPoint ? properties.halfFloat ? 2 : 4 : 1, floatingPoint, properties.blockCompression);
+    bool compressed = properties.blockCompression != BlockCompression::NONE;
+    if (!format.vkFormat)
+        return false;
+    int levelCount = mipChainLength(width, height);
+    if (properties.mipLevels > 0)
+        levelCount = std::min(levelCount, properties.mipLevels);
+
+    std::vector<std::vector<byte> > levels(levelCount);
+    std::vector<float> levelPixels, nextLevelPixels;
+    for (int layer = 0; layer < layerCount; ++layer) {
+        const msdfgen::BitmapConstRef<T, N> &bitmap = layers[layer];
+        if (compressed) {
+            if (!writeLevelBlocks(levels[0], bitmap, format, outputYDirection, properties.threadCount, layer == 0 ? blockErrors : nullptr))
+                return false;
+        } else
+            writeLevelPixels(levels[0], bitmap.pixels, width, height, format, outputYDirection);
+        if (levelCount > 1)
+            convertToFloat(levelPixels, bitmap);
+        int levelWidth = width, levelHeight = height;
+        for (int level = 1; level < levelCount; ++level) {
+            int nextWidth = std::max(levelWidth>>1, 1), nextHeight = std::max(levelHeight>>1, 1);
+            downsampleLevel(nextLevelPixels, levelPixels, N, levelWidth, levelHeight, nextWidth, nextHeight);
+            levelPixels.swap(nextLevelPixels);
+            levelWidth = nextWidth, levelHeight = nextHeight;
+            if (compressed) {
+                if (!writeLevelBlocks(levels[level], msdfgen::BitmapConstRef<float, N>(levelPixels.data(), levelWidth, levelHeight), format, outputYDirection, properties.threadCount, nullptr))
+                    return false;
+            } else
+                writeLevelPixels(levels[level], levelPixels.data(), levelWidth, levelHeight, format, outputYDirection);
+        }
+    }
+    return writeContainer(output, format, width, height, layerCount, levels, properties, outputYDirection);
+}
+
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 1> *layers, int layerCount, YDirection outputYDirection, const Ktx2Properties &properties, std::vector<double> *blockErrors) {
+    return encodeKtx2Layers(output, layers, layerCount, outputYDirection, properties, blockErrors);
+}
+
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 3> *layers, int layerCount, YDirection outputYDirection, const Ktx2Properties &properties, std::vector<double> *blockErrors) {
+    return encodeKtx2Layers(output, layers, layerCount, outputYDirection, properties, blockErrors);
+}
+
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 4> *layers, int layerCount, YDirection outputYDirection, const Ktx2Properties &properties, std::vector<double> *blockErrors) {
+    return encodeKtx2Layers(output, layers, layerCount, outputYDirection, properties, blockErrors);
+}
+
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1> *layers, int layerCount, YDirection outputYDirection, const Ktx2Properties &properties, std::vector<double> *blockErrors) {
+    return encodeKtx2Layers(output, layers, layerCount, outputYDirection, properties, blockErrors);
+}
+
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3> *layers, int layerCount, YDirection outputYDirection, const Ktx2Properties &properties, std::vector<double> *blockErrors) {
+    return encodeKtx2Layers(output, layers, layerCount, outputYDirection, properties, blockErrors);
+}
+
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4> *layers, int layerCount, YDirection outputYDirection, const Ktx2Properties &properties, std::vector<double> *blockErrors) {
+    return encodeKtx2Layers(output, layers, layerCount, outputYDirection, properties, blockErrors);
+}
+
+}
@@ -0,0 +1,44 @@
+
+#pragma once
+
+#include <vector>
+#include <msdfgen.h>
+#include "types.h"
+#include "block-compression.h"
+
+namespace msdf_atlas {
+
+/// Configuration of the KTX2 texture container output
+struct Ktx2Properties {
+    /// Number of mipmap levels, 0 = complete mipmap chain down to 1x1
+    int mipLevels = 1;
+    /// Floating-point pixels are stored as 16-bit half floats instead of 32-bit floats
+    bool halfFloat = false;
+    /// Each mipmap level is compressed by zlib (KTX2 supercompression scheme 3)
+    bool supercompression = false;
+    /// Pixels are stored as 4x4 compressed blocks of this format, floating-point pixels are converted to 8 bits first
+    BlockCompression blockCompression = BlockCompression::NONE;
+    /// Number of threads used for block compression
+    int threadCount = 1;
+};
+
+/**
+ * Encodes one or more equally sized atlas pages as a KTX2 texture.
+ * If layerCount > 1, the pages are stored as layers of an array texture.
+ * Mipmap levels are downsampled from the distance field values, so the pixel range of level L is pxRange / 2^L.
+ * If block compression is enabled and blockErrors is not null, it receives the per-block errors of the first layer's base level.
+ */
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 1> *layers, int layerCount, YDirection outputYDirection, const Ktx2Properties &properties = Ktx2Properties(), std::vector<double> *blockErrors = nullptr);
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 3> *layers, int layerCount, YDirection outputYDirection, const Ktx2Properties &properties = Ktx2Properties(), std::vector<double> *blockErrors = nullptr);
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 4> *layers, int layerCount, YDirection outputYDirection, const Ktx2Properties &properties = Ktx2Properties(), std::vector<double> *blockErrors = nullptr);
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1> *layers, int layerCount, YDirection outputYDirection, const Ktx2Properties &properties = Ktx2Properties(), std::vector<double> *blockErrors = nullptr);
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3> *layers, int layerCount, YDirection outputYDirection, const Ktx2Properties &properties = Ktx2Properties(), std::vector<double> *blockErrors = nullptr);
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4> *layers, int layerCount, YDirection outputYDirection, const Ktx2Properties &properties = Ktx2Properties(), std::vector<double> *blockErrors = nullptr);
+
+/// Saves one or more equally sized atlas pages as a KTX2 texture file
+template <typename T, int N>
+bool saveKtx2(const msdfgen::BitmapConstRef<T, N> *layers, int layerCount, const char *filename, YDirection outputYDirection, const Ktx2Properties &properties = Ktx2Properties(), std::vector<double> *blockErrors = nullptr);
+
+}
+
+#include "ktx2-export.hpp"
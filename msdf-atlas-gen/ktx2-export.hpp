@@ -0,0 +1,21 @@
+
+#include "ktx2-export.h"
+
+#include <cstdio>
+
+namespace msdf_atlas {
+
+template <typename T, int N>
+bool saveKtx2(const msdfgen::BitmapConstRef<T, N> *layers, int layerCount, const char *filename, YDirection outputYDirection, const Ktx2Properties &properties, std::vector<double> *blockErrors) {
+    std::vector<byte> ktx2Data;
+    if (!encodeKtx2(ktx2Data, layers, layerCount, outputYDirection, properties, blockErrors))
+        return false;
+    bool success = false;
+    if (FILE *f = fopen(filename, "wb")) {
+        success = fwrite(ktx2Data.data(), 1, ktx2Data.size(), f) == ktx2Data.size();
+        fclose(f);
+    }
+    return success;
+}
+
+}
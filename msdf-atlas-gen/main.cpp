@@ -12,10 +12,31 @@
 #include <cstdio>
 #include <cmath>
 #include <cstring>
+#include <cctype>
 #include <cassert>
 #include <vector>
+#include <string>
+#include <map>
+#include <memory>
 #include <algorithm>
 #include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cerrno>
+#include <sys/stat.h>
+#ifdef _WIN32
+    #include <io.h>
+    #define dup _dup
+    #define dup2 _dup2
+    #define fileno _fileno
+    #define fdopen _fdopen
+#else
+    #include <unistd.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+#endif
 
 #include "msdf-atlas-gen.h"
 
@@ -26,8 +47,8 @@ using namespace msdf_atlas;
 #define DEFAULT_PIXEL_RANGE 2.0
 #define SDF_ERROR_ESTIMATE_PRECISION 19
 #define GLYPH_FILL_RULE msdfgen::FILL_NONZERO
-#define LCG_MULTIPLIER 6364136223846793005ull
-#define LCG_INCREMENT 1442695040888963407ull
+/// Maximum number of font inputs whose glyph geometry is kept in memory by batch and server modes
+#define MAX_CACHED_FONT_INPUTS 64
 
 #ifdef MSDFGEN_USE_SKIA
     #define TITLE_SUFFIX    " & Skia"
@@ -58,8 +79,16 @@ INPUT SPECIFICATION
 ATLAS CONFIGURATION
   -type <hardmask / softmask / sdf / psdf / msdf / mtsdf>
       Selects the type of atlas to be generated.
-  -format <png / bmp / tiff / text / textfloat / bin / binfloat / binfloatbe>
+  -channelpack <N>
+      Distributes the glyphs of a single-channel atlas type into N = 2 to 4 channels of one texture.
+  -format <png / qoi / bmp / tiff / text / textfloat / bin / binfloat / binfloatbe / ktx2 / ktx2half / ktx2float>
       Selects the format for the atlas image output. Some image formats may be incompatible with embedded output formats.
+  -mipmaps <N>
+      Sets the number of mipmap levels stored in the KTX2 output. (0 = complete mipmap chain)
+  -supercompress
+      Compresses the mipmap levels of the KTX2 output by zlib supercompression.
+  -blockcompression <auto / bc4 / bc5 / bc7 / none>
+      Stores the KTX2 or bundle output as GPU block-compressed texture. Auto selects BC7 for MSDF / MTSDF and BC4 otherwise.
   -dimensions <width> <height>
       Sets the atlas to have fixed dimensions (width x height).
   -pots / -potr / -square / -square2 / -square4
@@ -75,6 +104,16 @@ OUTPUT SPECIFICATION - one or more can be specified
       Writes the atlas's layout data, as well as other metrics into a structured JSON file.
   -csv <filename.csv>
       Writes the layout data of the glyphs into a simple CSV file.
+  -floatprecision <N>
+      Writes floating-point values in the JSON and CSV files with N significant digits. (0 = shortest exact representation)
+  -binlayout <filename.bin>
+      Writes the layout data and metrics into a binary file that can be memory-mapped and read without parsing (see BinaryLayout.h).
+  -layoutquads
+      Includes precomputed vertices of the glyph quads in the binary layout file.
+  -bundle <filename.msdfb>
+      Stores the atlas texture and its binary layout data in a single file that can be memory-mapped (see AtlasBundle.h).
+  -verify
+      Loads the saved bundle file back and checks that its texture and layout data match the generated atlas.
   -arfont <filename.arfont>
       Stores the atlas and its layout data as an Artery Font file. Supported formats: png, bin, binfloat.
   -shadronpreview <filename.shadron> <sample text>
@@ -125,6 +164,29 @@ R"(
       Sets the initial seed for the edge coloring heuristic.
   -threads <N>
       Sets the number of threads for the parallel computation. (0 = auto)
+  -memlimit <bytes>
+      Generates the atlas in bands that fit within the memory limit (K, M, or G suffix allowed) and streams them into the
+      image file. Glyph shapes are only loaded during their generation. Supports png, bin, binfloat, and binfloatbe formats.
+  -mmap
+      Generates the atlas directly in the memory-mapped -imageout file instead of memory (bin / binfloat formats, -yorigin bottom).
+
+BATCH MODE
+  -batch <manifest.txt>
+      Generates multiple atlases, each specified by the arguments on one line of the manifest (# starts a comment).
+      The remaining command line arguments apply to every job, -threads sets the size of the shared thread pool.
+
+SHARDED GENERATION - each step is run with the same arguments, the generation steps may run in separate processes
+  -shardplan <filename> <N>
+      Packs the atlas and divides it into N shards, whose layout is written into a plan file.
+  -shard <plan filename> <index>
+      Generates only the glyphs of one shard into a partial image file (the plan filename followed by .<index>).
+  -shardmerge <plan filename>
+      Composes the atlas from the partial images of all shards and writes the outputs.
+
+SERVER MODE
+  -serve <stdio / socket path>
+      Processes atlas jobs on request, keeping the loaded fonts in memory. Each request is a line consisting of an identifier
+      followed by the job's arguments (and -inline to receive the output files' contents), or -shutdown to stop the server.
 )";
 
 static const char *errorCorrectionHelpText = R"(
@@ -154,20 +216,37 @@ static char toupper(char c) {
 }
 
 static bool parseUnsigned(unsigned &value, const char *arg) {
-    static char c;
+    char c;
     return sscanf(arg, "%u%c", &value, &c) == 1;
 }
 
 static bool parseUnsignedLL(unsigned long long &value, const char *arg) {
-    static char c;
+    char c;
     return sscanf(arg, "%llu%c", &value, &c) == 1;
 }
 
 static bool parseDouble(double &value, const char *arg) {
-    static char c;
+    char c;
     return sscanf(arg, "%lf%c", &value, &c) == 1;
 }
 
+static bool parseByteSize(size_t &value, const char *arg) {
+    unsigned long long size;
+    char c1, c2;
+    int result = sscanf(arg, "%llu%c%c", &size, &c1, &c2);
+    if (result == 2) {
+        switch (c1) {
+            case 'k': case 'K': size <<= 10; break;
+            case 'm': case 'M': size <<= 20; break;
+            case 'g': case 'G': size <<= 30; break;
+            default: return false;
+        }
+    } else if (result != 1)
+        return false;
+    value = (size_t) size;
+    return true;
+}
+
 static bool parseAngle(double &value, const char *arg) {
     char c1, c2;
     int result = sscanf(arg, "%lf%c%c", &value, &c1, &c2);
@@ -211,26 +290,58 @@ struct Configuration {
     bool preprocessGeometry;
     bool kerning;
     int threadCount;
+    int packedChannelCount;
+    Ktx2Properties ktx2Properties;
     const char *arteryFontFilename;
     const char *imageFilename;
     const char *jsonFilename;
     const char *csvFilename;
+    /// Significant digits of floating-point values in the JSON and CSV files, 0 = shortest round-trip representation
+    int floatPrecision;
+    const char *binaryLayoutFilename;
+    bool binaryLayoutQuads;
+    const char *bundleFilename;
+    bool verifyBundle;
     const char *shadronPreviewFilename;
     const char *shadronPreviewText;
+    /// If set, the atlas is generated in shards according to this plan
+    const ShardPlan *shardPlan;
+    const char *shardPlanFilename;
+    /// Shard to be generated, or -1 to compose the atlas from all shards
+    int shardIndex;
+    /// If not zero, the atlas image is generated in bands and streamed into the image file using approximately this many bytes
+    size_t memoryLimit;
+    /// Font of each glyph, from which its shape is loaded again during streamed generation
+    const std::vector<msdfgen::FontHandle *> *glyphFonts;
+    /// If set, the atlas is generated directly in the memory-mapped image file
+    bool mappedImage;
 };
 
-template <typename T, typename S, int N, GeneratorFunction<S, N> GEN_FN>
-static bool makeAtlas(const std::vector<GlyphGeometry> &glyphs, const std::vector<FontGeometry> &fonts, const Configuration &config) {
-    ImmediateAtlasGenerator<S, N, GEN_FN, BitmapAtlasStorage<T, N> > generator(config.width, config.height);
-    generator.setAttributes(config.generatorAttributes);
-    generator.setThreadCount(config.threadCount);
-    generator.generate(glyphs.data(), glyphs.size());
-    msdfgen::BitmapConstRef<T, N> bitmap = (msdfgen::BitmapConstRef<T, N>) generator.atlasStorage();
-
+template <typename T, int N>
+static bool saveAtlas(const msdfgen::BitmapConstRef<T, N> &bitmap, const std::vector<GlyphGeometry> &glyphs, const std::vector<FontGeometry> &fonts, const Configuration &config) {
     bool success = true;
 
     if (config.imageFilename) {
-        if (saveImage(bitmap, config.imageFormat, config.imageFilename, config.yDirection))
+        bool saved = false;
+        switch (config.imageFormat) {
+            case ImageFormat::KTX2: case ImageFormat::KTX2_HALF_FLOAT: case ImageFormat::KTX2_FLOAT:
+                if (config.ktx2Properties.blockCompression != BlockCompression::NONE) {
+                    std::vector<double> blockErrors, glyphErrors;
+                    if ((saved = saveKtx2(&bitmap, 1, config.imageFilename, config.yDirection, config.ktx2Properties, &blockErrors))) {
+                        getGlyphCompressionErrors(glyphErrors, glyphs.data(), glyphs.size(), blockErrors, config.width, config.height, config.yDirection);
+                        double totalError = 0, maxError = 0;
+                        for (double glyphError : glyphErrors)
+                            totalError += glyphError, maxError = std::max(maxError, glyphError);
+                        if (!glyphErrors.empty())
+                            printf("Block compression error per glyph: %.3g average, %.3g maximum (RMS, 8-bit units)\n", totalError/glyphErrors.size(), maxError);
+                    }
+                } else
+                    saved = saveKtx2(&bitmap, 1, config.imageFilename, config.yDirection, config.ktx2Properties);
+                break;
+            default:
+                saved = saveImage(bitmap, config.imageFormat, config.imageFilename, config.yDirection);
+        }
+        if (saved)
             puts("Atlas image file saved.");
         else {
             success = false;
@@ -238,6 +349,27 @@ static bool makeAtlas(const std::vector<GlyphGeometry> &glyphs, const std::vecto
         }
     }
 
+    if (config.bundleFilename) {
+        std::vector<byte> layoutData;
+        if (
+            encodeBinaryLayout(layoutData, fonts.data(), fonts.size(), config.emSize, config.pxRange, config.width, config.height, config.imageType, config.yDirection, config.kerning, config.packedChannelCount, config.binaryLayoutQuads) &&
+            saveAtlasBundle(&bitmap, 1, layoutData.data(), layoutData.size(), config.bundleFilename, config.yDirection, config.ktx2Properties.blockCompression, config.threadCount)
+        ) {
+            puts("Atlas bundle file saved.");
+            if (config.verifyBundle) {
+                if (verifyAtlasBundle(config.bundleFilename, &bitmap, 1, layoutData.data(), layoutData.size(), config.yDirection, config.ktx2Properties.blockCompression, config.threadCount))
+                    puts("Atlas bundle file verified.");
+                else {
+                    success = false;
+                    puts("Atlas bundle file does not match the generated atlas.");
+                }
+            }
+        } else {
+            success = false;
+            puts("Failed to save the atlas bundle file.");
+        }
+    }
+
     if (config.arteryFontFilename) {
         ArteryFontExportProperties arfontProps;
         arfontProps.fontSize = config.emSize;
@@ -256,7 +388,289 @@ static bool makeAtlas(const std::vector<GlyphGeometry> &glyphs, const std::vecto
     return success;
 }
 
-int main(int argc, const char * const *argv) {
+/// Generates the selected shard into its partial image, or composes the atlas from the partial images of all shards if shardIndex is negative
+template <typename T, typename S, int N, GeneratorFunction<S, N> GEN_FN>
+static bool makeAtlasShard(const std::vector<GlyphGeometry> &glyphs, const std::vector<FontGeometry> &fonts, const Configuration &config) {
+    const ShardPlan &plan = *config.shardPlan;
+    if (config.shardIndex >= 0) {
+        const ShardRegion &region = plan.shards[config.shardIndex];
+        std::vector<GlyphGeometry> shardGlyphs;
+        for (const ShardGlyph &glyph : plan.glyphs) {
+            if (glyph.shard == config.shardIndex)
+                shardGlyphs.push_back(glyphs[glyph.glyph]);
+        }
+        ImmediateAtlasGenerator<S, N, GEN_FN, BitmapAtlasStorage<T, N> > generator(region.w, region.h);
+        generator.setAttributes(config.generatorAttributes);
+        generator.setThreadCount(config.threadCount);
+        generator.generate(shardGlyphs.data(), shardGlyphs.size());
+        std::string filename = shardImageFilename(config.shardPlanFilename, config.shardIndex);
+        if (!saveShardImage((msdfgen::BitmapConstRef<T, N>) generator.atlasStorage(), filename.c_str())) {
+            printf("Failed to save the partial image of shard %d.\n", config.shardIndex);
+            return false;
+        }
+        printf("Partial image of shard %d (%d glyphs) saved into %s.\n", config.shardIndex, (int) shardGlyphs.size(), filename.c_str());
+        return true;
+    }
+    BitmapAtlasStorage<T, N> storage(config.width, config.height);
+    msdfgen::BitmapRef<T, N> atlas = storage;
+    for (int i = 0; i < (int) plan.shards.size(); ++i) {
+        std::string filename = shardImageFilename(config.shardPlanFilename, i);
+        if (!mergeShardImage(atlas, plan, i, filename.c_str())) {
+            printf("Failed to merge the partial image of shard %d from %s.\n", i, filename.c_str());
+            return false;
+        }
+    }
+    return saveAtlas(msdfgen::BitmapConstRef<T, N>(atlas), glyphs, fonts, config);
+}
+
+/// Generates the atlas in bands that fit within the memory limit and streams them into the image file, loading each glyph's shape only for its generation
+template <typename T, typename S, int N, GeneratorFunction<S, N> GEN_FN>
+static bool makeAtlasStreamed(const std::vector<GlyphGeometry> &glyphs, const Configuration &config) {
+    StreamingAtlasGenerator<S, N, GEN_FN, T> generator(config.width, config.height);
+    generator.setAttributes(config.generatorAttributes);
+    generator.setThreadCount(config.threadCount);
+    if (!generator.setMemoryLimit(config.memoryLimit, glyphs.data(), glyphs.size()))
+        puts("Warning: Memory limit is too low, the atlas will be generated one row at a time.");
+    // Same seeds as in colorGlyphEdges, so that the result does not differ from regular generation
+    bool coloring = config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF;
+    std::vector<unsigned long long> glyphSeeds;
+    if (coloring) {
+        glyphSeeds.reserve(glyphs.size());
+        for (int i = 0; i < (int) glyphs.size(); ++i)
+            glyphSeeds.push_back(glyphColoringSeed(config.coloringSeed, i, config.expensiveColoring));
+    }
+    ImageStreamWriter writer;
+    if (!writer.open(config.imageFilename, config.imageFormat, config.width, config.height, N, config.yDirection)) {
+        puts("Failed to save the atlas as an image file.");
+        return false;
+    }
+    bool success = generator.generate(glyphs.data(), glyphs.size(), [&config, &glyphSeeds, coloring](GlyphGeometry &glyph, int index) -> bool {
+        if (!glyph.reloadShape((*config.glyphFonts)[index], config.preprocessGeometry))
+            return false;
+        if (coloring)
+            glyph.edgeColoring(config.edgeColoring, config.angleThreshold, glyphSeeds[index]);
+        return true;
+    }, writer);
+    success = writer.close() && success;
+    if (success)
+        printf("Atlas image file saved (generated in bands of %d rows).\n", generator.getBandHeight());
+    else
+        puts("Failed to save the atlas as an image file.");
+    return success;
+}
+
+/// Generates the atlas directly in the memory-mapped image file, whose raw pixels are the binary image output
+template <typename T, typename S, int N, GeneratorFunction<S, N> GEN_FN>
+static bool makeAtlasMapped(const std::vector<GlyphGeometry> &glyphs, const std::vector<FontGeometry> &fonts, const Configuration &config) {
+    MmapAtlasStorage<T, N> storage(config.imageFilename, config.width, config.height);
+    if (!storage.isValid()) {
+        puts("Failed to create the memory-mapped atlas image file.");
+        return false;
+    }
+    ImmediateAtlasGenerator<S, N, GEN_FN, MmapAtlasStorage<T, N> > generator((MmapAtlasStorage<T, N> &&) storage);
+    generator.setAttributes(config.generatorAttributes);
+    generator.setThreadCount(config.threadCount);
+    generator.generate(glyphs.data(), glyphs.size());
+    bool success = generator.atlasStorage().flush();
+    if (success)
+        puts("Atlas image file saved.");
+    else
+        puts("Failed to save the atlas as an image file.");
+    // Any other outputs that need the pixels read them from the mapped file
+    Configuration otherOutputs = config;
+    otherOutputs.imageFilename = nullptr;
+    return saveAtlas((msdfgen::BitmapConstRef<T, N>) generator.atlasStorage(), glyphs, fonts, otherOutputs) && success;
+}
+
+template <typename T, typename S, int N, GeneratorFunction<S, N> GEN_FN>
+static bool makeAtlas(const std::vector<GlyphGeometry> &glyphs, const std::vector<FontGeometry> &fonts, const Configuration &config) {
+    if (config.shardPlan)
+        return makeAtlasShard<T, S, N, GEN_FN>(glyphs, fonts, config);
+    if (config.memoryLimit)
+        return makeAtlasStreamed<T, S, N, GEN_FN>(glyphs, config);
+    if (config.mappedImage)
+        return makeAtlasMapped<T, S, N, GEN_FN>(glyphs, fonts, config);
+    ImmediateAtlasGenerator<S, N, GEN_FN, BitmapAtlasStorage<T, N> > generator(config.width, config.height);
+    generator.setAttributes(config.generatorAttributes);
+    generator.setThreadCount(config.threadCount);
+    generator.generate(glyphs.data(), glyphs.size());
+    return saveAtlas((msdfgen::BitmapConstRef<T, N>) generator.atlasStorage(), glyphs, fonts, config);
+}
+
+template <typename T, typename S, int N, GeneratorFunction<S, 1> GEN_FN>
+static bool makeChannelPackedAtlas(const std::vector<GlyphGeometry> &glyphs, const std::vector<FontGeometry> &fonts, const Configuration &config) {
+    ChannelPackedAtlasGenerator<S, GEN_FN, BitmapAtlasStorage<T, N> > generator(config.width, config.height);
+    generator.setAttributes(config.generatorAttributes);
+    generator.setThreadCount(config.threadCount);
+    generator.generate(glyphs.data(), glyphs.size());
+    return saveAtlas((msdfgen::BitmapConstRef<T, N>) generator.atlasStorage(), glyphs, fonts, config);
+}
+
+/// Selects the pixel type and the number of texture channels (3 or 4) for a channel-packed atlas
+template <typename S, GeneratorFunction<S, 1> GEN_FN>
+static bool makeChannelPackedAtlas(const std::vector<GlyphGeometry> &glyphs, const std::vector<FontGeometry> &fonts, const Configuration &config, bool floatingPointFormat) {
+    if (config.packedChannelCount > 3) {
+        if (floatingPointFormat)
+            return makeChannelPackedAtlas<float, S, 4, GEN_FN>(glyphs, fonts, config);
+        return makeChannelPackedAtlas<byte, S, 4, GEN_FN>(glyphs, fonts, config);
+    }
+    if (floatingPointFormat)
+        return makeChannelPackedAtlas<float, S, 3, GEN_FN>(glyphs, fonts, config);
+    return makeChannelPackedAtlas<byte, S, 3, GEN_FN>(glyphs, fonts, config);
+}
+
+/// Modification time and size of a file, which change when the file is edited
+struct FileVersion {
+    long long modificationTime;
+    long long size;
+
+    explicit FileVersion(const char *filename = nullptr) : modificationTime(-1), size(-1) {
+        struct stat fileStatus;
+        if (filename && !stat(filename, &fileStatus)) {
+            modificationTime = (long long) fileStatus.st_mtime;
+            size = (long long) fileStatus.st_size;
+        }
+    }
+    bool operator==(const FileVersion &other) const {
+        return modificationTime == other.modificationTime && size == other.size;
+    }
+};
+
+/// Font files opened by a single thread, which remain open for subsequent jobs until they are modified
+class FontLoader {
+
+public:
+    FontLoader() : ft(msdfgen::initializeFreetype()) { }
+    ~FontLoader() {
+        if (ft) {
+            for (const std::pair<const std::string, std::pair<FileVersion, msdfgen::FontHandle *> > &font : fonts)
+                msdfgen::destroyFont(font.second.second);
+            msdfgen::deinitializeFreetype(ft);
+        }
+    }
+    msdfgen::FontHandle * load(const char *fontFilename) {
+        if (!(ft && fontFilename))
+            return nullptr;
+        FileVersion version(fontFilename);
+        std::map<std::string, std::pair<FileVersion, msdfgen::FontHandle *> >::iterator it = fonts.find(fontFilename);
+        if (it != fonts.end()) {
+            if (it->second.first == version)
+                return it->second.second;
+            msdfgen::destroyFont(it->second.second);
+            fonts.erase(it);
+        }
+        msdfgen::FontHandle *font = msdfgen::loadFont(ft, fontFilename);
+        if (font)
+            fonts.insert(std::make_pair(std::string(fontFilename), std::make_pair(version, font)));
+        return font;
+    }
+
+private:
+    msdfgen::FreetypeHandle *ft;
+    std::map<std::string, std::pair<FileVersion, msdfgen::FontHandle *> > fonts;
+
+    FontLoader(const FontLoader &);
+    FontLoader & operator=(const FontLoader &);
+
+};
+
+/**
+ * Unprocessed glyph geometry of font inputs, shared by jobs that load the same font with the same settings.
+ * Entries of modified font or character set files are replaced, and the least recently used entry is evicted above MAX_CACHED_FONT_INPUTS entries.
+ */
+class FontGeometryCache {
+
+public:
+    struct Entry {
+        std::mutex mutex;
+        bool loaded;
+        const char *error;
+        FileVersion fontVersion, charsetVersion;
+        Charset charset;
+        int glyphsLoaded;
+        std::vector<GlyphGeometry> glyphs;
+        FontGeometry fontGeometry;
+        Entry(const FileVersion &fontVersion, const FileVersion &charsetVersion) : loaded(false), error(nullptr), fontVersion(fontVersion), charsetVersion(charsetVersion), glyphsLoaded(0), fontGeometry(&glyphs) { }
+    };
+
+    FontGeometryCache() : useCounter(0) { }
+
+    /// Returns the entry of the given font input settings, which must be locked while in use. If colored, the entry's glyphs are to be edge-colored by the configuration's settings
+    std::shared_ptr<Entry> getEntry(const FontInput &fontInput, const Configuration &config, bool colored) {
+        char settings[128];
+        snprintf(settings, sizeof(settings), "|%d|%.17g|%d|%d|", (int) fontInput.glyphIdentifierType, fontInput.fontScale, (int) config.preprocessGeometry, (int) config.kerning);
+        if (colored)
+            snprintf(settings+strlen(settings), sizeof(settings)-strlen(settings), "%p|%.17g|", (void *) config.edgeColoring, config.angleThreshold);
+        std::string key = std::string(fontInput.fontFilename)+settings+(fontInput.charsetFilename ? fontInput.charsetFilename : "");
+        FileVersion fontVersion(fontInput.fontFilename), charsetVersion(fontInput.charsetFilename);
+        std::lock_guard<std::mutex> lock(mutex);
+        CachedEntry &cached = entries[key];
+        if (!(cached.entry && cached.entry->fontVersion == fontVersion && cached.entry->charsetVersion == charsetVersion))
+            cached.entry = std::make_shared<Entry>(fontVersion, charsetVersion);
+        cached.lastUse = ++useCounter;
+        std::shared_ptr<Entry> entry = cached.entry;
+        if (entries.size() > MAX_CACHED_FONT_INPUTS) {
+            // Jobs that still use the evicted entry keep it alive
+            std::map<std::string, CachedEntry>::iterator leastRecent = entries.begin();
+            for (std::map<std::string, CachedEntry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+                if (it->second.lastUse < leastRecent->second.lastUse)
+                    leastRecent = it;
+            }
+            entries.erase(leastRecent);
+        }
+        return entry;
+    }
+
+private:
+    struct CachedEntry {
+        std::shared_ptr<Entry> entry;
+        unsigned long long lastUse;
+    };
+
+    std::mutex mutex;
+    std::map<std::string, CachedEntry> entries;
+    unsigned long long useCounter;
+
+};
+
+/// Resources used by an atlas job, which may be shared with other jobs
+struct JobResources {
+    /// Font loader of the current thread
+    FontLoader *fontLoader;
+    /// Cache of glyph geometry shared by all jobs, may be null
+    FontGeometryCache *geometryCache;
+    /// Number of threads used by the job unless -threads is specified
+    int defaultThreadCount;
+    /// If not null, receives the filenames of the job's outputs
+    std::vector<std::string> *outputFiles;
+};
+
+/// Loads the character set and glyph geometry of a font input, returns an error message on failure
+static const char * loadFontInput(FontGeometry &fontGeometry, Charset &charset, int &glyphsLoaded, const FontInput &fontInput, const Configuration &config, FontLoader &fontLoader) {
+    msdfgen::FontHandle *font = fontLoader.load(fontInput.fontFilename);
+    if (!font)
+        return "Failed to load specified font file.";
+    if (fontInput.charsetFilename) {
+        if (!charset.load(fontInput.charsetFilename, fontInput.glyphIdentifierType != GlyphIdentifierType::UNICODE_CODEPOINT))
+            return fontInput.glyphIdentifierType == GlyphIdentifierType::GLYPH_INDEX ? "Failed to load glyph set specification." : "Failed to load character set specification.";
+    } else
+        charset = Charset::ASCII;
+    glyphsLoaded = -1;
+    switch (fontInput.glyphIdentifierType) {
+        case GlyphIdentifierType::GLYPH_INDEX:
+            glyphsLoaded = fontGeometry.loadGlyphset(font, fontInput.fontScale, charset, config.preprocessGeometry, config.kerning);
+            break;
+        case GlyphIdentifierType::UNICODE_CODEPOINT:
+            glyphsLoaded = fontGeometry.loadCharset(font, fontInput.fontScale, charset, config.preprocessGeometry, config.kerning);
+            break;
+    }
+    if (glyphsLoaded < 0)
+        return "Failed to load glyphs from font.";
+    return nullptr;
+}
+
+/// Runs a single atlas generator job with the specified command line arguments, returns the exit status
+static int runAtlasJob(int argc, const char * const *argv, JobResources &resources) {
     #define ABORT(msg) { puts(msg); return 1; }
 
     int result = 0;
@@ -272,6 +686,7 @@ int main(int argc, const char * const *argv) {
     config.kerning = true;
     const char *imageFormatName = nullptr;
     int fixedWidth = -1, fixedHeight = -1;
+    bool autoBlockCompression = false;
     config.preprocessGeometry = (
         #ifdef MSDFGEN_USE_SKIA
             true
@@ -289,10 +704,23 @@ int main(int argc, const char * const *argv) {
         RANGE_PIXEL,
     } rangeMode = RANGE_PIXEL;
     double rangeValue = 0;
+    enum {
+        /// Regular generation in a single process
+        SHARD_NONE,
+        /// Pack the atlas and write the shard plan
+        SHARD_PLAN,
+        /// Generate a single shard according to the plan
+        SHARD_GENERATE,
+        /// Compose the atlas from the partial images of all shards
+        SHARD_MERGE
+    } shardMode = SHARD_NONE;
+    int shardCount = 0;
+    ShardPlan shardPlan;
     TightAtlasPacker::DimensionsConstraint atlasSizeConstraint = TightAtlasPacker::DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE;
     config.angleThreshold = DEFAULT_ANGLE_THRESHOLD;
     config.miterLimit = DEFAULT_MITER_LIMIT;
     config.threadCount = 0;
+    config.shardIndex = -1;
 
     // Parse command line
     int argPos = 1;
@@ -321,10 +749,20 @@ int main(int argc, const char * const *argv) {
             ++argPos;
             continue;
         }
+        ARG_CASE("-channelpack", 1) {
+            unsigned channels;
+            if (!(parseUnsigned(channels, argv[++argPos]) && channels >= 1 && channels <= 4))
+                ABORT("Invalid channel count. Use -channelpack <N> with N being between 1 and 4.");
+            config.packedChannelCount = channels > 1 ? (int) channels : 0;
+            ++argPos;
+            continue;
+        }
         ARG_CASE("-format", 1) {
             arg = argv[++argPos];
             if (!strcmp(arg, "png"))
                 config.imageFormat = ImageFormat::PNG;
+            else if (!strcmp(arg, "qoi"))
+                config.imageFormat = ImageFormat::QOI;
             else if (!strcmp(arg, "bmp"))
                 config.imageFormat = ImageFormat::BMP;
             else if (!strcmp(arg, "tiff"))
@@ -339,12 +777,49 @@ int main(int argc, const char * const *argv) {
                 config.imageFormat = ImageFormat::BINARY_FLOAT;
             else if (!strcmp(arg, "binfloatbe"))
                 config.imageFormat = ImageFormat::BINARY_FLOAT_BE;
+            else if (!strcmp(arg, "ktx2"))
+                config.imageFormat = ImageFormat::KTX2;
+            else if (!strcmp(arg, "ktx2half"))
+                config.imageFormat = ImageFormat::KTX2_HALF_FLOAT;
+            else if (!strcmp(arg, "ktx2float"))
+                config.imageFormat = ImageFormat::KTX2_FLOAT;
             else
-                ABORT("Invalid image format. Valid formats are: png, bmp, tiff, text, textfloat, bin, binfloat");
+                ABORT("Invalid image format. Valid formats are: png, qoi, bmp, tiff, text, textfloat, bin, binfloat, ktx2, ktx2half, ktx2float");
             imageFormatName = arg;
             ++argPos;
             continue;
         }
+        ARG_CASE("-mipmaps", 1) {
+            unsigned levels;
+            if (!parseUnsigned(levels, argv[++argPos]))
+                ABORT("Invalid mipmap level count. Use -mipmaps <N> with N being a non-negative integer.");
+            config.ktx2Properties.mipLevels = (int) levels;
+            ++argPos;
+            continue;
+        }
+        ARG_CASE("-supercompress", 0) {
+            config.ktx2Properties.supercompression = true;
+            ++argPos;
+            continue;
+        }
+        ARG_CASE("-blockcompression", 1) {
+            arg = argv[++argPos];
+            autoBlockCompression = false;
+            if (!strcmp(arg, "auto"))
+                autoBlockCompression = true;
+            else if (!strcmp(arg, "bc4"))
+                config.ktx2Properties.blockCompression = BlockCompression::BC4;
+            else if (!strcmp(arg, "bc5"))
+                config.ktx2Properties.blockCompression = BlockCompression::BC5;
+            else if (!strcmp(arg, "bc7"))
+                config.ktx2Properties.blockCompression = BlockCompression::BC7;
+            else if (!strcmp(arg, "none"))
+                config.ktx2Properties.blockCompression = BlockCompression::NONE;
+            else
+                ABORT("Invalid block compression format. Valid formats are: auto, bc4, bc5, bc7, none");
+            ++argPos;
+            continue;
+        }
         ARG_CASE("-font", 1) {
             fontInput.fontFilename = argv[++argPos];
             ++argPos;
@@ -405,6 +880,71 @@ int main(int argc, const char * const *argv) {
             ++argPos;
             continue;
         }
+        ARG_CASE("-floatprecision", 1) {
+            unsigned precision;
+            if (!(parseUnsigned(precision, argv[argPos+1]) && precision <= 17))
+                ABORT("Invalid floating-point precision. Use -floatprecision <N> with N being 0 (shortest exact representation) to 17.");
+            config.floatPrecision = (int) precision;
+            argPos += 2;
+            continue;
+        }
+        ARG_CASE("-binlayout", 1) {
+            config.binaryLayoutFilename = argv[++argPos];
+            ++argPos;
+            continue;
+        }
+        ARG_CASE("-bundle", 1) {
+            config.bundleFilename = argv[++argPos];
+            ++argPos;
+            continue;
+        }
+        ARG_CASE("-shardplan", 2) {
+            unsigned n;
+            if (!parseUnsigned(n, argv[argPos+2]) || !(n > 0 && (int) n > 0))
+                ABORT("Invalid shard count. Use -shardplan <filename> <N> with N being a positive integer.");
+            shardMode = SHARD_PLAN;
+            config.shardPlanFilename = argv[argPos+1];
+            shardCount = (int) n;
+            argPos += 3;
+            continue;
+        }
+        ARG_CASE("-shard", 2) {
+            unsigned index;
+            if (!parseUnsigned(index, argv[argPos+2]) || (int) index < 0)
+                ABORT("Invalid shard index. Use -shard <plan filename> <index> with a non-negative integer index.");
+            shardMode = SHARD_GENERATE;
+            config.shardPlanFilename = argv[argPos+1];
+            config.shardIndex = (int) index;
+            argPos += 3;
+            continue;
+        }
+        ARG_CASE("-shardmerge", 1) {
+            shardMode = SHARD_MERGE;
+            config.shardPlanFilename = argv[++argPos];
+            ++argPos;
+            continue;
+        }
+        ARG_CASE("-mmap", 0) {
+            config.mappedImage = true;
+            ++argPos;
+            continue;
+        }
+        ARG_CASE("-memlimit", 1) {
+            if (!parseByteSize(config.memoryLimit, argv[argPos+1]) || !config.memoryLimit)
+                ABORT("Invalid memory limit. Use -memlimit <bytes> with a positive integer, optionally followed by K, M, or G.");
+            argPos += 2;
+            continue;
+        }
+        ARG_CASE("-verify", 0) {
+            config.verifyBundle = true;
+            ++argPos;
+            continue;
+        }
+        ARG_CASE("-layoutquads", 0) {
+            config.binaryLayoutQuads = true;
+            ++argPos;
+            continue;
+        }
         ARG_CASE("-shadronpreview", 2) {
             config.shadronPreviewFilename = argv[++argPos];
             config.shadronPreviewText = argv[++argPos];
@@ -649,11 +1189,11 @@ int main(int argc, const char * const *argv) {
     }
     if (!fontInput.fontFilename)
         ABORT("No font specified.");
-    if (!(config.arteryFontFilename || config.imageFilename || config.jsonFilename || config.csvFilename || config.shadronPreviewFilename)) {
+    if (!(config.arteryFontFilename || config.imageFilename || config.jsonFilename || config.csvFilename || config.binaryLayoutFilename || config.bundleFilename || config.shadronPreviewFilename)) {
         puts("No output specified.");
         return 0;
     }
-    bool layoutOnly = !(config.arteryFontFilename || config.imageFilename);
+    bool layoutOnly = !(config.arteryFontFilename || config.imageFilename || config.bundleFilename);
 
     // Finalize font inputs
     const FontInput *nextFontInput = &fontInput;
@@ -687,10 +1227,10 @@ int main(int argc, const char * const *argv) {
         rangeMode = RANGE_PIXEL;
         rangeValue = DEFAULT_PIXEL_RANGE;
     }
-    if (config.kerning && !(config.arteryFontFilename || config.jsonFilename || config.shadronPreviewFilename))
+    if (config.kerning && !(config.arteryFontFilename || config.jsonFilename || config.binaryLayoutFilename || config.bundleFilename || config.shadronPreviewFilename))
         config.kerning = false;
     if (config.threadCount <= 0)
-        config.threadCount = std::max((int) std::thread::hardware_concurrency(), 1);
+        config.threadCount = resources.defaultThreadCount;
     if (config.generatorAttributes.scanlinePass) {
         if (explicitErrorCorrectionMode && config.generatorAttributes.config.errorCorrection.distanceCheckMode != msdfgen::ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE) {
             const char *fallbackModeName = "unknown";
@@ -709,10 +1249,12 @@ int main(int argc, const char * const *argv) {
     ImageFormat imageExtension = ImageFormat::UNSPECIFIED;
     if (config.imageFilename) {
         if (cmpExtension(config.imageFilename, ".png")) imageExtension = ImageFormat::PNG;
+        else if (cmpExtension(config.imageFilename, ".qoi")) imageExtension = ImageFormat::QOI;
         else if (cmpExtension(config.imageFilename, ".bmp")) imageExtension = ImageFormat::BMP;
         else if (cmpExtension(config.imageFilename, ".tif") || cmpExtension(config.imageFilename, ".tiff")) imageExtension = ImageFormat::TIFF;
         else if (cmpExtension(config.imageFilename, ".txt")) imageExtension = ImageFormat::TEXT;
         else if (cmpExtension(config.imageFilename, ".bin")) imageExtension = ImageFormat::BINARY;
+        else if (cmpExtension(config.imageFilename, ".ktx2")) imageExtension = ImageFormat::KTX2;
     }
     if (config.imageFormat == ImageFormat::UNSPECIFIED) {
         config.imageFormat = ImageFormat::PNG;
@@ -723,14 +1265,47 @@ int main(int argc, const char * const *argv) {
     }
     if (config.imageType == ImageType::MTSDF && config.imageFormat == ImageFormat::BMP)
         ABORT("Atlas type not compatible with image format. MTSDF requires a format with alpha channel.");
+    if (config.packedChannelCount) {
+        if (config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF)
+            ABORT("Channel packing is only available for single-channel atlas types (hardmask, softmask, sdf, psdf).");
+        if (config.packedChannelCount > 3 && config.imageFormat == ImageFormat::BMP)
+            ABORT("Channel packing into 4 channels requires an image format with alpha channel.");
+        if (config.arteryFontFilename) {
+            config.arteryFontFilename = nullptr;
+            result = 1;
+            puts("Error: Artery Font output does not support channel-packed atlases!");
+        }
+        if (config.shadronPreviewFilename) {
+            config.shadronPreviewFilename = nullptr;
+            result = 1;
+            puts("Error: Shadron preview does not support channel-packed atlases!");
+        }
+        if (!(config.arteryFontFilename || config.imageFilename || config.jsonFilename || config.csvFilename || config.binaryLayoutFilename || config.bundleFilename || config.shadronPreviewFilename))
+            return result;
+        layoutOnly = !(config.arteryFontFilename || config.imageFilename || config.bundleFilename);
+    }
     if (config.arteryFontFilename && !(config.imageFormat == ImageFormat::PNG || config.imageFormat == ImageFormat::BINARY || config.imageFormat == ImageFormat::BINARY_FLOAT)) {
         config.arteryFontFilename = nullptr;
         result = 1;
         puts("Error: Unable to create an Artery Font file with the specified image format!");
         // Recheck whether there is anything else to do
-        if (!(config.arteryFontFilename || config.imageFilename || config.jsonFilename || config.csvFilename || config.shadronPreviewFilename))
+        if (!(config.arteryFontFilename || config.imageFilename || config.jsonFilename || config.csvFilename || config.binaryLayoutFilename || config.bundleFilename || config.shadronPreviewFilename))
             return result;
-        layoutOnly = !(config.arteryFontFilename || config.imageFilename);
+        layoutOnly = !(config.arteryFontFilename || config.imageFilename || config.bundleFilename);
+    }
+    if (shardMode != SHARD_NONE) {
+        if (config.packedChannelCount)
+            ABORT("Sharded generation does not support channel-packed atlases.");
+        if (shardMode != SHARD_PLAN && layoutOnly)
+            ABORT("Sharded generation requires an atlas image output.");
+    }
+    if (config.memoryLimit && !layoutOnly) {
+        if (shardMode != SHARD_NONE)
+            ABORT("Streamed generation (-memlimit) cannot be combined with sharded generation.");
+        if (config.packedChannelCount)
+            ABORT("Streamed generation (-memlimit) does not support channel-packed atlases.");
+        if (config.arteryFontFilename || config.bundleFilename || !config.imageFilename)
+            ABORT("Streamed generation (-memlimit) can only write the atlas into an image file (-imageout).");
     }
     if (imageExtension != ImageFormat::UNSPECIFIED) {
         // Warn if image format mismatches -imageout extension
@@ -742,6 +1317,9 @@ int main(int argc, const char * const *argv) {
             case ImageFormat::BINARY: case ImageFormat::BINARY_FLOAT: case ImageFormat::BINARY_FLOAT_BE:
                 mismatch = imageExtension != ImageFormat::BINARY;
                 break;
+            case ImageFormat::KTX2: case ImageFormat::KTX2_HALF_FLOAT: case ImageFormat::KTX2_FLOAT:
+                mismatch = imageExtension != ImageFormat::KTX2;
+                break;
             default:
                 mismatch = imageExtension != config.imageFormat;
         }
@@ -753,110 +1331,129 @@ int main(int argc, const char * const *argv) {
         config.imageFormat == ImageFormat::TIFF ||
         config.imageFormat == ImageFormat::TEXT_FLOAT ||
         config.imageFormat == ImageFormat::BINARY_FLOAT ||
-        config.imageFormat == ImageFormat::BINARY_FLOAT_BE
+        config.imageFormat == ImageFormat::BINARY_FLOAT_BE ||
+        config.imageFormat == ImageFormat::KTX2_HALF_FLOAT ||
+        config.imageFormat == ImageFormat::KTX2_FLOAT
     );
+    config.ktx2Properties.halfFloat = config.imageFormat == ImageFormat::KTX2_HALF_FLOAT;
+    bool multiChannelImage = config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF || config.packedChannelCount;
+    if (autoBlockCompression) {
+        if (config.packedChannelCount == 2)
+            config.ktx2Properties.blockCompression = BlockCompression::BC5;
+        else
+            config.ktx2Properties.blockCompression = multiChannelImage ? BlockCompression::BC7 : BlockCompression::BC4;
+    }
+    if (config.ktx2Properties.blockCompression != BlockCompression::NONE) {
+        if (!(config.imageFormat == ImageFormat::KTX2 || config.imageFormat == ImageFormat::KTX2_HALF_FLOAT || config.imageFormat == ImageFormat::KTX2_FLOAT || config.bundleFilename))
+            ABORT("Block compression is only supported with the KTX2 image format and atlas bundles.");
+        if (config.ktx2Properties.blockCompression != BlockCompression::BC4 && !multiChannelImage)
+            ABORT("Atlas type not compatible with block compression format. BC5 and BC7 require a multi-channel atlas type.");
+        if (config.ktx2Properties.blockCompression == BlockCompression::BC4 && config.packedChannelCount)
+            ABORT("BC4 block compression cannot hold a channel-packed atlas.");
+        if (config.ktx2Properties.blockCompression == BlockCompression::BC5 && config.packedChannelCount != 2)
+            ABORT("BC5 block compression can only hold a channel-packed atlas with 2 channels.");
+    }
+    config.ktx2Properties.threadCount = config.threadCount;
+    if (config.memoryLimit && !layoutOnly && !ImageStreamWriter::supportsFormat(config.imageFormat))
+        ABORT("Streamed generation (-memlimit) requires the png, bin, binfloat, or binfloatbe image format.");
+    if (config.mappedImage && !layoutOnly) {
+        // The mapped file holds the pixels bottom row first in native byte order
+        if (!(config.imageFilename && (
+            config.imageFormat == ImageFormat::BINARY ||
+            #ifdef __BIG_ENDIAN__
+                config.imageFormat == ImageFormat::BINARY_FLOAT_BE
+            #else
+                config.imageFormat == ImageFormat::BINARY_FLOAT
+            #endif
+        )))
+            ABORT("Memory-mapped generation (-mmap) requires -imageout in the bin format or the native byte order binary float format.");
+        if (config.yDirection != YDirection::BOTTOM_UP)
+            ABORT("Memory-mapped generation (-mmap) requires -yorigin bottom.");
+        if (config.packedChannelCount || config.memoryLimit || shardMode != SHARD_NONE)
+            ABORT("Memory-mapped generation (-mmap) cannot be combined with channel packing, -memlimit, or sharded generation.");
+    }
 
     // Load fonts
     std::vector<GlyphGeometry> glyphs;
     std::vector<FontGeometry> fonts;
+    std::vector<msdfgen::FontHandle *> glyphFonts;
     bool anyCodepointsAvailable = false;
-    {
-        class FontHolder {
-            msdfgen::FreetypeHandle *ft;
-            msdfgen::FontHandle *font;
-            const char *fontFilename;
-        public:
-            FontHolder() : ft(msdfgen::initializeFreetype()), font(nullptr), fontFilename(nullptr) { }
-            ~FontHolder() {
-                if (ft) {
-                    if (font)
-                        msdfgen::destroyFont(font);
-                    msdfgen::deinitializeFreetype(ft);
-                }
-            }
-            bool load(const char *fontFilename) {
-                if (ft && fontFilename) {
-                    if (this->fontFilename && !strcmp(this->fontFilename, fontFilename))
-                        return true;
-                    if (font)
-                        msdfgen::destroyFont(font);
-                    if ((font = msdfgen::loadFont(ft, fontFilename))) {
-                        this->fontFilename = fontFilename;
-                        return true;
-                    }
-                    this->fontFilename = nullptr;
-                }
-                return false;
-            }
-            operator msdfgen::FontHandle *() const {
-                return font;
-            }
-        } font;
-
-        for (FontInput &fontInput : fontInputs) {
-            if (!font.load(fontInput.fontFilename))
-                ABORT("Failed to load specified font file.");
-            if (fontInput.fontScale <= 0)
-                fontInput.fontScale = 1;
-
-            // Load character set
-            Charset charset;
-            if (fontInput.charsetFilename) {
-                if (!charset.load(fontInput.charsetFilename, fontInput.glyphIdentifierType != GlyphIdentifierType::UNICODE_CODEPOINT))
-                    ABORT(fontInput.glyphIdentifierType == GlyphIdentifierType::GLYPH_INDEX ? "Failed to load glyph set specification." : "Failed to load character set specification.");
-            } else {
-                charset = Charset::ASCII;
-                fontInput.glyphIdentifierType = GlyphIdentifierType::UNICODE_CODEPOINT;
-            }
+    // Edge coloring with a zero seed does not depend on the glyphs' order, so colored glyphs can be shared between jobs
+    bool cachedColoring = resources.geometryCache && !layoutOnly && (config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF) && !config.coloringSeed;
+    for (FontInput &fontInput : fontInputs) {
+        if (fontInput.fontScale <= 0)
+            fontInput.fontScale = 1;
+        if (!fontInput.charsetFilename)
+            fontInput.glyphIdentifierType = GlyphIdentifierType::UNICODE_CODEPOINT;
 
-            // Load glyphs
-            FontGeometry fontGeometry(&glyphs);
-            int glyphsLoaded = -1;
+        // Load character set and glyphs, or copy them from another job
+        Charset charset;
+        FontGeometry fontGeometry(&glyphs);
+        int glyphsLoaded = -1;
+        if (resources.geometryCache) {
+            std::shared_ptr<FontGeometryCache::Entry> entry = resources.geometryCache->getEntry(fontInput, config, cachedColoring);
+            std::lock_guard<std::mutex> lock(entry->mutex);
+            if (!entry->loaded) {
+                entry->error = loadFontInput(entry->fontGeometry, entry->charset, entry->glyphsLoaded, fontInput, config, *resources.fontLoader);
+                if (!entry->error && cachedColoring)
+                    colorGlyphEdges(entry->glyphs.data(), entry->glyphs.size(), config.edgeColoring, config.angleThreshold, config.coloringSeed, config.expensiveColoring, config.threadCount);
+                entry->loaded = true;
+            }
+            if (entry->error)
+                ABORT(entry->error);
+            charset = entry->charset;
+            glyphsLoaded = entry->glyphsLoaded;
+            fontGeometry.loadCopy(entry->fontGeometry);
+        } else if (const char *error = loadFontInput(fontGeometry, charset, glyphsLoaded, fontInput, config, *resources.fontLoader))
+            ABORT(error);
+        if (fontInput.glyphIdentifierType == GlyphIdentifierType::UNICODE_CODEPOINT)
+            anyCodepointsAvailable |= glyphsLoaded > 0;
+        printf("Loaded geometry of %d out of %d glyphs", glyphsLoaded, (int) charset.size());
+        if (fontInputs.size() > 1)
+            printf(" from font \"%s\"", fontInput.fontFilename);
+        printf(".\n");
+        // List missing glyphs
+        if (glyphsLoaded < (int) charset.size()) {
+            printf("Missing %d %s", (int) charset.size()-glyphsLoaded, fontInput.glyphIdentifierType == GlyphIdentifierType::UNICODE_CODEPOINT ? "codepoints" : "glyphs");
+            bool first = true;
             switch (fontInput.glyphIdentifierType) {
                 case GlyphIdentifierType::GLYPH_INDEX:
-                    glyphsLoaded = fontGeometry.loadGlyphset(font, fontInput.fontScale, charset, config.preprocessGeometry, config.kerning);
+                    for (unicode_t cp : charset)
+                        if (!fontGeometry.getGlyph(msdfgen::GlyphIndex(cp)))
+                            printf("%c 0x%02X", first ? ((first = false), ':') : ',', cp);
                     break;
                 case GlyphIdentifierType::UNICODE_CODEPOINT:
-                    glyphsLoaded = fontGeometry.loadCharset(font, fontInput.fontScale, charset, config.preprocessGeometry, config.kerning);
-                    anyCodepointsAvailable |= glyphsLoaded > 0;
+                    for (unicode_t cp : charset)
+                        if (!fontGeometry.getGlyph(cp))
+                            printf("%c 0x%02X", first ? ((first = false), ':') : ',', cp);
                     break;
             }
-            if (glyphsLoaded < 0)
-                ABORT("Failed to load glyphs from font.");
-            printf("Loaded geometry of %d out of %d glyphs", glyphsLoaded, (int) charset.size());
-            if (fontInputs.size() > 1)
-                printf(" from font \"%s\"", fontInput.fontFilename);
-            printf(".\n");
-            // List missing glyphs
-            if (glyphsLoaded < (int) charset.size()) {
-                printf("Missing %d %s", (int) charset.size()-glyphsLoaded, fontInput.glyphIdentifierType == GlyphIdentifierType::UNICODE_CODEPOINT ? "codepoints" : "glyphs");
-                bool first = true;
-                switch (fontInput.glyphIdentifierType) {
-                    case GlyphIdentifierType::GLYPH_INDEX:
-                        for (unicode_t cp : charset)
-                            if (!fontGeometry.getGlyph(msdfgen::GlyphIndex(cp)))
-                                printf("%c 0x%02X", first ? ((first = false), ':') : ',', cp);
-                        break;
-                    case GlyphIdentifierType::UNICODE_CODEPOINT:
-                        for (unicode_t cp : charset)
-                            if (!fontGeometry.getGlyph(cp))
-                                printf("%c 0x%02X", first ? ((first = false), ':') : ',', cp);
-                        break;
-                }
-                printf("\n");
-            }
+            printf("\n");
+        }
 
-            if (fontInput.fontName)
-                fontGeometry.setName(fontInput.fontName);
+        if (fontInput.fontName)
+            fontGeometry.setName(fontInput.fontName);
 
-            fonts.push_back((FontGeometry &&) fontGeometry);
-        }
+        fonts.push_back((FontGeometry &&) fontGeometry);
+        if (config.memoryLimit)
+            glyphFonts.resize(glyphs.size(), resources.fontLoader->load(fontInput.fontFilename));
     }
     if (glyphs.empty())
         ABORT("No glyphs loaded.");
 
-    // Determine final atlas dimensions, scale and range, pack glyphs
-    {
+    // Determine final atlas dimensions, scale and range, pack glyphs (or apply the layout of a shard plan)
+    if (shardMode == SHARD_GENERATE || shardMode == SHARD_MERGE) {
+        if (!loadShardPlan(shardPlan, config.shardPlanFilename))
+            ABORT("Failed to load shard plan.");
+        if (config.shardIndex >= (int) shardPlan.shards.size())
+            ABORT("Shard index out of range of the shard plan.");
+        if (!applyShardPlan(glyphs.data(), glyphs.size(), shardPlan, config.miterLimit, config.shardIndex))
+            ABORT("Shard plan does not match the loaded glyphs. All shards must be generated with the same arguments.");
+        config.width = shardPlan.width, config.height = shardPlan.height;
+        config.emSize = shardPlan.scale;
+        config.pxRange = shardPlan.pxRange;
+        config.shardPlan = &shardPlan;
+    } else {
         double unitRange = 0, pxRange = 0;
         switch (rangeMode) {
             case RANGE_EM:
@@ -874,6 +1471,14 @@ int main(int argc, const char * const *argv) {
         else
             atlasPacker.setDimensionsConstraint(atlasSizeConstraint);
         atlasPacker.setPadding(config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF ? 0 : -1);
+        // Glyphs in separate 4x4 blocks do not bleed into each other when block-compressed
+        if (config.ktx2Properties.blockCompression != BlockCompression::NONE) {
+            atlasPacker.setBoxAlignment(4);
+            if (fixedDimensions && (fixedWidth%4 || fixedHeight%4))
+                puts("Warning: Atlas dimensions rounded up to multiples of 4 for block compression.");
+        }
+        if (config.packedChannelCount)
+            atlasPacker.setChannelCount(config.packedChannelCount);
         // TODO: In this case (if padding is -1), the border pixels of each glyph are black, but still computed. For floating-point output, this may play a role.
         if (fixedScale)
             atlasPacker.setScale(config.emSize);
@@ -899,45 +1504,54 @@ int main(int argc, const char * const *argv) {
             printf("Glyph size: %.9g pixels/EM\n", config.emSize);
         if (!fixedDimensions)
             printf("Atlas dimensions: %d x %d\n", config.width, config.height);
+        if (shardMode == SHARD_PLAN) {
+            createShardPlan(shardPlan, glyphs.data(), glyphs.size(), config.width, config.height, config.emSize, unitRange+pxRange/config.emSize, config.pxRange, shardCount);
+            if (!saveShardPlan(shardPlan, config.shardPlanFilename))
+                ABORT("Failed to write shard plan file.");
+            printf("Shard plan with %d shards written.\n", shardCount);
+            if (resources.outputFiles)
+                resources.outputFiles->push_back(config.shardPlanFilename);
+            return result;
+        }
     }
 
     // Generate atlas bitmap
     if (!layoutOnly) {
 
-        // Edge coloring
-        if (config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF) {
-            if (config.expensiveColoring) {
-                Workload([&glyphs, &config](int i, int threadNo) -> bool {
-                    unsigned long long glyphSeed = (LCG_MULTIPLIER*(config.coloringSeed^i)+LCG_INCREMENT)*!!config.coloringSeed;
-                    glyphs[i].edgeColoring(config.edgeColoring, config.angleThreshold, glyphSeed);
-                    return true;
-                }, glyphs.size()).finish(config.threadCount);
-            } else {
-                unsigned long long glyphSeed = config.coloringSeed;
-                for (GlyphGeometry &glyph : glyphs) {
-                    glyphSeed *= LCG_MULTIPLIER;
-                    glyph.edgeColoring(config.edgeColoring, config.angleThreshold, glyphSeed);
-                }
-            }
+        // Streamed generation frees the shapes once packed, and loads and colors each of them just before it is generated
+        if (config.memoryLimit) {
+            for (GlyphGeometry &glyph : glyphs)
+                glyph.unloadShape();
+            config.glyphFonts = &glyphFonts;
         }
 
+        // Edge coloring (unless the glyphs have been copied already colored, the atlas is only composed from shards, or colored during streamed generation)
+        if ((config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF) && !cachedColoring && shardMode != SHARD_MERGE && !config.memoryLimit)
+            colorGlyphEdges(glyphs.data(), glyphs.size(), config.edgeColoring, config.angleThreshold, config.coloringSeed, config.expensiveColoring, config.threadCount);
+
         bool success = false;
         switch (config.imageType) {
             case ImageType::HARD_MASK:
-                if (floatingPointFormat)
+                if (config.packedChannelCount)
+                    success = makeChannelPackedAtlas<float, scanlineGenerator>(glyphs, fonts, config, floatingPointFormat);
+                else if (floatingPointFormat)
                     success = makeAtlas<float, float, 1, scanlineGenerator>(glyphs, fonts, config);
                 else
                     success = makeAtlas<byte, float, 1, scanlineGenerator>(glyphs, fonts, config);
                 break;
             case ImageType::SOFT_MASK:
             case ImageType::SDF:
-                if (floatingPointFormat)
+                if (config.packedChannelCount)
+                    success = makeChannelPackedAtlas<float, sdfGenerator>(glyphs, fonts, config, floatingPointFormat);
+                else if (floatingPointFormat)
                     success = makeAtlas<float, float, 1, sdfGenerator>(glyphs, fonts, config);
                 else
                     success = makeAtlas<byte, float, 1, sdfGenerator>(glyphs, fonts, config);
                 break;
             case ImageType::PSDF:
-                if (floatingPointFormat)
+                if (config.packedChannelCount)
+                    success = makeChannelPackedAtlas<float, psdfGenerator>(glyphs, fonts, config, floatingPointFormat);
+                else if (floatingPointFormat)
                     success = makeAtlas<float, float, 1, psdfGenerator>(glyphs, fonts, config);
                 else
                     success = makeAtlas<byte, float, 1, psdfGenerator>(glyphs, fonts, config);
@@ -959,8 +1573,15 @@ int main(int argc, const char * const *argv) {
             result = 1;
     }
 
+    // A single shard only produces its partial image, the other outputs are written when the shards are merged
+    if (shardMode == SHARD_GENERATE) {
+        if (resources.outputFiles)
+            resources.outputFiles->push_back(shardImageFilename(config.shardPlanFilename, config.shardIndex));
+        return result;
+    }
+
     if (config.csvFilename) {
-        if (exportCSV(fonts.data(), fonts.size(), config.width, config.height, config.yDirection, config.csvFilename))
+        if (exportCSV(fonts.data(), fonts.size(), config.width, config.height, config.yDirection, config.csvFilename, config.packedChannelCount > 0, config.floatPrecision))
             puts("Glyph layout written into CSV file.");
         else {
             result = 1;
@@ -968,13 +1589,21 @@ int main(int argc, const char * const *argv) {
         }
     }
     if (config.jsonFilename) {
-        if (exportJSON(fonts.data(), fonts.size(), config.emSize, config.pxRange, config.width, config.height, config.imageType, config.yDirection, config.jsonFilename, config.kerning))
+        if (exportJSON(fonts.data(), fonts.size(), config.emSize, config.pxRange, config.width, config.height, config.imageType, config.yDirection, config.jsonFilename, config.kerning, config.packedChannelCount, config.threadCount, config.floatPrecision))
             puts("Glyph layout and metadata written into JSON file.");
         else {
             result = 1;
             puts("Failed to write JSON output file.");
         }
     }
+    if (config.binaryLayoutFilename) {
+        if (exportBinaryLayout(fonts.data(), fonts.size(), config.emSize, config.pxRange, config.width, config.height, config.imageType, config.yDirection, config.binaryLayoutFilename, config.kerning, config.packedChannelCount, config.binaryLayoutQuads))
+            puts("Glyph layout and metadata written into binary layout file.");
+        else {
+            result = 1;
+            puts("Failed to write binary layout output file.");
+        }
+    }
 
     if (config.shadronPreviewFilename && config.shadronPreviewText) {
         if (anyCodepointsAvailable) {
@@ -993,7 +1622,330 @@ int main(int argc, const char * const *argv) {
         }
     }
 
+    if (resources.outputFiles) {
+        const char *outputFilenames[] = { config.imageFilename, config.jsonFilename, config.csvFilename, config.binaryLayoutFilename, config.bundleFilename, config.arteryFontFilename, config.shadronPreviewFilename };
+        for (const char *filename : outputFilenames)
+            if (filename)
+                resources.outputFiles->push_back(filename);
+    }
+
     return result;
 }
 
+/// Atlas job of a batch manifest
+struct BatchJob {
+    int line;
+    std::vector<std::string> args;
+    int result;
+    double time;
+};
+
+/// Splits a manifest line into arguments separated by whitespace, quotation marks enclose arguments with spaces, # starts a comment
+static bool parseManifestLine(std::vector<std::string> &args, const std::string &line) {
+    const char *c = line.c_str();
+    while (*c) {
+        if (isspace((unsigned char) *c)) {
+            ++c;
+            continue;
+        }
+        if (*c == '#')
+            break;
+        std::string arg;
+        while (*c && !isspace((unsigned char) *c)) {
+            if (*c == '"') {
+                for (++c; *c != '"'; ++c) {
+                    if (!*c)
+                        return false;
+                    if (*c == '\\' && (c[1] == '"' || c[1] == '\\'))
+                        ++c;
+                    arg.push_back(*c);
+                }
+                ++c;
+            } else
+                arg.push_back(*c++);
+        }
+        args.push_back((std::string &&) arg);
+    }
+    return true;
+}
+
+/// Runs all jobs of a batch manifest on a shared thread pool, commonArgs precede each job's arguments
+static int runBatch(const char *manifestFilename, const std::vector<const char *> &commonArgs, int threadCount) {
+    std::vector<BatchJob> jobs;
+    {
+        FILE *f = fopen(manifestFilename, "r");
+        if (!f)
+            ABORT("Failed to open batch manifest file.");
+        std::string line;
+        int lineNo = 0;
+        for (int c = fgetc(f); c != EOF || !line.empty(); c = fgetc(f)) {
+            if (c != '\n' && c != EOF) {
+                line.push_back((char) c);
+                continue;
+            }
+            BatchJob job = { ++lineNo };
+            if (!parseManifestLine(job.args, line)) {
+                fclose(f);
+                printf("Error: Unterminated quotation marks on line %d of batch manifest.\n", lineNo);
+                return 1;
+            }
+            if (!job.args.empty())
+                jobs.push_back((BatchJob &&) job);
+            line.clear();
+            if (c == EOF)
+                break;
+        }
+        fclose(f);
+    }
+    if (jobs.empty()) {
+        puts("No jobs in batch manifest.");
+        return 0;
+    }
+
+    // Threads of the pool not busy with a job of their own help with the others.
+    // Each thread that runs jobs has its own font loader, glyph geometry is shared by all jobs
+    if (threadCount <= 0)
+        threadCount = std::max((int) std::thread::hardware_concurrency(), 1);
+    int poolSize = std::min(threadCount, (int) jobs.size());
+    std::vector<FontLoader> fontLoaders(poolSize);
+    FontGeometryCache geometryCache;
+    int jobThreadCount = threadCount;
+    std::chrono::steady_clock::time_point batchStart = std::chrono::steady_clock::now();
+    Workload([&jobs, &commonArgs, &fontLoaders, &geometryCache, jobThreadCount](int i, int threadNo) -> bool {
+        BatchJob &job = jobs[i];
+        std::vector<const char *> argv;
+        argv.reserve(1+commonArgs.size()+job.args.size());
+        argv.push_back("msdf-atlas-gen");
+        argv.insert(argv.end(), commonArgs.begin(), commonArgs.end());
+        for (const std::string &arg : job.args)
+            argv.push_back(arg.c_str());
+        JobResources resources = { &fontLoaders[threadNo], &geometryCache, jobThreadCount };
+        std::chrono::steady_clock::time_point jobStart = std::chrono::steady_clock::now();
+        job.result = runAtlasJob((int) argv.size(), argv.data(), resources);
+        job.time = std::chrono::duration<double>(std::chrono::steady_clock::now()-jobStart).count();
+        return true;
+    }, jobs.size()).finish(poolSize);
+    double batchTime = std::chrono::duration<double>(std::chrono::steady_clock::now()-batchStart).count();
+
+    // Report
+    int failed = 0;
+    double totalJobTime = 0;
+    puts("\nBatch summary:");
+    for (const BatchJob &job : jobs) {
+        printf("  line %d: %s in %.3f s\n", job.line, job.result ? "FAILED" : "OK", job.time);
+        failed += job.result != 0;
+        totalJobTime += job.time;
+    }
+    printf("%d of %d jobs succeeded in %.3f s (total job time %.3f s, %d threads).\n", (int) jobs.size()-failed, (int) jobs.size(), batchTime, totalJobTime, threadCount);
+    return failed ? 1 : 0;
+}
+
+/// Processes requests from input and writes the responses into output until the input ends, returns false if shutdown was requested
+static bool serveRequests(FILE *input, FILE *output, const std::vector<const char *> &commonArgs, int threadCount, FontGeometryCache &geometryCache) {
+    FontLoader fontLoader;
+    std::string line;
+    for (int c = fgetc(input); c != EOF; c = fgetc(input)) {
+        if (c != '\n') {
+            line.push_back((char) c);
+            continue;
+        }
+        std::vector<std::string> args;
+        bool valid = parseManifestLine(args, line);
+        line.clear();
+        if (valid && args.empty())
+            continue;
+        std::string id = args.empty() ? std::string("-") : args.front();
+        if (!args.empty())
+            args.erase(args.begin());
+        if (args.size() == 1 && args.front() == "-shutdown") {
+            fprintf(output, "%s OK 0 0\n", id.c_str());
+            fflush(output);
+            return false;
+        }
+
+        // Run job
+        bool inlineOutput = false;
+        std::vector<const char *> argv;
+        argv.push_back("msdf-atlas-gen");
+        argv.insert(argv.end(), commonArgs.begin(), commonArgs.end());
+        for (const std::string &arg : args) {
+            if (arg == "-inline")
+                inlineOutput = true;
+            else
+                argv.push_back(arg.c_str());
+        }
+        std::vector<std::string> outputFiles;
+        JobResources resources = { &fontLoader, &geometryCache, threadCount, &outputFiles };
+        std::chrono::steady_clock::time_point jobStart = std::chrono::steady_clock::now();
+        int result = valid ? runAtlasJob((int) argv.size(), argv.data(), resources) : 1;
+        double jobTime = std::chrono::duration<double>(std::chrono::steady_clock::now()-jobStart).count();
+        fflush(stdout);
+        if (result)
+            outputFiles.clear();
+
+        // Respond with the list of outputs, or their contents which are removed from disk
+        if (inlineOutput) {
+            std::vector<std::vector<byte> > outputData(outputFiles.size());
+            for (size_t i = 0; i < outputFiles.size(); ++i) {
+                if (FILE *f = fopen(outputFiles[i].c_str(), "rb")) {
+                    byte buffer[4096];
+                    for (size_t n; (n = fread(buffer, 1, sizeof(buffer), f)) > 0;)
+                        outputData[i].insert(outputData[i].end(), buffer, buffer+n);
+                    fclose(f);
+                    remove(outputFiles[i].c_str());
+                }
+            }
+            fprintf(output, "%s %s %.6f %d\n", id.c_str(), result ? "FAILED" : "OK", jobTime, (int) outputFiles.size());
+            for (size_t i = 0; i < outputFiles.size(); ++i) {
+                fprintf(output, "%d %s\n", (int) outputData[i].size(), outputFiles[i].c_str());
+                fwrite(outputData[i].data(), 1, outputData[i].size(), output);
+            }
+        } else {
+            fprintf(output, "%s %s %.6f %d\n", id.c_str(), result ? "FAILED" : "OK", jobTime, (int) outputFiles.size());
+            for (const std::string &filename : outputFiles)
+                fprintf(output, "%s\n", filename.c_str());
+        }
+        if (fflush(output))
+            break;
+    }
+    return true;
+}
+
+#ifndef _WIN32
+/// Connection of a client to the server socket
+struct ServerConnection {
+    std::thread thread;
+    std::atomic<bool> finished;
+    ServerConnection() : finished(false) { }
+};
+#endif
+
+/// Runs the server, which keeps the loaded fonts in memory between requests, on standard input and output or a Unix domain socket
+static int runServer(const char *address, const std::vector<const char *> &commonArgs, int threadCount) {
+    if (threadCount <= 0)
+        threadCount = std::max((int) std::thread::hardware_concurrency(), 1);
+    FontGeometryCache geometryCache;
+
+    if (!strcmp(address, "stdio")) {
+        // Responses are written into the original standard output, while the jobs' messages are redirected into standard error
+        fflush(stdout);
+        int outputFd = dup(fileno(stdout));
+        FILE *output = outputFd >= 0 ? fdopen(outputFd, "wb") : nullptr;
+        if (!output)
+            ABORT("Failed to open standard output.");
+        dup2(fileno(stderr), fileno(stdout));
+        serveRequests(stdin, output, commonArgs, threadCount, geometryCache);
+        fclose(output);
+        return 0;
+    }
+
+#ifdef _WIN32
+    ABORT("Only the standard input and output (-serve stdio) are supported on this platform.");
+#else
+    sockaddr_un socketAddress = { };
+    socketAddress.sun_family = AF_UNIX;
+    if (strlen(address) >= sizeof(socketAddress.sun_path))
+        ABORT("Server socket path is too long.");
+    strcpy(socketAddress.sun_path, address);
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        ABORT("Failed to create server socket.");
+    unlink(address);
+    if (bind(listener, (const sockaddr *) &socketAddress, sizeof(socketAddress)) || listen(listener, SOMAXCONN)) {
+        close(listener);
+        ABORT("Failed to bind server socket.");
+    }
+    signal(SIGPIPE, SIG_IGN);
+    printf("Listening on %s\n", address);
+    fflush(stdout);
+
+    // Each connection is served by its own thread, shutdown stops accepting new connections and waits for the open ones to close
+    std::atomic<bool> running(true);
+    std::vector<std::unique_ptr<ServerConnection> > connections;
+    while (running) {
+        int connectionFd = accept(listener, nullptr, nullptr);
+        if (connectionFd < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (!running) {
+            close(connectionFd);
+            break;
+        }
+        for (std::vector<std::unique_ptr<ServerConnection> >::iterator it = connections.begin(); it != connections.end();) {
+            if ((*it)->finished) {
+                (*it)->thread.join();
+                it = connections.erase(it);
+            } else
+                ++it;
+        }
+        ServerConnection *connection = new ServerConnection;
+        connections.push_back(std::unique_ptr<ServerConnection>(connection));
+        connection->thread = std::thread([connection, connectionFd, address, &running, &commonArgs, threadCount, &geometryCache]() {
+            int outputFd = dup(connectionFd);
+            FILE *input = fdopen(connectionFd, "rb");
+            FILE *output = outputFd >= 0 ? fdopen(outputFd, "wb") : nullptr;
+            if (input && output && !serveRequests(input, output, commonArgs, threadCount, geometryCache) && running.exchange(false)) {
+                // Wake up the listener blocked in accept
+                int wakeFd = socket(AF_UNIX, SOCK_STREAM, 0);
+                sockaddr_un wakeAddress = { };
+                wakeAddress.sun_family = AF_UNIX;
+                strcpy(wakeAddress.sun_path, address);
+                if (wakeFd >= 0) {
+                    connect(wakeFd, (const sockaddr *) &wakeAddress, sizeof(wakeAddress));
+                    close(wakeFd);
+                }
+            }
+            if (output)
+                fclose(output);
+            else if (outputFd >= 0)
+                close(outputFd);
+            if (input)
+                fclose(input);
+            else
+                close(connectionFd);
+            connection->finished = true;
+        });
+    }
+    for (std::unique_ptr<ServerConnection> &connection : connections)
+        connection->thread.join();
+    close(listener);
+    unlink(address);
+    return 0;
+#endif
+}
+
+int main(int argc, const char * const *argv) {
+    // Batch and server modes - other arguments apply to all jobs, except for -threads, which sets the number of threads
+    const char *manifestFilename = nullptr, *serverAddress = nullptr;
+    std::vector<const char *> commonArgs;
+    unsigned threadCount = 0;
+    for (int argPos = 1; argPos < argc; ++argPos) {
+        if (!strcmp(argv[argPos], "-batch") && argPos+1 < argc)
+            manifestFilename = argv[++argPos];
+        else if (!strcmp(argv[argPos], "-serve") && argPos+1 < argc)
+            serverAddress = argv[++argPos];
+        else if (!strcmp(argv[argPos], "-threads") && argPos+1 < argc) {
+            if (!parseUnsigned(threadCount, argv[++argPos]) || (int) threadCount < 0)
+                ABORT("Invalid thread count. Use -threads <N> with N being a non-negative integer.");
+        } else
+            commonArgs.push_back(argv[argPos]);
+    }
+    if (manifestFilename || serverAddress) {
+        // The parallel work of all jobs runs on one thread pool, together with the thread that runs the job
+        if (!threadCount)
+            threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+        WorkerPool workerPool(std::max((int) threadCount-1, 1));
+        Workload::setWorkerPool(&workerPool);
+        int result = manifestFilename ? runBatch(manifestFilename, commonArgs, (int) threadCount) : runServer(serverAddress, commonArgs, (int) threadCount);
+        Workload::setWorkerPool(nullptr);
+        return result;
+    }
+
+    FontLoader fontLoader;
+    JobResources resources = { &fontLoader, nullptr, std::max((int) std::thread::hardware_concurrency(), 1) };
+    return runAtlasJob(argc, argv, resources);
+}
+
 #endif
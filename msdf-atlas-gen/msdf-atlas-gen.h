@@ -19,23 +19,45 @@
 #include "Charset.h"
 #include "GlyphBox.h"
 #include "GlyphGeometry.h"
+#include "edge-coloring.h"
 #include "FontGeometry.h"
 #include "RectanglePacker.h"
+#include "DirtyRegions.h"
 #include "rectangle-packing.h"
 #include "Workload.h"
+#include "WorkerPool.h"
 #include "size-selectors.h"
+#include "BitmapSection.h"
 #include "bitmap-blit.h"
 #include "AtlasStorage.h"
 #include "BitmapAtlasStorage.h"
+#include "MappedFile.h"
+#include "MmapAtlasStorage.h"
+#include "TiledAtlasStorage.h"
 #include "TightAtlasPacker.h"
 #include "AtlasGenerator.h"
 #include "ImmediateAtlasGenerator.h"
+#include "AsyncAtlasGenerator.h"
+#include "StreamingAtlasGenerator.h"
+#include "ChannelPackedAtlasGenerator.h"
 #include "DynamicAtlas.h"
+#include "PagedDynamicAtlas.h"
+#include "ConcurrentDynamicAtlas.h"
 #include "glyph-generators.h"
+#include "BufferedWriter.h"
 #include "image-encode.h"
 #include "image-save.h"
+#include "ImageStreamWriter.h"
+#include "block-compression.h"
+#include "ktx2-export.h"
 #include "csv-export.h"
 #include "json-export.h"
+#include "BinaryLayout.h"
+#include "binary-layout-export.h"
+#include "AtlasBundle.h"
+#include "bundle-export.h"
+#include "atlas-builder.h"
+#include "shard-plan.h"
 #include "shadron-preview-generator.h"
 
 #define MSDF_ATLAS_VERSION "1.2"
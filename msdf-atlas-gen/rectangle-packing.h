@@ -14,6 +14,14 @@ int packRectangles(RectangleType *rectangles, int count, int width, int height,
 template <class SizeSelector, typename RectangleType>
 std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int padding = 0);
 
+/// Packs the rectangle array into layerCount independent layers (channels) of the same fixed dimensions, outputs the layer of each rectangle, returns how many didn't fit (0 on success)
+template <typename RectangleType>
+int packRectangleLayers(RectangleType *rectangles, int *layers, int count, int layerCount, int width, int height, int padding = 0);
+
+/// Packs the rectangle array into layerCount independent layers (channels) of unknown size, returns the minimum required dimensions constrained by SizeSelector
+template <class SizeSelector, typename RectangleType>
+std::pair<int, int> packRectangleLayers(RectangleType *rectangles, int *layers, int count, int layerCount, int padding = 0);
+
 }
 
 #include "rectangle-packing.hpp"
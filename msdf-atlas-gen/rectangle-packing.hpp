@@ -2,6 +2,7 @@
 #include "rectangle-packing.h"
 
 #include <vector>
+#include <algorithm>
 #include "RectanglePacker.h"
 
 namespace msdf_atlas {
@@ -58,4 +59,75 @@ std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int pad
     return dimensions;
 }
 
+/// Fills the layers one by one, each with the remaining rectangles that fit. Returns how many didn't fit into any layer
+template <typename RectangleType>
+static int packRemainingIntoLayers(RectangleType *rectangles, int *layers, int count, int layerCount, int width, int height) {
+    std::vector<int> remaining(count);
+    for (int i = 0; i < count; ++i)
+        remaining[i] = i;
+    std::vector<RectangleType> layerRectangles;
+    for (int layer = 0; layer < layerCount && !remaining.empty(); ++layer) {
+        layerRectangles.resize(remaining.size());
+        for (size_t i = 0; i < remaining.size(); ++i) {
+            layerRectangles[i] = rectangles[remaining[i]];
+            layerRectangles[i].x = -1;
+        }
+        RectanglePacker(width, height).pack(layerRectangles.data(), layerRectangles.size());
+        size_t j = 0;
+        for (size_t i = 0; i < remaining.size(); ++i) {
+            if (layerRectangles[i].x >= 0) {
+                copyRectanglePlacement(rectangles[remaining[i]], layerRectangles[i]);
+                layers[remaining[i]] = layer;
+            } else
+                remaining[j++] = remaining[i];
+        }
+        remaining.resize(j);
+    }
+    return (int) remaining.size();
+}
+
+template <typename RectangleType>
+int packRectangleLayers(RectangleType *rectangles, int *layers, int count, int layerCount, int width, int height, int padding) {
+    if (padding)
+        for (int i = 0; i < count; ++i) {
+            rectangles[i].w += padding;
+            rectangles[i].h += padding;
+        }
+    int result = packRemainingIntoLayers(rectangles, layers, count, layerCount, width+padding, height+padding);
+    if (padding)
+        for (int i = 0; i < count; ++i) {
+            rectangles[i].w -= padding;
+            rectangles[i].h -= padding;
+        }
+    return result;
+}
+
+template <class SizeSelector, typename RectangleType>
+std::pair<int, int> packRectangleLayers(RectangleType *rectangles, int *layers, int count, int layerCount, int padding) {
+    std::vector<RectangleType> rectanglesCopy(count);
+    std::vector<int> layersCopy(count);
+    int totalArea = 0;
+    for (int i = 0; i < count; ++i) {
+        rectanglesCopy[i].w = rectangles[i].w+padding;
+        rectanglesCopy[i].h = rectangles[i].h+padding;
+        totalArea += rectangles[i].w*rectangles[i].h;
+    }
+    std::pair<int, int> dimensions;
+    SizeSelector sizeSelector(totalArea/std::max(layerCount, 1));
+    int width, height;
+    while (sizeSelector(width, height)) {
+        if (!packRemainingIntoLayers(rectanglesCopy.data(), layersCopy.data(), count, layerCount, width+padding, height+padding)) {
+            dimensions.first = width;
+            dimensions.second = height;
+            for (int i = 0; i < count; ++i) {
+                copyRectanglePlacement(rectangles[i], rectanglesCopy[i]);
+                layers[i] = layersCopy[i];
+            }
+            --sizeSelector;
+        } else
+            ++sizeSelector;
+    }
+    return dimensions;
+}
+
 }
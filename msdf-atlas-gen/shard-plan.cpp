@@ -0,0 +1,163 @@
+
+#include "shard-plan.h"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "BufferedWriter.h"
+
+#define SHARD_PLAN_HEADER "msdf-atlas-gen shard plan 1"
+
+namespace msdf_atlas {
+
+void createShardPlan(ShardPlan &plan, const GlyphGeometry *glyphs, int glyphCount, int width, int height, double scale, double range, double pxRange, int shardCount) {
+    plan.width = width, plan.height = height;
+    plan.scale = scale, plan.range = range;
+    plan.pxRange = pxRange;
+    plan.glyphs.clear();
+    double totalArea = 0;
+    for (int i = 0; i < glyphCount; ++i) {
+        ShardGlyph glyph = { };
+        glyphs[i].getBoxRect(glyph.x, glyph.y, glyph.w, glyph.h);
+        if (!glyphs[i].isWhitespace() && glyph.w > 0 && glyph.h > 0) {
+            glyph.glyph = i;
+            glyph.index = glyphs[i].getIndex();
+            glyph.channel = glyphs[i].getBoxChannel();
+            plan.glyphs.push_back(glyph);
+            totalArea += double(glyph.w)*glyph.h;
+        }
+    }
+
+    // Boxes are sorted by rows, so each shard's region is a horizontal band of the atlas
+    std::sort(plan.glyphs.begin(), plan.glyphs.end(), [](const ShardGlyph &a, const ShardGlyph &b) {
+        return a.y < b.y || (a.y == b.y && a.x < b.x);
+    });
+    plan.shards.assign(shardCount, ShardRegion());
+    std::vector<bool> emptyShard(shardCount, true);
+    double area = 0;
+    for (ShardGlyph &glyph : plan.glyphs) {
+        glyph.shard = std::min(int(area*shardCount/totalArea), shardCount-1);
+        area += double(glyph.w)*glyph.h;
+        ShardRegion &region = plan.shards[glyph.shard];
+        if (emptyShard[glyph.shard]) {
+            region.x = glyph.x, region.y = glyph.y;
+            region.w = glyph.w, region.h = glyph.h;
+            emptyShard[glyph.shard] = false;
+        } else {
+            int r = std::max(region.x+region.w, glyph.x+glyph.w);
+            int t = std::max(region.y+region.h, glyph.y+glyph.h);
+            region.x = std::min(region.x, glyph.x), region.y = std::min(region.y, glyph.y);
+            region.w = r-region.x, region.h = t-region.y;
+        }
+    }
+}
+
+bool saveShardPlan(const ShardPlan &plan, const char *filename) {
+    FILE *f = fopen(filename, "w");
+    if (!f)
+        return false;
+    bool success;
+    {
+        BufferedWriter w(f);
+        w.write(SHARD_PLAN_HEADER "\n");
+        w.write("atlas "), w.writeInt(plan.width);
+        w.write(' '), w.writeInt(plan.height);
+        w.write(' '), w.writeDouble(plan.scale);
+        w.write(' '), w.writeDouble(plan.range);
+        w.write(' '), w.writeDouble(plan.pxRange);
+        w.write("\nshards "), w.writeInt(int(plan.shards.size())), w.write('\n');
+        for (const ShardRegion &region : plan.shards) {
+            w.writeInt(region.x), w.write(' '), w.writeInt(region.y), w.write(' ');
+            w.writeInt(region.w), w.write(' '), w.writeInt(region.h), w.write('\n');
+        }
+        w.write("glyphs "), w.writeInt(int(plan.glyphs.size())), w.write('\n');
+        for (const ShardGlyph &glyph : plan.glyphs) {
+            w.writeInt(glyph.glyph), w.write(' '), w.writeInt(glyph.index), w.write(' '), w.writeInt(glyph.shard), w.write(' ');
+            w.writeInt(glyph.x), w.write(' '), w.writeInt(glyph.y), w.write(' ');
+            w.writeInt(glyph.w), w.write(' '), w.writeInt(glyph.h), w.write(' '), w.writeInt(glyph.channel), w.write('\n');
+        }
+        success = w.flush();
+    }
+    fclose(f);
+    return success;
+}
+
+bool loadShardPlan(ShardPlan &plan, const char *filename) {
+    FILE *f = fopen(filename, "r");
+    if (!f)
+        return false;
+    char header[sizeof(SHARD_PLAN_HEADER)+1] = { };
+    int shardCount = 0, glyphCount = 0;
+    bool success = (
+        fgets(header, sizeof(header), f) && !strncmp(header, SHARD_PLAN_HEADER "\n", sizeof(header)) &&
+        fscanf(f, " atlas %d %d %lf %lf %lf", &plan.width, &plan.height, &plan.scale, &plan.range, &plan.pxRange) == 5 &&
+        fscanf(f, " shards %d", &shardCount) == 1 && shardCount > 0 &&
+        plan.width >= 0 && plan.height >= 0 && plan.scale > 0
+    );
+    if (success) {
+        plan.shards.resize(shardCount);
+        for (ShardRegion &region : plan.shards) {
+            if (!(
+                fscanf(f, "%d %d %d %d", &region.x, &region.y, &region.w, &region.h) == 4 &&
+                region.x >= 0 && region.y >= 0 && region.w >= 0 && region.h >= 0 &&
+                region.w <= plan.width-region.x && region.h <= plan.height-region.y
+            )) {
+                success = false;
+                break;
+            }
+        }
+    }
+    success = success && fscanf(f, " glyphs %d", &glyphCount) == 1 && glyphCount >= 0;
+    if (success) {
+        plan.glyphs.resize(glyphCount);
+        for (ShardGlyph &glyph : plan.glyphs) {
+            if (!(
+                fscanf(f, "%d %d %d %d %d %d %d %d", &glyph.glyph, &glyph.index, &glyph.shard, &glyph.x, &glyph.y, &glyph.w, &glyph.h, &glyph.channel) == 8 &&
+                glyph.glyph >= 0 && glyph.shard >= 0 && glyph.shard < shardCount && glyph.w >= 0 && glyph.h >= 0
+            )) {
+                success = false;
+                break;
+            }
+            // The glyph's box must lie within its shard's region
+            const ShardRegion &region = plan.shards[glyph.shard];
+            if (!(glyph.x >= region.x && glyph.y >= region.y && glyph.x+glyph.w <= region.x+region.w && glyph.y+glyph.h <= region.y+region.h)) {
+                success = false;
+                break;
+            }
+        }
+    }
+    fclose(f);
+    return success;
+}
+
+bool applyShardPlan(GlyphGeometry *glyphs, int glyphCount, const ShardPlan &plan, double miterLimit, int shard) {
+    for (GlyphGeometry *glyph = glyphs, *end = glyphs+glyphCount; glyph < end; ++glyph) {
+        if (!glyph->isWhitespace())
+            glyph->wrapBox(plan.scale, plan.range, miterLimit);
+    }
+    int dx = 0, dy = 0;
+    if (shard >= 0)
+        dx = plan.shards[shard].x, dy = plan.shards[shard].y;
+    for (const ShardGlyph &planGlyph : plan.glyphs) {
+        if (planGlyph.glyph >= glyphCount || glyphs[planGlyph.glyph].getIndex() != planGlyph.index)
+            return false;
+        GlyphGeometry &glyph = glyphs[planGlyph.glyph];
+        int w, h;
+        glyph.getBoxSize(w, h);
+        if (w != planGlyph.w || h != planGlyph.h)
+            return false;
+        if (shard < 0 || planGlyph.shard == shard) {
+            glyph.placeBox(planGlyph.x-dx, planGlyph.y-dy);
+            glyph.setBoxChannel(planGlyph.channel);
+        }
+    }
+    return true;
+}
+
+std::string shardImageFilename(const char *planFilename, int shard) {
+    char suffix[16];
+    snprintf(suffix, sizeof(suffix), ".%d", shard);
+    return std::string(planFilename)+suffix;
+}
+
+}
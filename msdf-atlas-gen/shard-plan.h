@@ -0,0 +1,64 @@
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <msdfgen.h>
+#include "types.h"
+#include "GlyphGeometry.h"
+
+namespace msdf_atlas {
+
+/// Rectangular region of the atlas that contains all glyph boxes of a shard
+struct ShardRegion {
+    int x, y, w, h;
+};
+
+/// Placement of a glyph's box in the atlas
+struct ShardGlyph {
+    /// Position of the glyph in the array of all loaded glyphs
+    int glyph;
+    /// Glyph index within its font, to verify that the glyphs have been loaded identically
+    int index;
+    int shard;
+    int x, y, w, h;
+    int channel;
+};
+
+/**
+ * Division of a packed atlas into shards, which can be generated by separate processes.
+ * The atlas is packed once, and the other processes apply the resulting layout to glyphs loaded with the same settings.
+ */
+struct ShardPlan {
+    int width, height;
+    /// Glyph scale and the range passed to GlyphGeometry::wrapBox
+    double scale, range;
+    double pxRange;
+    std::vector<ShardRegion> shards;
+    std::vector<ShardGlyph> glyphs;
+};
+
+/// Divides the boxes of packed glyphs into shardCount bands of consecutive rows with approximately equal areas
+void createShardPlan(ShardPlan &plan, const GlyphGeometry *glyphs, int glyphCount, int width, int height, double scale, double range, double pxRange, int shardCount);
+/// Saves the shard plan as a text file
+bool saveShardPlan(const ShardPlan &plan, const char *filename);
+/// Loads a shard plan saved by saveShardPlan
+bool loadShardPlan(ShardPlan &plan, const char *filename);
+/**
+ * Applies the layout of the shard plan to the glyphs, returns false if they do not match the plan.
+ * If shard is not negative, only the boxes of that shard are placed, relative to its region.
+ */
+bool applyShardPlan(GlyphGeometry *glyphs, int glyphCount, const ShardPlan &plan, double miterLimit, int shard = -1);
+/// Returns the filename of the partial image of a shard, which is derived from the plan's filename
+std::string shardImageFilename(const char *planFilename, int shard);
+
+/// Saves the generated region of a shard as a partial image (raw pixels in native byte order)
+template <typename T, int N>
+bool saveShardImage(const msdfgen::BitmapConstRef<T, N> &bitmap, const char *filename);
+/// Loads the partial image of a shard and copies its glyph boxes into the complete atlas
+template <typename T, int N>
+bool mergeShardImage(const msdfgen::BitmapRef<T, N> &atlas, const ShardPlan &plan, int shard, const char *filename);
+
+}
+
+#include "shard-plan.hpp"
@@ -0,0 +1,50 @@
+
+#include "shard-plan.h"
+
+#include <cstdio>
+#include <cstdint>
+#include "bitmap-blit.h"
+
+#define SHARD_IMAGE_MAGIC 0x5344534du // "MSDS"
+
+namespace msdf_atlas {
+
+template <typename T, int N>
+bool saveShardImage(const msdfgen::BitmapConstRef<T, N> &bitmap, const char *filename) {
+    FILE *f = fopen(filename, "wb");
+    if (!f)
+        return false;
+    uint32_t header[5] = { SHARD_IMAGE_MAGIC, uint32_t(bitmap.width), uint32_t(bitmap.height), uint32_t(N), uint32_t(sizeof(T)) };
+    size_t pixelCount = size_t(N)*bitmap.width*bitmap.height;
+    bool success = fwrite(header, sizeof(header), 1, f) == 1 && fwrite(bitmap.pixels, sizeof(T), pixelCount, f) == pixelCount;
+    return !fclose(f) && success;
+}
+
+template <typename T, int N>
+bool mergeShardImage(const msdfgen::BitmapRef<T, N> &atlas, const ShardPlan &plan, int shard, const char *filename) {
+    const ShardRegion &region = plan.shards[shard];
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+        return false;
+    uint32_t header[5] = { };
+    bool success = (
+        fread(header, sizeof(header), 1, f) == 1 && header[0] == SHARD_IMAGE_MAGIC &&
+        header[1] == uint32_t(region.w) && header[2] == uint32_t(region.h) && header[3] == uint32_t(N) && header[4] == uint32_t(sizeof(T))
+    );
+    if (success) {
+        msdfgen::Bitmap<T, N> partial(region.w, region.h);
+        size_t pixelCount = size_t(N)*region.w*region.h;
+        success = fread((T *) partial, sizeof(T), pixelCount, f) == pixelCount;
+        if (success) {
+            msdfgen::BitmapRef<T, N> source = partial;
+            for (const ShardGlyph &glyph : plan.glyphs) {
+                if (glyph.shard == shard)
+                    blit(atlas, source, glyph.x, glyph.y, glyph.x-region.x, glyph.y-region.y, glyph.w, glyph.h);
+            }
+        }
+    }
+    fclose(f);
+    return success;
+}
+
+}
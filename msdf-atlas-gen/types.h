@@ -34,7 +34,11 @@ enum class ImageFormat {
     TEXT_FLOAT,
     BINARY,
     BINARY_FLOAT,
-    BINARY_FLOAT_BE
+    BINARY_FLOAT_BE,
+    KTX2,
+    KTX2_HALF_FLOAT,
+    KTX2_FLOAT,
+    QOI
 };
 
 /// Glyph identification